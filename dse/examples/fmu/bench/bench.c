@@ -0,0 +1,247 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <dse/fmu/fmu.h>
+#include <dse/ncodec/codec.h>
+#include <dse/ncodec/interface/frame.h>
+#include <dse/ncodec/interface/pdu.h>
+
+
+/**
+Benchmark FMU
+=============
+
+Synthetic FMU for scaling tests. The size of the FMU is set by its (generated)
+Model Description, the load by its parameters:
+
+    VR        Name        Causality   Description
+    1         frames      input       Frames/PDUs sent per binary output.
+    2         payload     input       Payload length of each frame (bytes).
+    3         load_us     input       Busy (compute) time per step (us).
+    4         steps       output      Step counter.
+    5         rx_frames   output      Frames/PDUs received in the last step.
+    1000000+  in_<i>      input       Scalar inputs.
+    2000000+  out_<i>     output      Scalar outputs (out_<i> = in_<i> + steps).
+    3000000+  bus_<j>_rx  input       Binary inputs (NCodec, PDU or CAN).
+    4000000+  bus_<j>_tx  output      Binary outputs (NCodec, PDU or CAN).
+
+The parameters may be overridden with the environment variables
+`BENCH_FRAMES`, `BENCH_PAYLOAD` and `BENCH_LOAD_US`.
+*/
+
+
+#define VR_INPUT_BASE     1000000
+#define VR_OUTPUT_BASE    2000000
+#define VR_BINARY_RX_BASE 3000000
+#define VR_BINARY_TX_BASE 4000000
+#define CAN_PAYLOAD_MAX   64
+
+/* Sender swc_id, differs from the configured swc_id (bypass Rx filtering). */
+#define TX_SWC_ID 0x8000
+
+
+typedef struct {
+    double frames;
+    double payload;
+    double load_us;
+    double steps;
+    double rx_frames;
+
+    /* Benchmark configuration. */
+    size_t   scalar_count;
+    size_t   binary_count;
+    NCODEC** rx;
+    NCODEC** tx;
+    bool*    frame; /* CAN frames (type=frame), otherwise PDUs. */
+    uint8_t* buffer;
+    size_t   buffer_len;
+    double   env_frames;
+    double   env_payload;
+    double   env_load_us;
+
+    /* Scalar variables: value[0..N) inputs, value[N..2N) outputs. */
+    double value[];
+} VarTable;
+
+
+static bool _exists(HashMap* map, uint32_t vr)
+{
+    char key[HASHLIST_KEY_LEN];
+    snprintf(key, HASHLIST_KEY_LEN, "%u", vr);
+    return hashmap_get(map, key) != NULL;
+}
+
+
+static double _env(const char* name)
+{
+    const char* value = getenv(name);
+    return (value && *value) ? atof(value) : -1;
+}
+
+
+static bool _is_frame(NCODEC* nc)
+{
+    for (int i = 0; i >= 0; i++) {
+        NCodecConfigItem ci = ncodec_stat(nc, &i);
+        if (ci.name && strcmp(ci.name, "type") == 0) {
+            return strcmp(ci.value, "frame") == 0;
+        }
+    }
+    return false;
+}
+
+
+static void _busy_wait(double us)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double end = ts.tv_sec * 1e6 + ts.tv_nsec / 1e3 + us;
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+    } while (ts.tv_sec * 1e6 + ts.tv_nsec / 1e3 < end);
+}
+
+
+FmuInstanceData* fmu_create(FmuInstanceData* fmu)
+{
+    /* Size the FMU from its (indexed) variables. */
+    size_t n = 0;
+    while (_exists(&fmu->variables.scalar.input, VR_INPUT_BASE + n) &&
+           _exists(&fmu->variables.scalar.output, VR_OUTPUT_BASE + n)) {
+        n++;
+    }
+    size_t m = 0;
+    while (_exists(&fmu->variables.binary.rx, VR_BINARY_RX_BASE + m) &&
+           _exists(&fmu->variables.binary.tx, VR_BINARY_TX_BASE + m)) {
+        m++;
+    }
+
+    VarTable* v = calloc(1, sizeof(VarTable) + 2 * n * sizeof(double));
+    fmu_register_var(fmu, 1, true, offsetof(VarTable, frames));
+    fmu_register_var(fmu, 2, true, offsetof(VarTable, payload));
+    fmu_register_var(fmu, 3, true, offsetof(VarTable, load_us));
+    fmu_register_var(fmu, 4, false, offsetof(VarTable, steps));
+    fmu_register_var(fmu, 5, false, offsetof(VarTable, rx_frames));
+    for (size_t i = 0; i < n; i++) {
+        fmu_register_var(fmu, VR_INPUT_BASE + i, true,
+            offsetof(VarTable, value) + i * sizeof(double));
+        fmu_register_var(fmu, VR_OUTPUT_BASE + i, false,
+            offsetof(VarTable, value) + (n + i) * sizeof(double));
+    }
+    fmu_register_var_table(fmu, v);
+
+    v->scalar_count = n;
+    v->binary_count = m;
+    v->rx = calloc(m, sizeof(NCODEC*));
+    v->tx = calloc(m, sizeof(NCODEC*));
+    v->frame = calloc(m, sizeof(bool));
+    for (size_t j = 0; j < m; j++) {
+        v->rx[j] = fmu_lookup_ncodec(fmu, VR_BINARY_RX_BASE + j, true);
+        v->tx[j] = fmu_lookup_ncodec(fmu, VR_BINARY_TX_BASE + j, false);
+        if (v->tx[j]) v->frame[j] = _is_frame(v->tx[j]);
+    }
+    v->env_frames = _env("BENCH_FRAMES");
+    v->env_payload = _env("BENCH_PAYLOAD");
+    v->env_load_us = _env("BENCH_LOAD_US");
+
+    fmu_log(fmu, FmiLogOk, "Debug", "Benchmark: scalars=%zu, binaries=%zu", n,
+        m);
+    return NULL;
+}
+
+int fmu_init(FmuInstanceData* fmu)
+{
+    UNUSED(fmu);
+    return 0;
+}
+
+int fmu_step(FmuInstanceData* fmu, double CommunicationPoint, double stepSize)
+{
+    UNUSED(CommunicationPoint);
+    UNUSED(stepSize);
+    VarTable* v = fmu_var_table(fmu);
+
+    size_t frames = (v->env_frames >= 0) ? v->env_frames : v->frames;
+    size_t payload = (v->env_payload >= 0) ? v->env_payload : v->payload;
+    double load_us = (v->env_load_us >= 0) ? v->env_load_us : v->load_us;
+    if (payload > v->buffer_len) {
+        v->buffer = realloc(v->buffer, payload);
+        for (size_t i = v->buffer_len; i < payload; i++) {
+            v->buffer[i] = (uint8_t)i;
+        }
+        v->buffer_len = payload;
+    }
+
+    /* Consume frames/PDUs from the network. */
+    v->rx_frames = 0;
+    for (size_t j = 0; j < v->binary_count; j++) {
+        if (v->rx[j] == NULL) continue;
+        while (1) {
+            int len;
+            if (v->frame[j]) {
+                NCodecCanMessage msg = {};
+                len = ncodec_read(v->rx[j], &msg);
+            } else {
+                NCodecPdu pdu = {};
+                len = ncodec_read(v->rx[j], &pdu);
+            }
+            if (len < 0) break;
+            v->rx_frames += 1;
+        }
+    }
+
+    /* Scalar outputs and (artificial) compute load. */
+    v->steps += 1;
+    double* in = &v->value[0];
+    double* out = &v->value[v->scalar_count];
+    for (size_t i = 0; i < v->scalar_count; i++) {
+        out[i] = in[i] + v->steps;
+    }
+    if (load_us > 0) _busy_wait(load_us);
+
+    /* Send frames/PDUs over the network. */
+    for (size_t j = 0; j < v->binary_count; j++) {
+        if (v->tx[j] == NULL) continue;
+        for (size_t k = 0; k < frames; k++) {
+            /* Ids exceed the 11 bit base range, use extended CAN frames. */
+            uint32_t id = 1000 + j * 1000 + k;
+            if (v->frame[j]) {
+                ncodec_write(v->tx[j],
+                    &(struct NCodecCanMessage){ .frame_id = id,
+                        .frame_type = CAN_FD_EXTENDED_FRAME,
+                        .buffer = v->buffer,
+                        .len = (payload < CAN_PAYLOAD_MAX) ? payload
+                                                           : CAN_PAYLOAD_MAX });
+            } else {
+                ncodec_write(v->tx[j], &(struct NCodecPdu){ .id = id,
+                                           .payload = v->buffer,
+                                           .payload_len = payload,
+                                           .swc_id = TX_SWC_ID });
+            }
+        }
+        ncodec_flush(v->tx[j]);
+    }
+
+    return 0;
+}
+
+int fmu_destroy(FmuInstanceData* fmu)
+{
+    VarTable* v = fmu_var_table(fmu);
+    if (v) {
+        free(v->rx);
+        free(v->tx);
+        free(v->frame);
+        free(v->buffer);
+    }
+    return 0;
+}
+
+void fmu_reset_binary_signals(FmuInstanceData* fmu)
+{
+    UNUSED(fmu);
+}
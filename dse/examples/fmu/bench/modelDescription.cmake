@@ -0,0 +1,166 @@
+# Copyright 2026 Robert Bosch GmbH
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Generate the Model Description of the Benchmark FMU.
+#
+#   bench_model_description(<fmi_version> <output_file>)
+#
+# Variable references follow the layout expected by bench.c, the size and
+# parameters are taken from the BENCH_* cache variables.
+function(bench_model_description FMI_VERSION OUTPUT)
+    set(_mime "application/x-automotive-bus; interface=stream; type=${BENCH_BINARY_TYPE}; schema=fbs")
+    if(BENCH_BINARY_TYPE STREQUAL "frame")
+        set(_mime "${_mime}; bus=can")
+    endif()
+    math(EXPR _n_last "${BENCH_SCALAR_COUNT} - 1")
+    math(EXPR _m_last "${BENCH_BINARY_COUNT} - 1")
+
+    if(FMI_VERSION EQUAL 2)
+        string(CONCAT _xml
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<fmiModelDescription\n"
+            "    fmiVersion=\"2.0\"\n"
+            "    modelName=\"bench\"\n"
+            "    description=\"Benchmark Example FMU (generated).\"\n"
+            "    generationTool=\"dse.fmi (bench)\"\n"
+            "    guid=\"{9c0cbd4e-7d8e-4c2a-9a43-6e0d3c5bb8a1}\"\n"
+            "    numberOfEventIndicators=\"0\">\n\n"
+            "    <CoSimulation\n"
+            "        modelIdentifier=\"fmu2bench\"\n"
+            "        canHandleVariableCommunicationStepSize=\"false\"\n"
+            "        canNotUseMemoryManagementFunctions=\"false\"\n"
+            "        canGetAndSetFMUstate=\"false\"\n"
+            "        canSerializeFMUstate=\"false\">\n"
+            "    </CoSimulation>\n\n"
+            "    <DefaultExperiment startTime=\"0\" stepSize=\"0.0005\" />\n\n"
+            "    <ModelVariables>\n"
+        )
+        foreach(_p IN ITEMS "1;frames;input;${BENCH_FRAMES}"
+                "2;payload;input;${BENCH_PAYLOAD}"
+                "3;load_us;input;${BENCH_LOAD_US}"
+                "4;steps;output;0" "5;rx_frames;output;0")
+            list(GET _p 0 _vr)
+            list(GET _p 1 _name)
+            list(GET _p 2 _causality)
+            list(GET _p 3 _start)
+            string(APPEND _xml
+                "        <ScalarVariable name=\"${_name}\" valueReference=\"${_vr}\" causality=\"${_causality}\">\n"
+                "            <Real start=\"${_start}\"></Real>\n"
+                "        </ScalarVariable>\n")
+        endforeach()
+        if(BENCH_SCALAR_COUNT GREATER 0)
+            foreach(_i RANGE ${_n_last})
+                math(EXPR _vr_in "1000000 + ${_i}")
+                math(EXPR _vr_out "2000000 + ${_i}")
+                string(APPEND _xml
+                    "        <ScalarVariable name=\"in_${_i}\" valueReference=\"${_vr_in}\" causality=\"input\"><Real start=\"${_i}\"></Real></ScalarVariable>\n"
+                    "        <ScalarVariable name=\"out_${_i}\" valueReference=\"${_vr_out}\" causality=\"output\"><Real start=\"0\"></Real></ScalarVariable>\n")
+            endforeach()
+        endif()
+        if(BENCH_BINARY_COUNT GREATER 0)
+            foreach(_j RANGE ${_m_last})
+                math(EXPR _swc_id "${_j} + 1")
+                foreach(_dir IN ITEMS rx tx)
+                    if(_dir STREQUAL "rx")
+                        math(EXPR _vr "3000000 + ${_j}")
+                        set(_causality "input")
+                    else()
+                        math(EXPR _vr "4000000 + ${_j}")
+                        set(_causality "output")
+                    endif()
+                    string(APPEND _xml
+                        "        <ScalarVariable name=\"bus_${_j}_${_dir}\" valueReference=\"${_vr}\" causality=\"${_causality}\" variability=\"discrete\">\n"
+                        "            <String start=\"\"></String>\n"
+                        "            <Annotations>\n"
+                        "                <Tool name=\"dse.standards.fmi-ls-binary-to-text\">\n"
+                        "                    <Annotation name=\"encoding\">ascii85</Annotation>\n"
+                        "                </Tool>\n"
+                        "                <Tool name=\"dse.standards.fmi-ls-binary-codec\">\n"
+                        "                    <Annotation name=\"mimetype\">${_mime}; swc_id=${_swc_id}; ecu_id=1; bus_id=${_swc_id}</Annotation>\n"
+                        "                </Tool>\n"
+                        "            </Annotations>\n"
+                        "        </ScalarVariable>\n")
+                endforeach()
+            endforeach()
+        endif()
+        string(APPEND _xml
+            "    </ModelVariables>\n\n"
+            "    <ModelStructure></ModelStructure>\n\n"
+            "</fmiModelDescription>\n")
+    else()
+        string(CONCAT _xml
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<fmiModelDescription\n"
+            "    fmiVersion=\"3.0\"\n"
+            "    modelName=\"bench\"\n"
+            "    description=\"Benchmark Example FMU (generated).\"\n"
+            "    generationTool=\"dse.fmi (bench)\"\n"
+            "    instantiationToken=\"{9c0cbd4e-7d8e-4c2a-9a43-6e0d3c5bb8a1}\"\n"
+            "    numberOfEventIndicators=\"0\"\n"
+            "    version=\"1.0\">\n\n"
+            "    <CoSimulation\n"
+            "        modelIdentifier=\"fmu3bench\"\n"
+            "        canHandleVariableCommunicationStepSize=\"false\"\n"
+            "        canNotUseMemoryManagementFunctions=\"false\"\n"
+            "        canGetAndSetFMUstate=\"false\"\n"
+            "        canSerializeFMUstate=\"false\">\n"
+            "    </CoSimulation>\n\n"
+            "    <DefaultExperiment startTime=\"0\" stepSize=\"0.0005\" />\n\n"
+            "    <ModelVariables>\n"
+        )
+        foreach(_p IN ITEMS "1;frames;input;${BENCH_FRAMES}"
+                "2;payload;input;${BENCH_PAYLOAD}"
+                "3;load_us;input;${BENCH_LOAD_US}"
+                "4;steps;output;0" "5;rx_frames;output;0")
+            list(GET _p 0 _vr)
+            list(GET _p 1 _name)
+            list(GET _p 2 _causality)
+            list(GET _p 3 _start)
+            string(APPEND _xml
+                "        <Float64 name=\"${_name}\" valueReference=\"${_vr}\" causality=\"${_causality}\" start=\"${_start}\" />\n")
+        endforeach()
+        if(BENCH_SCALAR_COUNT GREATER 0)
+            foreach(_i RANGE ${_n_last})
+                math(EXPR _vr_in "1000000 + ${_i}")
+                math(EXPR _vr_out "2000000 + ${_i}")
+                string(APPEND _xml
+                    "        <Float64 name=\"in_${_i}\" valueReference=\"${_vr_in}\" causality=\"input\" start=\"${_i}\" />\n"
+                    "        <Float64 name=\"out_${_i}\" valueReference=\"${_vr_out}\" causality=\"output\" start=\"0\" />\n")
+            endforeach()
+        endif()
+        if(BENCH_BINARY_COUNT GREATER 0)
+            foreach(_j RANGE ${_m_last})
+                math(EXPR _swc_id "${_j} + 1")
+                foreach(_dir IN ITEMS rx tx)
+                    if(_dir STREQUAL "rx")
+                        math(EXPR _vr "3000000 + ${_j}")
+                        set(_causality "input")
+                    else()
+                        math(EXPR _vr "4000000 + ${_j}")
+                        set(_causality "output")
+                    endif()
+                    # No binary-to-text encoding, values are exchanged as bytes.
+                    string(APPEND _xml
+                        "        <Binary name=\"bus_${_j}_${_dir}\" valueReference=\"${_vr}\" causality=\"${_causality}\">\n"
+                        "            <Start value=\"\"/>\n"
+                        "            <Annotations>\n"
+                        "                <Annotation type=\"dse.standards.fmi-ls-binary-codec\">\n"
+                        "                    <Mimetype>${_mime}; swc_id=${_swc_id}; ecu_id=1; bus_id=${_swc_id}</Mimetype>\n"
+                        "                </Annotation>\n"
+                        "            </Annotations>\n"
+                        "        </Binary>\n")
+                endforeach()
+            endforeach()
+        endif()
+        string(APPEND _xml
+            "    </ModelVariables>\n"
+            "    <ModelStructure>\n"
+            "        <Output valueReference=\"4\"/>\n"
+            "        <Output valueReference=\"5\"/>\n"
+            "    </ModelStructure>\n"
+            "</fmiModelDescription>\n")
+    endif()
+
+    file(WRITE ${OUTPUT} "${_xml}")
+endfunction()
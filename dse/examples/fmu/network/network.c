@@ -90,8 +90,7 @@ int fmu_step(FmuInstanceData* fmu, double CommunicationPoint, double stepSize)
             },
         },
     };
-    ncodec_write(v->pdu_tx, &tx_msg);
-    ncodec_flush(v->pdu_tx);
+    ncodec_write(v->pdu_tx, &tx_msg);  // Flushed after fmu_step().
 
     return 0;
 }
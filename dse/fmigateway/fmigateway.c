@@ -4,6 +4,7 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 #include <dse/clib/util/strings.h>
@@ -11,7 +12,8 @@
 #include <dse/fmigateway/fmigateway.h>
 
 
-#define UNUSED(x) ((void)x)
+#define UNUSED(x)    ((void)x)
+#define SYNC_EPSILON 1e-6 /* Fraction of a step, sync time tolerance. */
 
 
 /**
@@ -134,13 +136,18 @@ int32_t fmu_init(FmuInstanceData* fmu)
 
     fmu_log(fmu, 0, "Debug", "Connected to the Simbus...");
 
+    FmuAnnotationIndex* annotations = fmu_annotation_index_create(gw->sim);
     fmigateway_index_scalar_signals(
         fmu, gw, &fmu->variables.scalar.input, &fmu->variables.scalar.output);
-    fmigateway_index_binary_signals(
-        fmu, gw, &fmu->variables.binary.rx, &fmu->variables.binary.tx);
-    fmigateway_index_text_encoding(fmu, gw, &fmu->variables.binary.encode_func,
-        &fmu->variables.binary.decode_func);
-
+    fmigateway_stats_index(fmu);
+    fmigateway_index_binary_signals(fmu, gw, annotations,
+        &fmu->variables.binary.rx, &fmu->variables.binary.tx);
+    fmigateway_index_text_encoding(fmu, gw, annotations,
+        &fmu->variables.binary.encode_func, &fmu->variables.binary.decode_func);
+    fmu_annotation_index_destroy(annotations);
+
+    fmi_gw->sync.step_size = fmi_gw->settings.step_size;
+    fmi_gw->sync.next = 0.0;
     fmi_gw->state = FMIGATEWAY_STATE_INITIALIZED;
 
     return 0;
@@ -154,6 +161,12 @@ fmu_step
 This method executes one step of the gateway model and signals are exchanged
 with the other simulation participants.
 
+The time of the next SimBus sync is predicted from the gateway step size.
+FMU steps which fall before that time return without a sync (and without
+transport I/O), FMU steps coarser than the gateway step size advance the
+SimBus by several steps in a single sync. Both are counted in the gateway
+statistics (`skip_count` and `coalesce_count`).
+
 > Required by FMU.
 
 Parameters
@@ -184,8 +197,36 @@ int32_t fmu_step(
         fmi_gw->state = FMIGATEWAY_STATE_RUNNING;
     }
 
+    /* Catch-up, the SimBus will not advance before the predicted sync
+       time. Short-circuit the step (no transport I/O). */
+    double sync_step = fmi_gw->sync.step_size;
+    if (sync_step > 0 &&
+        communication_point < fmi_gw->sync.next - sync_step * SYNC_EPSILON) {
+        fmigateway_stats_skip(fmi_gw);
+        fmigateway_stats_publish(fmi_gw);
+        return 0;
+    }
+
     /* Step the model. */
-    int rc = model_gw_sync(gw, communication_point);
+    uint64_t bytes = fmigateway_stats_binary_bytes(gw);
+    double   t0 = fmigateway_stats_now();
+    int      rc = model_gw_sync(gw, communication_point);
+    double   latency = fmigateway_stats_now() - t0;
+    bytes += fmigateway_stats_binary_bytes(gw);
+    fmigateway_stats_record(fmi_gw, latency, rc == E_GATEWAYBEHIND, bytes);
+    if (rc != E_GATEWAYBEHIND && sync_step > 0) {
+        /* The sync advances the SimBus past the communication point, a
+           coarser FMU step coalesces several SimBus steps into this sync. */
+        double next =
+            (floor(communication_point / sync_step + SYNC_EPSILON) + 1) *
+            sync_step;
+        if (fmi_gw->sync.next > 0) {
+            double n = round((next - fmi_gw->sync.next) / sync_step);
+            if (n > 1) fmigateway_stats_coalesce(fmi_gw, (uint64_t)n - 1);
+        }
+        fmi_gw->sync.next = next;
+    }
+    fmigateway_stats_publish(fmi_gw);
     if (rc == E_GATEWAYBEHIND) {
         return 0;
     }
@@ -226,6 +267,7 @@ int32_t fmu_destroy(FmuInstanceData* fmu)
     ModelGatewayDesc* gw = fmi_gw->model;
     assert(gw);
 
+    fmigateway_stats_summary(fmu);
     fmigateway_session_end(fmu);
     fmi_gw->state = FMIGATEWAY_STATE_TERMINATED;
 
@@ -275,8 +317,12 @@ int32_t fmu_destroy(FmuInstanceData* fmu)
     }
     free(fmi_gw->settings.scripts.envar);
     free(fmi_gw->settings.yaml_files);
+    fmigateway_stats_destroy(fmi_gw);
+    /* Release the binary signal index (before the gateway object). */
+    fmu_signals_remove(fmu);
     free(gw);
     free(fmi_gw);
+    fmu->data = NULL;
 
     return 0;
 }
@@ -9,6 +9,7 @@
 #include <dse/clib/collections/vector.h>
 #include <dse/modelc/gateway.h>
 #include <dse/fmu/fmu.h>
+#include <dse/fmu/annotation.h>
 
 
 /**
@@ -64,7 +65,7 @@ typedef struct WindowsModel {
     double               timeout;
     bool                 stacked;
     FmiGatewayParameter* envar;
-    /* Windows Information. */
+    /* Process Information (platform specific). */
     void*                w_process;
 } WindowsModel;
 
@@ -84,6 +85,46 @@ typedef struct FmiGatewaySession {
     double last_step;
 } FmiGatewaySession;
 
+#define FMIGATEWAY_STATS_HIST_BUCKETS 32
+
+typedef enum FmiGatewayStatsMetric {
+    FMIGATEWAY_STATS_NONE = 0,
+    FMIGATEWAY_STATS_STEPS,
+    FMIGATEWAY_STATS_BEHIND_COUNT,
+    FMIGATEWAY_STATS_SYNC_LATENCY_MEAN,
+    FMIGATEWAY_STATS_SYNC_LATENCY_MAX,
+    FMIGATEWAY_STATS_SYNC_LATENCY_P50,
+    FMIGATEWAY_STATS_SYNC_LATENCY_P99,
+    FMIGATEWAY_STATS_BYTES_STEP,
+    FMIGATEWAY_STATS_BYTES_TOTAL,
+    FMIGATEWAY_STATS_SKIP_COUNT,
+    FMIGATEWAY_STATS_COALESCE_COUNT,
+} FmiGatewayStatsMetric;
+
+typedef struct FmiGatewayStatsVariable {
+    char*                 vref;
+    FmiGatewayStatsMetric metric;
+    double*               value; /* Storage in variables.scalar.output. */
+} FmiGatewayStatsVariable;
+
+typedef struct FmiGatewayStats {
+    uint64_t                 steps;
+    uint64_t                 behind_count;
+    /* Sync latency (seconds), histogram buckets are log2(microseconds). */
+    double                   latency_total;
+    double                   latency_max;
+    uint64_t                 latency_hist[FMIGATEWAY_STATS_HIST_BUCKETS];
+    /* Bytes exchanged (binary signals). */
+    uint64_t                 bytes_step;
+    uint64_t                 bytes_total;
+    /* Steps short-circuited before the next SimBus sync, and SimBus steps
+       coalesced into a single sync. */
+    uint64_t                 skip_count;
+    uint64_t                 coalesce_count;
+    /* Optional FMU output variables (NTL). */
+    FmiGatewayStatsVariable* variables;
+} FmiGatewayStats;
+
 typedef enum FmiGatewayRuntimeType {
     FMIGATEWAY_RUNTIME_LEGACY = 0,
     FMIGATEWAY_RUNTIME_SIMER = 1,
@@ -123,15 +164,45 @@ typedef struct FmiGateway {
         } scripts;
     } settings;
     bool binary_signals_reset;
+    /* Binary signal index, referenced by the binary rx/tx VRef maps. */
+    struct {
+        FmuSignalVector*      sv; /* One view per binary SignalVector. */
+        size_t                sv_count;
+        FmuSignalVectorIndex* handle; /* VRef table of (view, index). */
+        size_t                handle_count;
+    } binary_index;
+    /* SimBus sync prediction. */
+    struct {
+        double step_size; /* Step size of the gateway on the SimBus. */
+        double next;      /* Predicted time of the next SimBus sync. */
+    } sync;
+    /* Instrumentation. */
+    FmiGatewayStats stats;
 } FmiGateway;
 
 /* index.c */
 DLL_PRIVATE void fmigateway_index_scalar_signals(
     FmuInstanceData* fmu, ModelGatewayDesc* m, HashMap* input, HashMap* output);
-DLL_PRIVATE void fmigateway_index_binary_signals(
-    FmuInstanceData* fmu, ModelGatewayDesc* m, HashMap* rx, HashMap* tx);
+DLL_PRIVATE void fmigateway_index_binary_signals(FmuInstanceData* fmu,
+    ModelGatewayDesc* m, FmuAnnotationIndex* annotations, HashMap* rx,
+    HashMap* tx);
 DLL_PRIVATE void fmigateway_index_text_encoding(FmuInstanceData* fmu,
-    ModelGatewayDesc* m, HashMap* encode_func, HashMap* decode_func);
+    ModelGatewayDesc* m, FmuAnnotationIndex* annotations, HashMap* encode_func,
+    HashMap* decode_func);
+
+/* stats.c */
+DLL_PRIVATE double fmigateway_stats_now(void);
+DLL_PRIVATE FmiGatewayStatsMetric fmigateway_stats_metric(const char* name);
+DLL_PRIVATE uint64_t fmigateway_stats_binary_bytes(ModelGatewayDesc* m);
+DLL_PRIVATE void     fmigateway_stats_record(
+        FmiGateway* fmi_gw, double latency, bool behind, uint64_t bytes);
+DLL_PRIVATE void   fmigateway_stats_skip(FmiGateway* fmi_gw);
+DLL_PRIVATE void   fmigateway_stats_coalesce(FmiGateway* fmi_gw, uint64_t n);
+DLL_PRIVATE double fmigateway_stats_percentile(FmiGateway* fmi_gw, double p);
+DLL_PRIVATE void   fmigateway_stats_index(FmuInstanceData* fmu);
+DLL_PRIVATE void   fmigateway_stats_publish(FmiGateway* fmi_gw);
+DLL_PRIVATE void   fmigateway_stats_summary(FmuInstanceData* fmu);
+DLL_PRIVATE void   fmigateway_stats_destroy(FmiGateway* fmi_gw);
 
 /* parser.c */
 DLL_PRIVATE void fmigateway_parse(FmuInstanceData* fmu);
@@ -9,96 +9,6 @@
 #include <dse/fmigateway/fmigateway.h>
 
 
-static SchemaSignalObject* __signal_match;
-static const char*         __signal_match_name;
-
-
-ChannelSpec* _model_build_channel_spec(
-    ModelInstanceSpec* model_instance, const char* channel_name)
-{
-    const char* selectors[] = { "name" };
-    const char* values[] = { channel_name };
-    YamlNode*   c_node = dse_yaml_find_node_in_seq(
-        model_instance->spec, "channels", selectors, values, 1);
-    /* No channel was found with matching name. */
-    if (c_node == NULL) {
-        const char* selectors[] = { "alias" };
-        const char* values[] = { channel_name };
-        c_node = dse_yaml_find_node_in_seq(
-            model_instance->spec, "channels", selectors, values, 1);
-    }
-    /* No channel was found with matching alias. */
-    if (c_node == NULL) {
-        return NULL;
-    }
-
-    ChannelSpec* channel_spec = calloc(1, sizeof(ChannelSpec));
-    channel_spec->name = channel_name;
-    channel_spec->private = c_node;
-    YamlNode* n_node = dse_yaml_find_node(c_node, "name");
-    if (n_node && n_node->scalar) channel_spec->name = n_node->scalar;
-    YamlNode* a_node = dse_yaml_find_node(c_node, "alias");
-    if (a_node && a_node->scalar) channel_spec->alias = a_node->scalar;
-
-    return channel_spec; /* Caller to free. */
-}
-
-
-static int _signal_group_match_handler(
-    ModelInstanceSpec* model_instance, SchemaObject* object)
-{
-    uint32_t index = 0;
-
-    /* Enumerate over the signals. */
-    SchemaSignalObject* so;
-    do {
-        so = schema_object_enumerator(model_instance, object, "spec/signals",
-            &index, schema_signal_object_generator);
-        if (so == NULL) break;
-        if (strcmp(so->signal, __signal_match_name) == 0) {
-            __signal_match = so; /* Caller to free. */
-            return 0;
-        }
-        free(so);
-    } while (1);
-
-    return 0;
-}
-
-
-static const char** _signal_annotation_list(ModelInstanceSpec* mi,
-    SignalVector* sv, const char* signal, const char* name)
-{
-    /* Set the search vars. */
-    __signal_match = NULL;
-    __signal_match_name = signal;
-
-    /* Select and handle the schema objects. */
-    ChannelSpec*          cs = _model_build_channel_spec(mi, sv->name);
-    SchemaObjectSelector* selector;
-    selector = schema_build_channel_selector(mi, cs, "SignalGroup");
-    if (selector) {
-        schema_object_search(mi, selector, _signal_group_match_handler);
-    }
-    schema_release_selector(selector);
-    free(cs);
-    /* Look for the annotation. */
-    if (__signal_match) {
-        const char** v = NULL;
-        YamlNode*    a_node =
-            dse_yaml_find_node(__signal_match->data, "annotations");
-        if (a_node) {
-            v = dse_yaml_get_array(a_node, name, NULL);
-        }
-        free(__signal_match);
-        __signal_match = NULL;
-        return v;
-    }
-
-    return NULL;
-}
-
-
 void fmigateway_index_scalar_signals(
     FmuInstanceData* fmu, ModelGatewayDesc* m, HashMap* input, HashMap* output)
 {
@@ -132,27 +42,92 @@ void fmigateway_index_scalar_signals(
 }
 
 
-static inline void _set_binary_variable(ModelDesc* m, SignalVector* sv,
-    uint32_t index, HashMap* map, const char* vref)
+typedef struct BinaryIndexEntry {
+    HashMap*             map;
+    char*                vref;
+    FmuSignalVectorIndex handle;
+} BinaryIndexEntry;
+
+
+static FmuSignalVector* _binary_view(FmiGateway* fmi_gw, SignalVector* sv)
+{
+    /* Locate an existing view. */
+    for (size_t i = 0; i < fmi_gw->binary_index.sv_count; i++) {
+        if (fmi_gw->binary_index.sv[i].binary == sv->binary) {
+            return &fmi_gw->binary_index.sv[i];
+        }
+    }
+    return NULL;
+}
+
+
+static inline void _set_binary_variable(FmiGateway* fmi_gw, ModelDesc* m,
+    SignalVector* sv, uint32_t index, Vector* entries, HashMap* map,
+    const char* vref)
 {
     /* Locate the variable. */
     ModelSignalIndex idx = signal_index(m, sv->alias, sv->signal[index]);
     if (idx.binary == NULL) return;
 
-    FmuSignalVectorIndex* fmu_idx = calloc(1, sizeof(FmuSignalVectorIndex));
-    fmu_idx->sv = calloc(1, sizeof(FmuSignalVector));
-    fmu_idx->sv->binary = idx.sv->binary;
-    fmu_idx->sv->signal = (char**)idx.sv->signal;
-    fmu_idx->sv->length = idx.sv->length;
-    fmu_idx->sv->buffer_size = idx.sv->buffer_size;
-    fmu_idx->vi = idx.signal;
-    hashmap_set_alt(map, vref, fmu_idx);
+    /* Shared view of the underlying ModelC SignalVector. */
+    FmuSignalVector* view = _binary_view(fmi_gw, idx.sv);
+    if (view == NULL) return;
+
+    BinaryIndexEntry entry = {
+        .map = map,
+        .vref = strdup(vref),
+        .handle = { .sv = view, .vi = idx.signal },
+    };
+    vector_push(entries, &entry);
 }
 
 
-void fmigateway_index_binary_signals(
-    FmuInstanceData* fmu, ModelGatewayDesc* m, HashMap* rx, HashMap* tx)
+static void _create_binary_views(FmiGateway* fmi_gw, ModelGatewayDesc* m)
 {
+    size_t count = 0;
+    for (SignalVector* sv = m->sv; sv && sv->name; sv++) {
+        if (sv->is_binary) count++;
+    }
+    fmi_gw->binary_index.sv = calloc(count + 1, sizeof(FmuSignalVector));
+    fmi_gw->binary_index.sv_count = 0;
+    for (SignalVector* sv = m->sv; sv && sv->name; sv++) {
+        if (sv->is_binary == false) continue;
+        FmuSignalVector* view =
+            &fmi_gw->binary_index.sv[fmi_gw->binary_index.sv_count++];
+        view->name = sv->name;
+        view->count = sv->count;
+        view->signal = (char**)sv->signal;
+        view->binary = sv->binary;
+        view->length = sv->length;
+        view->buffer_size = sv->buffer_size;
+    }
+}
+
+
+static void _install_binary_handles(FmiGateway* fmi_gw, Vector* entries)
+{
+    /* Handles are stored in one table, the VRef maps reference the table. */
+    size_t count = vector_len(entries);
+    fmi_gw->binary_index.handle =
+        calloc(count + 1, sizeof(FmuSignalVectorIndex));
+    fmi_gw->binary_index.handle_count = count;
+    for (size_t i = 0; i < count; i++) {
+        BinaryIndexEntry* entry = vector_at(entries, i, NULL);
+        fmi_gw->binary_index.handle[i] = entry->handle;
+        hashmap_set(entry->map, entry->vref, &fmi_gw->binary_index.handle[i]);
+        free(entry->vref);
+    }
+    vector_reset(entries);
+}
+
+
+void fmigateway_index_binary_signals(FmuInstanceData* fmu, ModelGatewayDesc* m,
+    FmuAnnotationIndex* annotations, HashMap* rx, HashMap* tx)
+{
+    FmiGateway* fmi_gw = fmu->data;
+    Vector      entries = vector_make(sizeof(BinaryIndexEntry), 0, NULL);
+    _create_binary_views(fmi_gw, m);
+
     for (ModelInstanceSpec* mi = m->sim->instance_list; mi && mi->name; mi++) {
         for (SignalVector* sv = mi->model_desc->sv; sv && sv->name; sv++) {
             if (sv->is_binary == false) continue;
@@ -165,32 +140,34 @@ void fmigateway_index_binary_signals(
 
                 /* FMU binary input variables. */
                 /* Index according to bus topology. */
-                const char** rx_list = _signal_annotation_list(sv->mi, sv,
-                    sv->signal[i], "dse.standards.fmi-ls-bus-topology.rx_vref");
+                const char** rx_list = fmu_annotation_index_get_array(
+                    annotations, sv, sv->signal[i],
+                    "dse.standards.fmi-ls-bus-topology.rx_vref");
                 if (rx_list) {
                     for (size_t j = 0; rx_list[j]; j++) {
                         /* Value Reference for the RX variable. */
                         const char* rx_vref = rx_list[j];
 
-                        /* Create a FmuSignalVector and add it to the map. */
-                        _set_binary_variable(
-                            m->mi->model_desc, sv, i, rx, rx_vref);
+                        /* Add a handle (to the shared view) to the map. */
+                        _set_binary_variable(fmi_gw, m->mi->model_desc, sv,
+                            i, &entries, rx, rx_vref);
                     }
                     free(rx_list);
                 }
 
                 /* FMU binary output variables. */
                 /* Index according to bus topology. */
-                const char** tx_list = _signal_annotation_list(sv->mi, sv,
-                    sv->signal[i], "dse.standards.fmi-ls-bus-topology.tx_vref");
+                const char** tx_list = fmu_annotation_index_get_array(
+                    annotations, sv, sv->signal[i],
+                    "dse.standards.fmi-ls-bus-topology.tx_vref");
                 if (tx_list) {
                     for (size_t j = 0; tx_list[j]; j++) {
                         /* Value Reference for the TX variable. */
                         const char* tx_vref = tx_list[j];
 
-                        /* Create a FmuSignalVector and add it to the map. */
-                        _set_binary_variable(
-                            m->mi->model_desc, sv, i, tx, tx_vref);
+                        /* Add a handle (to the shared view) to the map. */
+                        _set_binary_variable(fmi_gw, m->mi->model_desc, sv,
+                            i, &entries, tx, tx_vref);
                     }
                     free(tx_list);
                 }
@@ -198,13 +175,15 @@ void fmigateway_index_binary_signals(
         }
     }
 
-    fmu_log(fmu, 0, "Debug", "  Binary: rx=%lu, tx=%lu", rx->used_nodes,
-        tx->used_nodes);
+    _install_binary_handles(fmi_gw, &entries);
+
+    fmu_log(fmu, 0, "Debug", "  Binary: rx=%lu, tx=%lu (views=%lu)",
+        rx->used_nodes, tx->used_nodes, fmi_gw->binary_index.sv_count);
 }
 
 
 void fmigateway_index_text_encoding(FmuInstanceData* fmu, ModelGatewayDesc* m,
-    HashMap* encode_func, HashMap* decode_func)
+    FmuAnnotationIndex* annotations, HashMap* encode_func, HashMap* decode_func)
 {
     for (ModelInstanceSpec* mi = m->sim->instance_list; mi && mi->name; mi++) {
         for (SignalVector* sv = mi->model_desc->sv; sv && sv->name; sv++) {
@@ -223,8 +202,9 @@ void fmigateway_index_text_encoding(FmuInstanceData* fmu, ModelGatewayDesc* m,
 
                 /* Index, all with same encoding (for now). */
                 // dse.standards.fmi-ls-binary-to-text.vref: [[2,3,4,5,6,7,8,9]
-                const char** vref_list = _signal_annotation_list(sv->mi, sv,
-                    sv->signal[i], "dse.standards.fmi-ls-binary-to-text.vref");
+                const char** vref_list = fmu_annotation_index_get_array(
+                    annotations, sv, sv->signal[i],
+                    "dse.standards.fmi-ls-binary-to-text.vref");
                 if (vref_list) {
                     for (size_t j = 0; vref_list[j]; j++) {
                         /* Value Reference for the RX variable. */
@@ -36,6 +36,7 @@ typedef struct FmiParseConfig {
     const char* float_rt_param_xpath_fmt;
     const char* str_envar_xpath;
     const char* float_envar_xpath;
+    const char* stats_xpath;
     int         fmi_version;
 } FmiParseConfig;
 
@@ -47,6 +48,9 @@ typedef struct FmiParseGenContext {
 } FmiParseGenContext;
 
 
+#define STATS_PREFIX "dse.fmi.gateway.stats."
+
+
 /* FMI2: annotations live under VendorAnnotations/Tool[@name='dse.fmi.config'].
  * Structure: Tool / <dse:annotations> (namespaced wrapper, satisfies FMI 2.0
  * xs:any maxOccurs=1) / <dse:Annotation name="key">value</dse:Annotation>.
@@ -65,6 +69,10 @@ typedef struct FmiParseGenContext {
     "[@causality='parameter']"                                                 \
     "[" element "]"                                                            \
     "[Annotations/Tool[@name='dse.fmi.gateway." key "']]"
+#define FMI2_STATS                                                             \
+    "//ModelVariables/ScalarVariable"                                          \
+    "[@causality='output'][Real]"                                              \
+    "[Annotations/Tool[starts-with(@name,'" STATS_PREFIX "')]]"
 
 
 /* FMI3: annotations live under fmiModelDescription/Annotations, by @type. */
@@ -77,6 +85,9 @@ typedef struct FmiParseGenContext {
 #define FMI3_MV(element, key)                                                  \
     "//ModelVariables/" element "[@causality='parameter']"                     \
     "[Annotations/Annotation[@type='dse.fmi.gateway." key "']]"
+#define FMI3_STATS                                                             \
+    "//ModelVariables/Float64[@causality='output']"                            \
+    "[Annotations/Annotation[starts-with(@type,'" STATS_PREFIX "')]]"
 
 
 static const FmiParseConfig _cfg_fmi2 = {
@@ -89,6 +100,7 @@ static const FmiParseConfig _cfg_fmi2 = {
     .float_rt_param_xpath_fmt = FMI2_MV("Real", "%s.parameter"),
     .str_envar_xpath = FMI2_MV("String", "script.parameter"),
     .float_envar_xpath = FMI2_MV("Real", "script.parameter"),
+    .stats_xpath = FMI2_STATS,
 };
 
 
@@ -102,6 +114,7 @@ static const FmiParseConfig _cfg_fmi3 = {
     .float_rt_param_xpath_fmt = FMI3_MV("Float64", "%s.parameter"),
     .str_envar_xpath = FMI3_MV("String", "script.parameter"),
     .float_envar_xpath = FMI3_MV("Float64", "script.parameter"),
+    .stats_xpath = FMI3_STATS,
 };
 
 
@@ -312,6 +325,70 @@ static void _parse_xml_script_envar(
 }
 
 
+static FmiGatewayStatsMetric _stats_metric(xmlNodePtr var)
+{
+    /* FMI2: Annotations/Tool[@name], FMI3: Annotations/Annotation[@type]. */
+    for (xmlNodePtr a = var->children; a; a = a->next) {
+        if (a->type != XML_ELEMENT_NODE) continue;
+        if (xmlStrcmp(a->name, BAD_CAST "Annotations") != 0) continue;
+        for (xmlNodePtr t = a->children; t; t = t->next) {
+            if (t->type != XML_ELEMENT_NODE) continue;
+            xmlChar* name = xmlGetProp(t, BAD_CAST "name");
+            if (name == NULL) name = xmlGetProp(t, BAD_CAST "type");
+            if (name == NULL) continue;
+            FmiGatewayStatsMetric metric = FMIGATEWAY_STATS_NONE;
+            if (strncmp((char*)name, STATS_PREFIX, strlen(STATS_PREFIX)) == 0) {
+                metric = fmigateway_stats_metric(
+                    (char*)name + strlen(STATS_PREFIX));
+            }
+            xmlFree(name);
+            if (metric != FMIGATEWAY_STATS_NONE) return metric;
+        }
+    }
+    return FMIGATEWAY_STATS_NONE;
+}
+
+
+static void* _stats_generator(xmlNodePtr node, void* userdata)
+{
+    xmlChar* vref = xmlGetProp(node, BAD_CAST "valueReference");
+    if (vref == NULL) return NULL;
+    FmiGatewayStatsMetric metric = _stats_metric(node);
+    if (metric == FMIGATEWAY_STATS_NONE) {
+        xmlFree(vref);
+        return userdata; /* Unknown metric, continue enumeration. */
+    }
+
+    FmiGatewayStatsVariable* v = calloc(1, sizeof(FmiGatewayStatsVariable));
+    v->vref = strdup((char*)vref);
+    v->metric = metric;
+    xmlFree(vref);
+    return v;
+}
+
+
+static void _parse_stats(
+    FmuInstanceData* fmu, xmlXPathContextPtr ctx, const FmiParseConfig* cfg)
+{
+    FmiGateway* fmi_gw = fmu->data;
+
+    HashList s_list;
+    hashlist_init(&s_list, 16);
+
+    FmiParseGenContext gctx = { .fmu = fmu, .cfg = cfg };
+    uint32_t           index = 0;
+    void*              v;
+    while ((v = xml_object_enumerator(
+                ctx, cfg->stats_xpath, &index, _stats_generator, &gctx)) !=
+           NULL) {
+        if (v != &gctx) hashlist_append(&s_list, v);
+    }
+
+    fmi_gw->stats.variables =
+        hashlist_ntl(&s_list, sizeof(FmiGatewayStatsVariable), true);
+}
+
+
 static void fmigateway_parse_xml_config(
     FmuInstanceData* fmu, const FmiParseConfig* cfg)
 {
@@ -330,6 +407,7 @@ static void fmigateway_parse_xml_config(
         _parse_simulation_settings(fmu, ctx, cfg);
         _parse_runtime(fmu, ctx, cfg);
         _parse_xml_script_envar(fmu, ctx, cfg);
+        _parse_stats(fmu, ctx, cfg);
         xmlXPathFreeContext(ctx);
     }
 
@@ -352,6 +430,8 @@ information is extracted:
   runtime (e.g. simer) as input parameters.
 - Script environment variables: string and scalar FMU variables annotated as
   script parameters, including their default values.
+- Statistics: scalar output FMU variables annotated with
+  `dse.fmi.gateway.stats.<metric>`, which publish gateway instrumentation.
 
 Parameters
 ----------
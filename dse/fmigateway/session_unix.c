@@ -4,15 +4,465 @@
 
 #include <stdlib.h>
 #include <limits.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
 #include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
+#include <dse/clib/util/strings.h>
 #include <dse/fmu/fmu.h>
 #include <dse/fmigateway/fmigateway.h>
 
 
+#define MAX_CMD_LENGTH        2048
+#define PROCESS_POLL_NS       10000000 /* 10 ms */
+#define PROCESS_READY_TIMEOUT 60       /* Seconds. */
+#define PROCESS_EXIT_TIMEOUT  10       /* Seconds. */
+
+
+extern char** environ;
+
+
+typedef struct UnixProcess {
+    pid_t pid;
+} UnixProcess;
+
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static void _poll_sleep(void)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = PROCESS_POLL_NS };
+    nanosleep(&ts, NULL);
+}
+
+
+static char* _format(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (len < 0) return NULL;
+
+    char* s = calloc(len + 1, sizeof(char));
+    if (s == NULL) return NULL;
+    va_start(args, format);
+    vsnprintf(s, len + 1, format, args);
+    va_end(args);
+    return s; /* Caller to free. */
+}
+
+
+/*
+_build_cmd
+==========
+
+Build the command for the modelC process from the yaml parameters. The
+command is executed by the shell in the resource directory, `exec` replaces
+the shell so that the spawned PID is the PID of the model.
+
+Parameters
+----------
+w_model (WindowsModel)
+: Model Descriptor containing parameter information.
+
+path (const char*)
+: The working directory of the model (resource location).
+
+Returns
+-------
+string
+: string containing the cmd to start a model (caller to free), or NULL if
+  the cmd could not be formatted.
+*/
+static char* _build_cmd(WindowsModel* w_model, const char* path)
+{
+    /* Formatted to its full length, the cmd is never truncated. */
+    return _format("cd '%s' && exec %s --name %s --endtime %lf --stepsize %lf "
+                   "--logger %d --timeout %lf%s%s",
+        path, w_model->exe, w_model->name, w_model->end_time,
+        w_model->step_size, w_model->log_level, w_model->timeout,
+        w_model->yaml ? " " : "", w_model->yaml ? w_model->yaml : "");
+}
+
+
+/*
+_build_env
+==========
+
+Build the environment of a model process, the model specific environment
+variables take precedence over those of the parent environment.
+
+Parameters
+----------
+w_model (WindowsModel)
+: Model Descriptor containing parameter information.
+
+Returns
+-------
+char**
+: NULL terminated environment (caller to free, including the model
+  specific entries), or NULL if no environment variables are configured.
+*/
+static char** _build_env(WindowsModel* m)
+{
+    if (m->envar == NULL) return NULL;
+
+    size_t count = 0;
+    size_t parent_count = 0;
+    for (FmiGatewayParameter* e = m->envar; e && e->name; e++)
+        count++;
+    for (char** e = environ; e && *e; e++)
+        parent_count++;
+
+    char** env = calloc(count + parent_count + 1, sizeof(char*));
+    size_t i = 0;
+    for (FmiGatewayParameter* e = m->envar; e && e->name; e++) {
+        size_t len = strlen(e->name) + 1 + strlen(e->default_value) + 1;
+        env[i] = calloc(len, sizeof(char));
+        snprintf(env[i++], len, "%s=%s", e->name, e->default_value);
+    }
+    for (char** e = environ; e && *e; e++) {
+        env[i++] = *e;
+    }
+    return env;
+}
+
+
+static void _free_env(WindowsModel* m, char** env)
+{
+    if (env == NULL) return;
+    size_t i = 0;
+    for (FmiGatewayParameter* e = m->envar; e && e->name; e++) {
+        free(env[i++]);
+    }
+    free(env);
+}
+
+
+/*
+_spawn
+======
+
+Spawn a process (via the shell) in its own process group. The process is
+not waited on, its PID is returned for later supervision.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+name (const char*)
+: Name of the process, used for logging.
+
+cmd (const char*)
+: The shell command to execute.
+
+env (char**)
+: The environment of the process, NULL to inherit the parent environment.
+
+log (const char*)
+: Path of a log file for stdout/stderr, NULL to inherit the parent output.
+
+quiet (bool)
+: Discard stdout/stderr of the process (when no log file is set).
+
+Returns
+-------
+pid_t
+: PID of the spawned process, or -1 on failure.
+*/
+static pid_t _spawn(FmuInstanceData* fmu, const char* name, const char* cmd,
+    char** env, const char* log, bool quiet)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t          attr;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+
+    /* Own process group, signals are delivered to the whole group. */
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    /* Output redirection. */
+    const char* output = log ? log : (quiet ? "/dev/null" : NULL);
+    if (output) {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, output,
+            O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_adddup2(
+            &actions, STDOUT_FILENO, STDERR_FILENO);
+    }
+
+    pid_t pid = -1;
+    char* argv[] = { "sh", "-c", (char*)cmd, NULL };
+    fmu_log(fmu, FmiLogOk, "Debug", "Starting process: %s (%s)", name, cmd);
+    int rc = posix_spawn(&pid, "/bin/sh", &actions, &attr, argv,
+        env ? env : environ);
+    if (rc != 0) {
+        fmu_log(fmu, FmiLogError, "Error", "Could not start %s (%s)", name,
+            strerror(rc));
+        pid = -1;
+    }
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    return pid;
+}
+
+
+static char* _log_file(FmuInstanceData* fmu, const char* name)
+{
+    FmiGateway* fmi_gw = fmu->data;
+    const char* log_location = fmi_gw->settings.runtime.log_location;
+    if (log_location == NULL || strlen(log_location) == 0) return NULL;
+
+    char log[PATH_MAX];
+    snprintf(log, sizeof(log), "%s/%s_log.txt", log_location, name);
+    return strdup(log);
+}
+
+
+/*
+_check_alive
+============
+
+Check if a process is still running, a terminated process is reaped and its
+process information released. An interrupted wait is retried. A process which
+is no longer a child (ECHILD, i.e. already reaped) is considered terminated,
+for other errors the process is probed with signal 0.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+w_model (WindowsModel)
+: Model Descriptor containing parameter information.
+
+Returns
+-------
+bool
+: true if process is still running, false otherwise.
+*/
+static bool _check_alive(FmuInstanceData* fmu, WindowsModel* w_model)
+{
+    UnixProcess* process = w_model->w_process;
+    if (process == NULL) return false;
+
+    int   status = 0;
+    pid_t rc;
+    do {
+        rc = waitpid(process->pid, &status, WNOHANG);
+    } while (rc < 0 && errno == EINTR);
+    if (rc == 0) return true;
+    if (rc < 0 && errno == ECHILD) {
+        fmu_log(fmu, FmiLogOk, "Info",
+            "%s is shut down (exit status not available).", w_model->name);
+    } else if (rc < 0) {
+        fmu_log(fmu, FmiLogWarning, "Warning", "%s could not be waited (%s).",
+            w_model->name, strerror(errno));
+        if (kill(process->pid, 0) == 0) return true;
+    } else if (rc == process->pid) {
+        if (WIFEXITED(status)) {
+            fmu_log(fmu, FmiLogOk, "Info", "%s is shut down (exit code: %d).",
+                w_model->name, WEXITSTATUS(status));
+        } else if (WIFSIGNALED(status)) {
+            fmu_log(fmu, FmiLogOk, "Info", "%s is shut down (signal: %d).",
+                w_model->name, WTERMSIG(status));
+        }
+    }
+    free(w_model->w_process);
+    w_model->w_process = NULL;
+    return false;
+}
+
+
+static void _signal(FmuInstanceData* fmu, WindowsModel* w_model, int sig)
+{
+    UnixProcess* process = w_model->w_process;
+    if (process == NULL) return;
+
+    fmu_log(fmu, FmiLogOk, "Debug", "Sending signal %d to process %s...", sig,
+        w_model->name);
+    kill(-process->pid, sig);
+}
+
+
+/*
+_wait_shutdown
+==============
+
+Wait, in parallel, for a list of processes to terminate. Processes which
+are still running when the timeout expires are killed.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+models (WindowsModel**)
+: List of Model Descriptors (entries may be NULL).
+
+count (size_t)
+: Number of entries in the list.
+
+sec (integer)
+: Time in seconds.
+*/
+static void _wait_shutdown(
+    FmuInstanceData* fmu, WindowsModel** models, size_t count, int sec)
+{
+    double deadline = _now() + sec;
+    while (1) {
+        bool alive = false;
+        for (size_t i = 0; i < count; i++) {
+            if (models[i] && _check_alive(fmu, models[i])) alive = true;
+        }
+        if (!alive) return;
+        if (_now() > deadline) break;
+        _poll_sleep();
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (models[i] == NULL || models[i]->w_process == NULL) continue;
+        fmu_log(fmu, FmiLogError, "Error", "%s is still active (killed).",
+            models[i]->name);
+        UnixProcess* process = models[i]->w_process;
+        kill(-process->pid, SIGKILL);
+        while (waitpid(process->pid, NULL, 0) < 0 && errno == EINTR) {
+        }
+        free(models[i]->w_process);
+        models[i]->w_process = NULL;
+    }
+}
+
+
+static bool _port_open(const char* port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+
+    struct sockaddr_in addr = { 0 };
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)atoi(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool open = (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    close(fd);
+    return open;
+}
+
+
+/*
+_start_transport
+================
+
+Start the transport (Redis) process and wait until it accepts connections
+on its port. A transport which is already listening on the port is reused.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+w_model (WindowsModel)
+: Model Descriptor containing parameter information.
+*/
+static void _start_transport(FmuInstanceData* fmu, WindowsModel* w_model)
+{
+    if (w_model->exe == NULL || w_model->args == NULL) return;
+    if (_port_open(w_model->args)) {
+        fmu_log(fmu, FmiLogOk, "Debug",
+            "Transport already listening on port %s, not started.",
+            w_model->args);
+        return;
+    }
+
+    /* Executable relative to the resource location, otherwise from PATH. */
+    char* file_path =
+        dse_path_cat(fmu->instance.resource_location, w_model->exe);
+    char cmd[MAX_CMD_LENGTH];
+    int  len = snprintf(cmd, sizeof(cmd), "exec %s --port %s",
+        (access(file_path, X_OK) == 0) ? file_path : w_model->exe,
+        w_model->args);
+    free(file_path);
+    if (len < 0 || (size_t)len >= sizeof(cmd)) {
+        fmu_log(fmu, FmiLogError, "Error", "Transport cmd too long (%s).",
+            w_model->name);
+        return;
+    }
+
+    FmiGateway*        fmi_gw = fmu->data;
+    FmiGatewaySession* session = fmi_gw->settings.session;
+    char* log = session->logging ? _log_file(fmu, w_model->name) : NULL;
+    pid_t pid = _spawn(fmu, w_model->name, cmd, NULL, log,
+        !session->visibility.transport);
+    free(log);
+    if (pid < 0) return;
+    UnixProcess* process = calloc(1, sizeof(UnixProcess));
+    process->pid = pid;
+    w_model->w_process = process;
+
+    /* Readiness: the transport accepts connections. */
+    double start = _now();
+    while (!_port_open(w_model->args)) {
+        if (!_check_alive(fmu, w_model)) {
+            fmu_log(fmu, FmiLogError, "Error", "Transport exited on startup.");
+            return;
+        }
+        if (_now() - start > PROCESS_READY_TIMEOUT) {
+            fmu_log(fmu, FmiLogError, "Error",
+                "Transport not ready on port %s.", w_model->args);
+            return;
+        }
+        _poll_sleep();
+    }
+    fmu_log(fmu, FmiLogOk, "Debug", "Transport ready on port %s (%.3f s).",
+        w_model->args, _now() - start);
+}
+
+
+static void _start_model(FmuInstanceData* fmu, WindowsModel* m, bool visible)
+{
+    FmiGateway*        fmi_gw = fmu->data;
+    FmiGatewaySession* session = fmi_gw->settings.session;
+    if (m->exe == NULL) return;
+
+    char* cmd = _build_cmd(m, fmu->instance.resource_location);
+    if (cmd == NULL) {
+        fmu_log(fmu, FmiLogError, "Error", "Could not build cmd for %s.",
+            m->name);
+        return;
+    }
+    char** env = _build_env(m);
+    char*  log = session->logging ? _log_file(fmu, m->name) : NULL;
+    pid_t  pid = _spawn(fmu, m->name, cmd, env, log, !visible);
+    if (pid >= 0) {
+        UnixProcess* process = calloc(1, sizeof(UnixProcess));
+        process->pid = pid;
+        m->w_process = process;
+    }
+    free(log);
+    _free_env(m, env);
+    free(cmd);
+}
+
+
 char* fmigateway_file_exists(FmuInstanceData* fmu, const char* name)
 {
     static const char* const extensions[] = { "sh", NULL };
@@ -34,18 +484,159 @@ int fmigateway_setenv(const char* name, const char* value)
 }
 
 
+/**
+fmigateway_start_models
+=======================
+
+Creates the processes (transport, simbus and models) configured in the
+session of the gateway. The transport is started first and is ready when it
+accepts connections on its port, the simbus and all models are then started
+concurrently. The processes connect to the simbus, and are therefore ready,
+when `model_gw_setup()` completes the gateway handshake.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+ */
 void fmigateway_start_models(FmuInstanceData* fmu)
 {
-    UNUSED(fmu);
+    FmiGateway*        fmi_gw = fmu->data;
+    FmiGatewaySession* session = fmi_gw->settings.session;
+    if (session == NULL) return;
+    double start = _now();
+
+    /* Transport process. */
+    if (session->transport) {
+        _start_transport(fmu, session->transport);
+    }
+
+    /* Simbus and model processes. */
+    if (session->simbus) {
+        _start_model(fmu, session->simbus, session->visibility.simbus);
+    }
+    for (WindowsModel* m = session->w_models; m && m->name; m++) {
+        _start_model(fmu, m, session->visibility.models);
+    }
+
+    /* Early failure (i.e. exec or configuration errors). */
+    if (session->simbus && session->simbus->w_process &&
+        !_check_alive(fmu, session->simbus)) {
+        fmu_log(fmu, FmiLogError, "Error", "%s exited on startup.",
+            session->simbus->name);
+    }
+    for (WindowsModel* m = session->w_models; m && m->name; m++) {
+        if (m->w_process && !_check_alive(fmu, m)) {
+            fmu_log(
+                fmu, FmiLogError, "Error", "%s exited on startup.", m->name);
+        }
+    }
+    fmu_log(fmu, FmiLogOk, "Debug", "Processes started (%.3f s).",
+        _now() - start);
 }
 
 
+static void _sync_extra_step(FmuInstanceData* fmu)
+{
+    FmiGateway*        fmi_gw = fmu->data;
+    FmiGatewaySession* session = fmi_gw->settings.session;
+    ModelGatewayDesc*  gw = fmi_gw->model;
+
+    if (fmi_gw->state < FMIGATEWAY_STATE_INITIALIZED) return;
+
+    double step_size =
+        session->simbus ? session->simbus->step_size : MODEL_DEFAULT_STEP_SIZE;
+    fmu_log(fmu, FmiLogOk, "Debug",
+        "Performing extra step to shutdown models (%f)...",
+        session->last_step + (step_size * 1.001));
+
+    model_gw_sync(gw, session->last_step + (step_size * 1.001));
+    fmu_log(fmu, FmiLogOk, "Debug",
+        "Extra step for shutting down models finished...");
+}
+
+
+static void _shutdown_models(FmuInstanceData* fmu)
+{
+    FmiGateway*        fmi_gw = fmu->data;
+    FmiGatewaySession* session = fmi_gw->settings.session;
+
+    /* Return if there are no models to handle. */
+    if (session->w_models == NULL) return;
+
+    /* If not a single step was taken, perform one for proper shutdown. */
+    if (fmi_gw->state < FMIGATEWAY_STATE_RUNNING) {
+        model_gw_sync(fmi_gw->model, session->last_step);
+    }
+
+    bool started = false;
+    for (WindowsModel* m = session->w_models; m && m->name; m++) {
+        if (m->w_process == NULL) continue;
+        _signal(fmu, m, SIGINT);
+        started = true;
+    }
+    if (!started) return;
+
+    bool extra_step = true;
+    /* Check if any model is still alive. */
+    for (WindowsModel* m = session->w_models; m && m->name; m++) {
+        if (_check_alive(fmu, m)) continue;
+        extra_step = false;
+        fmu_log(fmu, FmiLogOk, "Debug",
+            "Model %s shut down without extra step.", m->name);
+    }
+
+    if (extra_step) {
+        _sync_extra_step(fmu);
+    }
+}
+
+
+/**
+fmigateway_shutdown_models
+==========================
+
+Terminates all previously started processes. After sending the termination
+signals, one additional step is made by the gateway to close the simulation.
+The models and simbus are then awaited in parallel (processes which do not
+exit in time are killed), finally the transport is stopped.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+ */
 void fmigateway_shutdown_models(FmuInstanceData* fmu)
 {
-    FmiGateway*       fmi_gw = fmu->data;
-    ModelGatewayDesc* gw = fmi_gw->model;
-    model_gw_exit(gw);
-    fmu_log(fmu, 0, "Debug", "Gateway exited...");
+    FmiGateway*        fmi_gw = fmu->data;
+    FmiGatewaySession* session = fmi_gw->settings.session;
+    ModelGatewayDesc*  gw = fmi_gw->model;
+
+    if (session) _shutdown_models(fmu);
+
+    if (fmi_gw->state >= FMIGATEWAY_STATE_INITIALIZED) {
+        model_gw_exit(gw);
+        fmu_log(fmu, FmiLogOk, "Debug", "Gateway exited...");
+    }
+
+    if (session == NULL) return;
+
+    /* Wait for models and simbus (in parallel). */
+    size_t count = 1;
+    for (WindowsModel* m = session->w_models; m && m->name; m++)
+        count++;
+    WindowsModel** models = calloc(count, sizeof(WindowsModel*));
+    size_t         i = 0;
+    for (WindowsModel* m = session->w_models; m && m->name; m++)
+        models[i++] = m;
+    models[i] = session->simbus;
+    _wait_shutdown(fmu, models, count, PROCESS_EXIT_TIMEOUT);
+    free(models);
+
+    if (session->transport && session->transport->w_process) {
+        _signal(fmu, session->transport, SIGINT);
+        _wait_shutdown(fmu, &session->transport, 1, PROCESS_EXIT_TIMEOUT);
+    }
 }
 
 
@@ -96,15 +687,77 @@ int fmigateway_run_cmd(FmuInstanceData* fmu, const char* cmd_string)
 }
 
 
+/**
+fmigateway_run_simer
+====================
+
+Start SIMER (`<resource>/sim/bin/simer`) in the `sim` folder of the
+resource location. The SIMER command is taken from the FMU string input
+"0", or selected from the configured commands with the scalar input "1".
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+ */
 void fmigateway_run_simer(FmuInstanceData* fmu)
 {
-    UNUSED(fmu);  // No-op for now.
-    return;
+    FmiGateway* fmi_gw = fmu->data;
+
+    const char* simer_cmd =
+        hashmap_get(&fmu->variables.string.input, "0");  // NOLINT
+    if (simer_cmd == NULL || strlen(simer_cmd) == 0) {
+        double* simer_cmd_sel = hashmap_get(&fmu->variables.scalar.input, "1");
+        size_t  idx = (simer_cmd_sel && *simer_cmd_sel >= 0)
+                          ? (size_t)(*simer_cmd_sel)
+                          : 0;
+        if (idx < vector_len(&fmi_gw->settings.runtime.cmds)) {
+            simer_cmd =
+                *(char**)vector_at(&fmi_gw->settings.runtime.cmds, idx, NULL);
+        }
+    }
+
+    char work_dir[PATH_MAX];
+    char exe_path[PATH_MAX];
+    snprintf(
+        work_dir, sizeof(work_dir), "%s/sim", fmu->instance.resource_location);
+    snprintf(exe_path, sizeof(exe_path), "%s/bin/simer", work_dir);
+    if (access(exe_path, X_OK) != 0) {
+        fmu_log(fmu, FmiLogError, "Error", "Could not start SIMER (%s: %s)",
+            exe_path, strerror(errno));
+        return;
+    }
+
+    char cmd[MAX_CMD_LENGTH];
+    int  len = snprintf(cmd, sizeof(cmd), "cd '%s' && exec '%s' %s", work_dir,
+        exe_path, simer_cmd ? simer_cmd : "");
+    if (len < 0 || (size_t)len >= sizeof(cmd)) {
+        fmu_log(fmu, FmiLogError, "Error", "SIMER cmd too long.");
+        return;
+    }
+    char* log = _log_file(fmu, "SIMER");
+    if (log) fmu_log(fmu, FmiLogOk, "Debug", "  SIMER log file: %s", log);
+    pid_t pid = _spawn(fmu, "SIMER", cmd, NULL, log, false);
+    free(log);
+    if (pid < 0) return;
+
+    UnixProcess* process = calloc(1, sizeof(UnixProcess));
+    process->pid = pid;
+    fmi_gw->settings.runtime.simer_process = process;
+    fmu_log(fmu, FmiLogOk, "Debug", "SIMER started (PID %d)", (int)pid);
 }
 
 
 void fmigateway_stop_simer(FmuInstanceData* fmu)
 {
-    UNUSED(fmu);  // No-op for now.
-    return;
+    FmiGateway*  fmi_gw = fmu->data;
+    WindowsModel simer = { .name = (char*)"SIMER",
+        .w_process = fmi_gw->settings.runtime.simer_process };
+    if (simer.w_process == NULL) return;
+
+    WindowsModel* models[] = { &simer };
+    if (_check_alive(fmu, &simer)) _signal(fmu, &simer, SIGINT);
+    _wait_shutdown(fmu, models, 1, PROCESS_EXIT_TIMEOUT);
+    fmi_gw->settings.runtime.simer_process = NULL;
+    fmu_log(fmu, FmiLogOk, "Debug", "SIMER stopped.");
 }
@@ -63,22 +63,12 @@ void fmu_signals_setup(FmuInstanceData* fmu)
 }
 
 
-static inline int _free_fmu_idx(void* map_item, void* additional_data)
-{
-    UNUSED(additional_data);
-    FmuSignalVectorIndex* fmu_idx = map_item;
-    if (fmu_idx) {
-        free(fmu_idx->sv);
-    }
-    return 0;
-}
-
-
 /**
 fmu_signals_remove
 ==================
 
-This method frees the allocated binary signal indexes.
+This method frees the binary signal index (shared views and VRef handles).
+The binary rx/tx maps reference this index and do not own their values.
 
 Parameters
 ----------
@@ -88,9 +78,15 @@ fmu (FmuInstanceData*)
 void fmu_signals_remove(FmuInstanceData* fmu)
 {
     assert(fmu);
+    FmiGateway* fmi_gw = fmu->data;
+    if (fmi_gw == NULL) return; /* Already released by fmu_destroy(). */
     fmu_log(fmu, 0, "Debug", "Removing additional signal data...");
-    hashmap_iterator(&fmu->variables.binary.rx, _free_fmu_idx, false, NULL);
-    hashmap_iterator(&fmu->variables.binary.tx, _free_fmu_idx, false, NULL);
+    free(fmi_gw->binary_index.handle);
+    free(fmi_gw->binary_index.sv);
+    fmi_gw->binary_index.handle = NULL;
+    fmi_gw->binary_index.handle_count = 0;
+    fmi_gw->binary_index.sv = NULL;
+    fmi_gw->binary_index.sv_count = 0;
 }
 
 
@@ -0,0 +1,366 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dse/modelc/model.h>
+#include <dse/fmu/fmu.h>
+#include <dse/fmigateway/fmigateway.h>
+
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+
+static const struct {
+    const char*           name;
+    FmiGatewayStatsMetric metric;
+} _metric_names[] = {
+    { "steps", FMIGATEWAY_STATS_STEPS },
+    { "behind_count", FMIGATEWAY_STATS_BEHIND_COUNT },
+    { "sync_latency_mean", FMIGATEWAY_STATS_SYNC_LATENCY_MEAN },
+    { "sync_latency_max", FMIGATEWAY_STATS_SYNC_LATENCY_MAX },
+    { "sync_latency_p50", FMIGATEWAY_STATS_SYNC_LATENCY_P50 },
+    { "sync_latency_p99", FMIGATEWAY_STATS_SYNC_LATENCY_P99 },
+    { "bytes_step", FMIGATEWAY_STATS_BYTES_STEP },
+    { "bytes_total", FMIGATEWAY_STATS_BYTES_TOTAL },
+    { "skip_count", FMIGATEWAY_STATS_SKIP_COUNT },
+    { "coalesce_count", FMIGATEWAY_STATS_COALESCE_COUNT },
+};
+
+
+/**
+fmigateway_stats_now
+====================
+
+Returns
+-------
+double
+: The current time (seconds) of the monotonic clock.
+*/
+double fmigateway_stats_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+
+/**
+fmigateway_stats_metric
+=======================
+
+Decode a metric name (e.g. from a `dse.fmi.gateway.stats.<metric>`
+annotation).
+
+Parameters
+----------
+name (const char*)
+: The name of the metric.
+
+Returns
+-------
+FmiGatewayStatsMetric
+: The metric, or FMIGATEWAY_STATS_NONE if the name is not known.
+*/
+FmiGatewayStatsMetric fmigateway_stats_metric(const char* name)
+{
+    if (name == NULL) return FMIGATEWAY_STATS_NONE;
+    for (size_t i = 0; i < ARRAY_SIZE(_metric_names); i++) {
+        if (strcmp(_metric_names[i].name, name) == 0) {
+            return _metric_names[i].metric;
+        }
+    }
+    return FMIGATEWAY_STATS_NONE;
+}
+
+
+/**
+fmigateway_stats_binary_bytes
+=============================
+
+Count the bytes currently held by the binary signals of the gateway.
+
+Parameters
+----------
+m (ModelGatewayDesc*)
+: The Model Gateway.
+
+Returns
+-------
+uint64_t
+: Total length of all binary signals.
+*/
+uint64_t fmigateway_stats_binary_bytes(ModelGatewayDesc* m)
+{
+    uint64_t bytes = 0;
+    if (m == NULL) return 0;
+    for (SignalVector* sv = m->sv; sv && sv->name; sv++) {
+        if (sv->is_binary == false) continue;
+        for (uint32_t i = 0; i < sv->count; i++) {
+            bytes += sv->length[i];
+        }
+    }
+    return bytes;
+}
+
+
+/**
+fmigateway_stats_record
+=======================
+
+Record the statistics of one gateway step.
+
+Parameters
+----------
+fmi_gw (FmiGateway*)
+: The FMI Gateway.
+
+latency (double)
+: The time (seconds, monotonic clock) spent in `model_gw_sync()`.
+
+behind (bool)
+: The gateway was behind the SimBus (E_GATEWAYBEHIND).
+
+bytes (uint64_t)
+: Bytes exchanged (binary signals, both directions) during the step.
+*/
+void fmigateway_stats_record(
+    FmiGateway* fmi_gw, double latency, bool behind, uint64_t bytes)
+{
+    FmiGatewayStats* s = &fmi_gw->stats;
+
+    s->steps++;
+    if (behind) s->behind_count++;
+    s->latency_total += latency;
+    if (latency > s->latency_max) s->latency_max = latency;
+    s->bytes_step = bytes;
+    s->bytes_total += bytes;
+
+    /* Histogram, bucket N holds latencies below 2^(N+1) microseconds. */
+    double   us = latency * 1e6;
+    unsigned bucket = 0;
+    while (us >= 2.0 && bucket < FMIGATEWAY_STATS_HIST_BUCKETS - 1) {
+        us /= 2.0;
+        bucket++;
+    }
+    s->latency_hist[bucket]++;
+}
+
+
+/**
+fmigateway_stats_skip
+=====================
+
+Record an FMU step which was short-circuited (no sync) because it falls
+before the next SimBus sync.
+
+Parameters
+----------
+fmi_gw (FmiGateway*)
+: The FMI Gateway.
+*/
+void fmigateway_stats_skip(FmiGateway* fmi_gw)
+{
+    fmi_gw->stats.skip_count++;
+}
+
+
+/**
+fmigateway_stats_coalesce
+=========================
+
+Record SimBus steps which were coalesced into a single sync (the FMU step
+is coarser than the SimBus step).
+
+Parameters
+----------
+fmi_gw (FmiGateway*)
+: The FMI Gateway.
+
+n (uint64_t)
+: Number of additional SimBus steps performed by the sync.
+*/
+void fmigateway_stats_coalesce(FmiGateway* fmi_gw, uint64_t n)
+{
+    fmi_gw->stats.coalesce_count += n;
+}
+
+
+/**
+fmigateway_stats_percentile
+===========================
+
+Estimate a sync latency percentile from the histogram.
+
+Parameters
+----------
+fmi_gw (FmiGateway*)
+: The FMI Gateway.
+
+p (double)
+: The percentile (0.0 .. 1.0).
+
+Returns
+-------
+double
+: Upper bound (seconds) of the histogram bucket containing the percentile.
+*/
+double fmigateway_stats_percentile(FmiGateway* fmi_gw, double p)
+{
+    FmiGatewayStats* s = &fmi_gw->stats;
+    if (s->steps == 0) return 0.0;
+
+    uint64_t target = (uint64_t)ceil(p * s->steps);
+    if (target == 0) target = 1;
+    uint64_t count = 0;
+    for (unsigned i = 0; i < FMIGATEWAY_STATS_HIST_BUCKETS; i++) {
+        count += s->latency_hist[i];
+        if (count >= target) {
+            double upper = ldexp(1.0, i + 1) / 1e6;
+            return upper < s->latency_max ? upper : s->latency_max;
+        }
+    }
+    return s->latency_max;
+}
+
+
+static double _metric_value(FmiGateway* fmi_gw, FmiGatewayStatsMetric metric)
+{
+    FmiGatewayStats* s = &fmi_gw->stats;
+    switch (metric) {
+    case FMIGATEWAY_STATS_STEPS:
+        return (double)s->steps;
+    case FMIGATEWAY_STATS_BEHIND_COUNT:
+        return (double)s->behind_count;
+    case FMIGATEWAY_STATS_SYNC_LATENCY_MEAN:
+        return s->steps ? s->latency_total / s->steps : 0.0;
+    case FMIGATEWAY_STATS_SYNC_LATENCY_MAX:
+        return s->latency_max;
+    case FMIGATEWAY_STATS_SYNC_LATENCY_P50:
+        return fmigateway_stats_percentile(fmi_gw, 0.50);
+    case FMIGATEWAY_STATS_SYNC_LATENCY_P99:
+        return fmigateway_stats_percentile(fmi_gw, 0.99);
+    case FMIGATEWAY_STATS_BYTES_STEP:
+        return (double)s->bytes_step;
+    case FMIGATEWAY_STATS_BYTES_TOTAL:
+        return (double)s->bytes_total;
+    case FMIGATEWAY_STATS_SKIP_COUNT:
+        return (double)s->skip_count;
+    case FMIGATEWAY_STATS_COALESCE_COUNT:
+        return (double)s->coalesce_count;
+    default:
+        return 0.0;
+    }
+}
+
+
+/**
+fmigateway_stats_index
+======================
+
+Index the (optional) statistics FMU output variables as scalar outputs. Call
+after the scalar signals are indexed; a statistics variable with a value
+reference which is already indexed (i.e. to a SimBus signal) is rejected.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+*/
+void fmigateway_stats_index(FmuInstanceData* fmu)
+{
+    FmiGateway* fmi_gw = fmu->data;
+    HashMap*    output = &fmu->variables.scalar.output;
+
+    for (FmiGatewayStatsVariable* v = fmi_gw->stats.variables; v && v->vref;
+        v++) {
+        v->value = NULL;
+        if (hashmap_get(output, v->vref)) {
+            fmu_log(fmu, FmiLogError, "Error",
+                "Stats variable (vref=%s) collides with an indexed signal, "
+                "ignored",
+                v->vref);
+            continue;
+        }
+        hashmap_set_double(output, v->vref, 0.0);
+        v->value = hashmap_get(output, v->vref);
+    }
+}
+
+
+/**
+fmigateway_stats_publish
+========================
+
+Update the (optional) statistics FMU output variables.
+
+Parameters
+----------
+fmi_gw (FmiGateway*)
+: The FMI Gateway.
+*/
+void fmigateway_stats_publish(FmiGateway* fmi_gw)
+{
+    for (FmiGatewayStatsVariable* v = fmi_gw->stats.variables; v && v->vref;
+        v++) {
+        if (v->value) *v->value = _metric_value(fmi_gw, v->metric);
+    }
+}
+
+
+/**
+fmigateway_stats_summary
+========================
+
+Log a summary of the gateway statistics.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+*/
+void fmigateway_stats_summary(FmuInstanceData* fmu)
+{
+    FmiGateway* fmi_gw = fmu->data;
+    if (fmi_gw == NULL || fmi_gw->stats.steps == 0) return;
+
+    fmu_log(fmu, FmiLogOk, "Info",
+        "Gateway stats: steps=%" PRIu64 ", behind=%" PRIu64 ", skip=%" PRIu64
+        ", coalesce=%" PRIu64 ", bytes=%" PRIu64,
+        fmi_gw->stats.steps, fmi_gw->stats.behind_count,
+        fmi_gw->stats.skip_count, fmi_gw->stats.coalesce_count,
+        fmi_gw->stats.bytes_total);
+    fmu_log(fmu, FmiLogOk, "Info",
+        "Gateway sync latency (us): mean=%.1f, p50=%.1f, p99=%.1f, max=%.1f",
+        _metric_value(fmi_gw, FMIGATEWAY_STATS_SYNC_LATENCY_MEAN) * 1e6,
+        fmigateway_stats_percentile(fmi_gw, 0.50) * 1e6,
+        fmigateway_stats_percentile(fmi_gw, 0.99) * 1e6,
+        fmi_gw->stats.latency_max * 1e6);
+}
+
+
+/**
+fmigateway_stats_destroy
+========================
+
+Release the statistics FMU output variable list.
+
+Parameters
+----------
+fmi_gw (FmiGateway*)
+: The FMI Gateway.
+*/
+void fmigateway_stats_destroy(FmiGateway* fmi_gw)
+{
+    for (FmiGatewayStatsVariable* v = fmi_gw->stats.variables; v && v->vref;
+        v++) {
+        free(v->vref);
+    }
+    free(fmi_gw->stats.variables);
+    fmi_gw->stats.variables = NULL;
+}
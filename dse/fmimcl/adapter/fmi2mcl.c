@@ -2,16 +2,21 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <inttypes.h>
 #include <string.h>
 #include <stdio.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <time.h>
 #include <dse/fmimcl/fmimcl.h>
 #include <dse/fmimcl/adapter/fmi2mcl.h>
 #include <dse/logger.h>
 
 
-#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
-#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x)         (sizeof(x) / sizeof(x[0]))
+#define UNUSED(x)             ((void)x)
+#define ASYNC_DEFAULT_TIMEOUT 60.0   /* Seconds. */
+#define ASYNC_POLL_NS         100000 /* 100 us. */
 
 /**
 FMI2 Model Compatibility Library
@@ -40,8 +45,13 @@ static void fmu2_logger_callback(fmi2ComponentEnvironment componentEnvironment,
 static void fmu2_step_finished_callback(
     fmi2ComponentEnvironment componentEnvironment, fmi2Status status)
 {
-    UNUSED(componentEnvironment);
-    UNUSED(status);
+    FmuModel* m = componentEnvironment;
+    if (m == NULL || m->adapter == NULL) return;
+    Fmi2Adapter* a = m->adapter;
+
+    /* Called (possibly from an FMU thread) when an async DoStep completes. */
+    a->async.status = status;
+    __atomic_store_n(&a->async.finished, true, __ATOMIC_RELEASE);
 }
 
 
@@ -112,6 +122,13 @@ static int32_t fmi2mcl_load(FmuModel* m)
     a->callbacks.freeMemory = free;
     a->callbacks.logger = fmu2_logger_callback;
     a->callbacks.stepFinished = fmu2_step_finished_callback;
+    a->callbacks.componentEnvironment = m;
+
+    /* Optional, used to poll the status of an async DoStep. */
+    if (m->async_step) {
+        a->async.get_status = dlsym(handle, "fmi2GetStatus");
+        dlerror();
+    }
 
     return 0;
 }
@@ -160,29 +177,7 @@ static int32_t fmi2mcl_init(FmuModel* m)
 }
 
 
-static int32_t fmi2mcl_step(FmuModel* m, double* model_time, double end_time)
-{
-    log_trace("Step: model_time: %f, end_time: %f", *model_time, end_time);
-
-    Fmi2Adapter* a = m->adapter;
-    int          rc = 0;
-
-    errno = 0;
-    rc = a->vtable.do_step(
-        a->fmi2_inst, *model_time, (end_time - *model_time), fmi2True);
-    if (errno) {
-        log_debug("FMU set errno (%d): %s", errno, strerror(errno));
-        errno = 0;
-    }
-    if (rc > 0) {
-        return EBADMSG;
-    };
-    *model_time = end_time;
-    return 0;
-}
-
-
-static int32_t fmi2mcl_marshal_in(FmuModel* m)
+static int32_t _fmi2mcl_get_variables(FmuModel* m)
 {
     Fmi2Adapter* a = m->adapter;
     int          rc = 0;
@@ -283,11 +278,142 @@ static int32_t fmi2mcl_marshal_in(FmuModel* m)
 }
 
 
+static int32_t _fmi2mcl_async_wait(FmuModel* m)
+{
+    Fmi2Adapter* a = m->adapter;
+
+    /* A failed async step may still be running in the FMU, the instance can
+       not be used again (neither stepped nor freed). */
+    if (a->async.failed) return ECANCELED;
+    if (a->async.pending == false) return 0;
+
+    /* Wait for the async step to finish (or timeout), polling at an interval
+       rather than spinning. */
+    double timeout =
+        (m->async_timeout > 0) ? m->async_timeout : ASYNC_DEFAULT_TIMEOUT;
+    struct timespec poll = { .tv_sec = 0, .tv_nsec = ASYNC_POLL_NS };
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double     deadline = ts.tv_sec + ts.tv_nsec / 1e9 + timeout;
+    fmi2Status status = fmi2Pending;
+    while (1) {
+        if (__atomic_load_n(&a->async.finished, __ATOMIC_ACQUIRE)) {
+            status = a->async.status;
+            break;
+        }
+        if (a->async.get_status) {
+            errno = 0;
+            int rc = a->async.get_status(
+                a->fmi2_inst, fmi2DoStepStatus, &status);
+            if (errno) errno = 0;
+            if (rc > fmi2Warning) {
+                log_error("FMI2 async step status not available (rc=%d)", rc);
+                a->async.failed = true;
+                return EBADMSG;
+            }
+            if (status != fmi2Pending) break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        if (ts.tv_sec + ts.tv_nsec / 1e9 > deadline) {
+            log_error("FMI2 async step did not finish within %.3f s", timeout);
+            a->async.failed = true;
+            return ETIMEDOUT;
+        }
+        nanosleep(&poll, NULL);
+    }
+    a->async.pending = false;
+    log_trace("Step finished (async): status=%d", status);
+    if (status > fmi2Warning) return EBADMSG;
+
+    /* Collect the outputs of the completed step. */
+    return _fmi2mcl_get_variables(m);
+}
+
+
+static int32_t fmi2mcl_step(FmuModel* m, double* model_time, double end_time)
+{
+    log_trace("Step: model_time: %f, end_time: %f", *model_time, end_time);
+
+    Fmi2Adapter* a = m->adapter;
+    int          rc = 0;
+    double       start_time = *model_time;
+
+    /* Multi-rate, skip MCL steps until the step ratio is reached (inputs
+       are still set, the FMU observes the latest value). */
+    if (m->multirate.ratio > 1) {
+        if (m->multirate.phase == 0) m->multirate.start_time = *model_time;
+        m->multirate.phase++;
+        if (m->multirate.phase < m->multirate.ratio) {
+            log_trace("Step held: phase %u of %u", m->multirate.phase,
+                m->multirate.ratio);
+            m->multirate.held = true;
+            m->multirate.steps_skipped++;
+            *model_time = end_time;
+            return 0;
+        }
+        m->multirate.phase = 0;
+        start_time = m->multirate.start_time;
+    }
+    m->multirate.held = false;
+    m->multirate.fmu_steps++;
+
+    /* A previous async step must complete before the next step. */
+    rc = _fmi2mcl_async_wait(m);
+    if (rc != 0) return rc;
+
+    errno = 0;
+    __atomic_store_n(&a->async.finished, false, __ATOMIC_RELEASE);
+    rc = a->vtable.do_step(
+        a->fmi2_inst, start_time, (end_time - start_time), fmi2True);
+    if (errno) {
+        log_debug("FMU set errno (%d): %s", errno, strerror(errno));
+        errno = 0;
+    }
+    if (rc == fmi2Pending && m->async_step) {
+        log_trace("Step pending (async)");
+        a->async.pending = true;
+        *model_time = end_time;
+        return 0;
+    }
+    if (rc > 0) {
+        return EBADMSG;
+    };
+    *model_time = end_time;
+    return 0;
+}
+
+
+static int32_t fmi2mcl_marshal_in(FmuModel* m)
+{
+    Fmi2Adapter* a = m->adapter;
+
+    /* Async step in progress, outputs are collected before the next step. */
+    if (a->async.pending) return 0;
+
+    /* Multi-rate, outputs are held until the FMU is next stepped. */
+    if (m->multirate.held) {
+        for (MarshalGroup* mg = m->data.mg_table; mg && mg->name; mg++) {
+            if (mg->dir == MARSHAL_DIRECTION_RXONLY ||
+                mg->dir == MARSHAL_DIRECTION_TXRX) {
+                m->multirate.outputs_held += mg->count;
+            }
+        }
+        return 0;
+    }
+
+    return _fmi2mcl_get_variables(m);
+}
+
+
 int32_t fmi2mcl_marshal_out(FmuModel* m)
 {
     Fmi2Adapter* a = m->adapter;
     int          rc = 0;
 
+    /* Variables cannot be set while an async step is pending. */
+    rc = _fmi2mcl_async_wait(m);
+    if (rc != 0) return rc;
+
     marshal_group_out(m->data.mg_table);
 
     log_trace("Marshal OUT (target -> FMU):");
@@ -387,9 +513,23 @@ static int32_t fmi2mcl_unload(FmuModel* m)
 {
     Fmi2Adapter* a = m->adapter;
 
+    if (m->multirate.ratio > 1) {
+        log_notice("FMU Multi-rate (ratio %u): fmu_steps=%" PRIu64
+                   ", steps_skipped=%" PRIu64 ", outputs_held=%" PRIu64,
+            m->multirate.ratio, m->multirate.fmu_steps,
+            m->multirate.steps_skipped, m->multirate.outputs_held);
+    }
+
+    if (_fmi2mcl_async_wait(m) != 0) {
+        /* The FMU may still be running the step (and may later call the
+           stepFinished callback), the instance and adapter are not freed. */
+        log_error("FMI2 async step did not complete, instance not freed");
+        return 0;
+    }
     a->vtable.free_instance(a->fmi2_inst);
 
     if (m->adapter) free(m->adapter);
+    m->adapter = NULL;
 
     return 0;
 }
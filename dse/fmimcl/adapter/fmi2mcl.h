@@ -23,6 +23,7 @@ typedef int32_t (*fmi2SetString)();
 typedef int32_t (*fmi2DoStep)();
 typedef int32_t (*fmi2Terminate)();
 typedef void (*fmi2FreeInstance)();
+typedef int32_t (*fmi2GetStatus)();
 
 typedef struct Fmi2VTable {
     fmi2Instantiate             instantiate;
@@ -46,6 +47,14 @@ typedef struct Fmi2Adapter {
     void*                 fmi2_inst;
     Fmi2VTable            vtable;
     fmi2CallbackFunctions callbacks;
+    /* Asynchronous DoStep (optional). */
+    struct {
+        fmi2GetStatus get_status;
+        bool          pending;
+        bool          finished; /* Set by the stepFinished callback. */
+        int32_t       status;
+        bool          failed; /* Step did not complete, instance abandoned. */
+    } async;
 } Fmi2Adapter;
 
 
@@ -213,6 +213,33 @@ center footer Dynamic Simulation Environment
 
 ![](fmimcl-sequence.png)
 
+
+Multi-Rate Stepping
+-------------------
+An FMU may be stepped at a lower rate than the simulation by setting the
+Model annotation `fmi_step_ratio` (an integer N). The FMU is then stepped
+once every N MCL steps, with a step size covering the skipped interval.
+Between FMU steps the outputs of the FMU are held (not read from the FMU).
+
+Inputs have latest-value semantics: scalar inputs are set on every MCL step,
+and the FMU observes only the most recent value when it is next stepped
+(values set in skipped steps are not integrated or averaged). Binary inputs
+are set with each MCL step, whether they are retained is determined by the
+FMU. The number of skipped steps and held outputs are logged when the MCL is
+unloaded.
+
+
+Asynchronous Stepping
+---------------------
+FMUs which support `canRunAsynchronuously` may be stepped asynchronously by
+setting the Model annotation `fmi_async_step` (true). When the FMU returns
+`fmi2Pending` from `fmi2DoStep` the MCL step returns immediately, and the FMU
+outputs are collected (via the `stepFinished` callback or `fmi2GetStatus`)
+before the inputs of the next step are set. The FMU therefore computes while
+ModelC exchanges SimBus data, and its outputs are delayed by one step. A step
+which does not finish within `fmi_async_timeout` seconds (default 60) is
+reported as an error.
+
 */
 
 
@@ -250,6 +277,8 @@ typedef struct FmuModel {
     const char* name;
     const char* version;
     bool        cosim;
+    bool        async_step;
+    double      async_timeout;
     const char* guid;
     const char* resource_dir;
     const char* path;
@@ -262,6 +291,17 @@ typedef struct FmuModel {
     void*       adapter;
     /* Data marshalling support. */
     FmuData     data;
+    /* Multi-rate stepping. */
+    struct {
+        uint32_t ratio; /* FMU is stepped once every `ratio` MCL steps. */
+        uint32_t phase; /* MCL steps since the last FMU step. */
+        double   start_time;
+        bool     held;
+        /* Counters. */
+        uint64_t fmu_steps;
+        uint64_t steps_skipped;
+        uint64_t outputs_held;
+    } multirate;
     /* Measurement file. */
     struct {
         char*            file_name;
@@ -167,8 +167,11 @@ static int _model_match_handler(ModelInstanceSpec* mi, SchemaObject* o)
     dse_yaml_get_string(m->m_doc, "metadata/annotations/mcl_adapter", &m->mcl.adapter);
     dse_yaml_get_string(m->m_doc, "metadata/annotations/mcl_version", &m->mcl.version);
     dse_yaml_get_bool(m->m_doc, "metadata/annotations/fmi_model_cosim", &m->cosim);
+    dse_yaml_get_bool(m->m_doc, "metadata/annotations/fmi_async_step", &m->async_step);
+    dse_yaml_get_double(m->m_doc, "metadata/annotations/fmi_async_timeout", &m->async_timeout);
     dse_yaml_get_string(m->m_doc, "metadata/annotations/fmi_model_version", &m->version);
     dse_yaml_get_double(m->m_doc, "metadata/annotations/fmi_stepsize", &m->mcl.step_size);
+    dse_yaml_get_uint(m->m_doc, "metadata/annotations/fmi_step_ratio", &m->multirate.ratio);
     dse_yaml_get_string(m->m_doc, "metadata/annotations/fmi_guid", &m->guid);
     dse_yaml_get_string(m->m_doc, "metadata/annotations/fmi_resource_dir", &m->resource_dir);
     // clang-format on
@@ -191,8 +194,15 @@ static int _model_match_handler(ModelInstanceSpec* mi, SchemaObject* o)
     log_notice("  MCL Adapter = %s", m->mcl.adapter);
     log_notice("  MCL Version = %s", m->mcl.version);
     log_notice("  CoSim = %s", m->cosim ? "true" : "false");
+    log_notice("  Async Step = %s", m->async_step ? "true" : "false");
+    if (m->async_step && m->async_timeout > 0) {
+        log_notice("  Async Timeout = %.3f", m->async_timeout);
+    }
     log_notice("  Model Version = %s", m->version);
     log_notice("  Model Stepsize = %.6f", m->mcl.step_size);
+    if (m->multirate.ratio > 1) {
+        log_notice("  Model Step Ratio = %u", m->multirate.ratio);
+    }
     log_notice("  Model GUID = %s", m->guid);
     log_notice("  Model Resource Directory = %s", m->resource_dir);
     log_notice("  Path = %s (%s/%s)", m->path, PLATFORM_OS, PLATFORM_ARCH);
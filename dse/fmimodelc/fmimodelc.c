@@ -88,9 +88,27 @@ Returns
 int32_t fmu_init(FmuInstanceData* fmu)
 {
     fmu_log(fmu, 0, "Debug", "Build indexes");
+    RuntimeModelDesc*   m = fmu->data;
+    FmuAnnotationIndex* annotations = fmu_annotation_index_create(m->model.sim);
     fmimodelc_index_scalar_signals(fmu);
-    fmimodelc_index_binary_signals(fmu);
-    fmimodelc_index_text_encoding(fmu);
+    fmimodelc_index_binary_signals(fmu, annotations);
+    fmimodelc_index_text_encoding(fmu, annotations);
+    fmu_annotation_index_destroy(annotations);
+
+    /* The worker pool size is validated and logged, but not yet used. The
+       model instances of the stack are stepped sequentially by
+       model_runtime_step() (ModelC), which performs the per-instance
+       marshalling internally and provides no per-instance step which could
+       be run concurrently. */
+    uint32_t pool_size = fmimodelc_worker_pool_size();
+    uint32_t instance_count = 0;
+    for (ModelInstanceSpec* mi = m->model.sim->instance_list; mi && mi->name;
+        mi++) {
+        instance_count++;
+    }
+    fmu_log(fmu, 0, "Debug",
+        "Worker pool: size=%u, instances=%u (stepped sequentially by ModelC)",
+        pool_size, instance_count);
 
     return 0;
 }
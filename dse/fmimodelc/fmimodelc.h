@@ -10,6 +10,7 @@
 #include <dse/modelc/adapter/simbus/simbus.h>
 #include <dse/modelc/runtime.h>
 #include <dse/fmu/fmu.h>
+#include <dse/fmu/annotation.h>
 
 
 #ifndef DLL_PUBLIC
@@ -53,9 +54,12 @@ center footer Dynamic Simulation Environment
 
 /* runtime.c */
 DLL_PRIVATE void fmimodelc_index_scalar_signals(FmuInstanceData* fmu);
-DLL_PRIVATE void fmimodelc_index_binary_signals(FmuInstanceData* fmu);
-DLL_PRIVATE void fmimodelc_index_text_encoding(FmuInstanceData* fmu);
+DLL_PRIVATE void fmimodelc_index_binary_signals(
+    FmuInstanceData* fmu, FmuAnnotationIndex* annotations);
+DLL_PRIVATE void fmimodelc_index_text_encoding(
+    FmuInstanceData* fmu, FmuAnnotationIndex* annotations);
 DLL_PRIVATE void fmimodelc_set_model_env(RuntimeModelDesc* m);
+DLL_PRIVATE uint32_t fmimodelc_worker_pool_size(void);
 
 /* env.c */
 DLL_PRIVATE int fmimodelc_setenv(const char* name, const char* value);
@@ -8,15 +8,16 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <errno.h>
+#include <string.h>
 #include <dse/fmimodelc/fmimodelc.h>
 #include <dse/fmu/fmu.h>
 #include <dse/modelc/runtime.h>
-#include <dse/modelc/schema.h>
 #include <dse/clib/util/yaml.h>
 
 
-static SchemaSignalObject* __signal_match;
-static const char*         __signal_match_name;
+#define WORKER_POOL_SIZE_ENVAR "FMIMODELC_WORKER_POOL_SIZE"
+#define WORKER_POOL_SIZE_MAX   64
 
 
 static void _log(const char* format, ...)
@@ -31,100 +32,6 @@ static void _log(const char* format, ...)
 }
 
 
-static int _signal_group_match_handler(
-    ModelInstanceSpec* model_instance, SchemaObject* object)
-{
-    uint32_t index = 0;
-
-    /* Enumerate over the signals. */
-    SchemaSignalObject* so;
-    do {
-        so = schema_object_enumerator(model_instance, object, "spec/signals",
-            &index, schema_signal_object_generator);
-        if (so == NULL) break;
-        if (strcmp(so->signal, __signal_match_name) == 0) {
-            __signal_match = so; /* Caller to free. */
-            return 0;
-        }
-        free(so);
-    } while (1);
-
-    return 0;
-}
-
-
-static ChannelSpec* _model_build_channel_spec(
-    ModelInstanceSpec* model_instance, const char* channel_name)
-{
-    _log("Search for channel on MI (%s) by name/alias=%s", model_instance->name,
-        channel_name);
-    const char* selectors[] = { "name" };
-    const char* values[] = { channel_name };
-    YamlNode*   c_node = dse_yaml_find_node_in_seq(
-        model_instance->spec, "channels", selectors, values, 1);
-    if (c_node) {
-        _log(" channel found by name");
-    } else {
-        const char* selectors[] = { "alias" };
-        const char* values[] = { channel_name };
-        c_node = dse_yaml_find_node_in_seq(
-            model_instance->spec, "channels", selectors, values, 1);
-        if (c_node) {
-            _log("  channel found by alias");
-        }
-    }
-    if (c_node == NULL) {
-        _log("Channel node (%s) not found on MI (%s)!", channel_name,
-            model_instance->name);
-        return NULL;
-    }
-
-    ChannelSpec* channel_spec = calloc(1, sizeof(ChannelSpec));
-    channel_spec->name = channel_name;
-    channel_spec->private = c_node;
-    YamlNode* n_node = dse_yaml_find_node(c_node, "name");
-    if (n_node && n_node->scalar) channel_spec->name = n_node->scalar;
-    YamlNode* a_node = dse_yaml_find_node(c_node, "alias");
-    if (a_node && a_node->scalar) channel_spec->alias = a_node->scalar;
-
-    return channel_spec; /* Caller to free. */
-}
-
-
-static const char** _signal_annotation_list(ModelInstanceSpec* mi,
-    SignalVector* sv, const char* signal, const char* name)
-{
-    /* Set the search vars. */
-    __signal_match = NULL;
-    __signal_match_name = signal;
-
-    /* Select and handle the schema objects. */
-    ChannelSpec*          cs = _model_build_channel_spec(mi, sv->name);
-    SchemaObjectSelector* selector;
-    selector = schema_build_channel_selector(mi, cs, "SignalGroup");
-    if (selector) {
-        schema_object_search(mi, selector, _signal_group_match_handler);
-    }
-    schema_release_selector(selector);
-    free(cs);
-
-    /* Look for the annotation. */
-    if (__signal_match) {
-        const char** v = NULL;
-        YamlNode*    a_node =
-            dse_yaml_find_node(__signal_match->data, "annotations");
-        if (a_node) {
-            v = dse_yaml_get_array(a_node, name, NULL);
-        }
-        free(__signal_match);
-        __signal_match = NULL;
-        return v;
-    }
-
-    return NULL;
-}
-
-
 void fmimodelc_index_scalar_signals(FmuInstanceData* fmu)
 {
     assert(fmu);
@@ -201,7 +108,8 @@ void fmimodelc_index_scalar_signals(FmuInstanceData* fmu)
 }
 
 
-void fmimodelc_index_binary_signals(FmuInstanceData* fmu)
+void fmimodelc_index_binary_signals(
+    FmuInstanceData* fmu, FmuAnnotationIndex* annotations)
 {
     assert(fmu);
     RuntimeModelDesc* m = fmu->data;
@@ -220,8 +128,9 @@ void fmimodelc_index_binary_signals(FmuInstanceData* fmu)
 
                 /* Index according to bus topology. */
                 // dse.standards.fmi-ls-bus-topology.rx_vref: [2,4,6,8]
-                const char** rx_list = _signal_annotation_list(sv->mi, sv,
-                    sv->signal[i], "dse.standards.fmi-ls-bus-topology.rx_vref");
+                const char** rx_list = fmu_annotation_index_get_array(
+                    annotations, sv, sv->signal[i],
+                    "dse.standards.fmi-ls-bus-topology.rx_vref");
                 if (rx_list) {
                     for (size_t j = 0; rx_list[j]; j++) {
                         /* Value Reference for the RX variable. */
@@ -243,8 +152,9 @@ void fmimodelc_index_binary_signals(FmuInstanceData* fmu)
                 }
 
                 // dse.standards.fmi-ls-bus-topology.tx_vref: [3,5,7,9]
-                const char** tx_list = _signal_annotation_list(sv->mi, sv,
-                    sv->signal[i], "dse.standards.fmi-ls-bus-topology.tx_vref");
+                const char** tx_list = fmu_annotation_index_get_array(
+                    annotations, sv, sv->signal[i],
+                    "dse.standards.fmi-ls-bus-topology.tx_vref");
                 if (tx_list) {
                     for (size_t j = 0; tx_list[j]; j++) {
                         /* Value Reference for the TX variable. */
@@ -273,7 +183,8 @@ void fmimodelc_index_binary_signals(FmuInstanceData* fmu)
 }
 
 
-void fmimodelc_index_text_encoding(FmuInstanceData* fmu)
+void fmimodelc_index_text_encoding(
+    FmuInstanceData* fmu, FmuAnnotationIndex* annotations)
 {
     assert(fmu);
     RuntimeModelDesc* m = fmu->data;
@@ -299,8 +210,9 @@ void fmimodelc_index_text_encoding(FmuInstanceData* fmu)
 
                 /* Index, all with same encoding (for now). */
                 // dse.standards.fmi-ls-binary-to-text.vref: [[2,3,4,5,6,7,8,9]
-                const char** vref_list = _signal_annotation_list(sv->mi, sv,
-                    sv->signal[i], "dse.standards.fmi-ls-binary-to-text.vref");
+                const char** vref_list = fmu_annotation_index_get_array(
+                    annotations, sv, sv->signal[i],
+                    "dse.standards.fmi-ls-binary-to-text.vref");
                 if (vref_list) {
                     for (size_t j = 0; vref_list[j]; j++) {
                         /* Value Reference for the RX variable. */
@@ -386,3 +298,21 @@ void fmimodelc_set_model_env(RuntimeModelDesc* m)
     hashmap_kv_iterator(&envars, envar_iterator, true);
     hashmap_destroy(&envars);
 }
+
+
+uint32_t fmimodelc_worker_pool_size(void)
+{
+    /* Set in the process environment or in the stack (spec/runtime/env). */
+    const char* value = getenv(WORKER_POOL_SIZE_ENVAR);
+    if (value == NULL || *value == '\0') return 1;
+
+    char* end = NULL;
+    errno = 0;
+    long  size = strtol(value, &end, 10);
+    if (errno || *end != '\0' || size < 1 || size > WORKER_POOL_SIZE_MAX) {
+        _log("Worker pool: invalid size (%s=%s, range 1..%d), using 1",
+            WORKER_POOL_SIZE_ENVAR, value, WORKER_POOL_SIZE_MAX);
+        return 1;
+    }
+    return (uint32_t)size;
+}
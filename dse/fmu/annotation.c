@@ -0,0 +1,196 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/clib/util/yaml.h>
+#include <dse/modelc/schema.h>
+#include <dse/fmu/annotation.h>
+
+
+typedef struct AnnotationSearch {
+    FmuAnnotationIndex* index;
+    const char*         instance;
+    const char*         channel;
+} AnnotationSearch;
+
+
+static char* _key(const char* instance, const char* channel, const char* signal)
+{
+    size_t len = snprintf(NULL, 0, "%s:%s:%s", instance, channel, signal) + 1;
+    char*  key = calloc(len, sizeof(char));
+    snprintf(key, len, "%s:%s:%s", instance, channel, signal);
+    return key; /* Caller to free. */
+}
+
+
+static ChannelSpec* _build_channel_spec(
+    ModelInstanceSpec* model_instance, const char* channel_name)
+{
+    const char* selectors[] = { "name" };
+    const char* values[] = { channel_name };
+    YamlNode*   c_node = dse_yaml_find_node_in_seq(
+        model_instance->spec, "channels", selectors, values, 1);
+    /* No channel was found with matching name. */
+    if (c_node == NULL) {
+        const char* selectors[] = { "alias" };
+        const char* values[] = { channel_name };
+        c_node = dse_yaml_find_node_in_seq(
+            model_instance->spec, "channels", selectors, values, 1);
+    }
+    /* No channel was found with matching alias. */
+    if (c_node == NULL) {
+        return NULL;
+    }
+
+    ChannelSpec* channel_spec = calloc(1, sizeof(ChannelSpec));
+    channel_spec->name = channel_name;
+    channel_spec->private = c_node;
+    YamlNode* n_node = dse_yaml_find_node(c_node, "name");
+    if (n_node && n_node->scalar) channel_spec->name = n_node->scalar;
+    YamlNode* a_node = dse_yaml_find_node(c_node, "alias");
+    if (a_node && a_node->scalar) channel_spec->alias = a_node->scalar;
+
+    return channel_spec; /* Caller to free. */
+}
+
+
+static int _signal_group_match_handler(
+    ModelInstanceSpec* model_instance, SchemaObject* object)
+{
+    AnnotationSearch* search = object->data;
+    uint32_t          index = 0;
+
+    /* Enumerate over the signals, indexing their annotations. */
+    SchemaSignalObject* so;
+    do {
+        so = schema_object_enumerator(model_instance, object, "spec/signals",
+            &index, schema_signal_object_generator);
+        if (so == NULL) break;
+        YamlNode* a_node = dse_yaml_find_node(so->data, "annotations");
+        if (a_node) {
+            char* key = _key(search->instance, search->channel, so->signal);
+            /* First match is kept. */
+            if (hashmap_get(&search->index->map, key) == NULL) {
+                hashmap_set(&search->index->map, key, a_node);
+            }
+            free(key);
+        }
+        free(so);
+    } while (1);
+
+    return 0;
+}
+
+
+/**
+fmu_annotation_index_create
+===========================
+
+Create an index of Signal annotations for all Model Instances of a
+Simulation. Each channel of each Model Instance is searched once.
+
+Parameters
+----------
+sim (SimulationSpec*)
+: The Simulation Spec containing the Model Instances to index.
+
+Returns
+-------
+FmuAnnotationIndex*
+: The annotation index. Caller to release with `fmu_annotation_index_destroy`.
+*/
+FmuAnnotationIndex* fmu_annotation_index_create(SimulationSpec* sim)
+{
+    FmuAnnotationIndex* index = calloc(1, sizeof(FmuAnnotationIndex));
+    hashmap_init(&index->map);
+    if (sim == NULL) return index;
+
+    for (ModelInstanceSpec* mi = sim->instance_list; mi && mi->name; mi++) {
+        if (mi->model_desc == NULL) continue;
+        for (SignalVector* sv = mi->model_desc->sv; sv && sv->name; sv++) {
+            ChannelSpec* cs = _build_channel_spec(mi, sv->name);
+            if (cs == NULL) continue;
+            SchemaObjectSelector* selector;
+            selector = schema_build_channel_selector(mi, cs, "SignalGroup");
+            if (selector) {
+                AnnotationSearch search = {
+                    .index = index,
+                    .instance = mi->name,
+                    .channel = sv->name,
+                };
+                selector->data = &search;
+                schema_object_search(mi, selector, _signal_group_match_handler);
+            }
+            schema_release_selector(selector);
+            free(cs);
+        }
+    }
+
+    return index;
+}
+
+
+/**
+fmu_annotation_index_get_array
+==============================
+
+Get the value of a Signal annotation, from the index, as an array.
+
+Parameters
+----------
+index (FmuAnnotationIndex*)
+: The annotation index.
+
+sv (SignalVector*)
+: The Signal Vector (channel) containing the signal.
+
+signal (const char*)
+: The name of the signal.
+
+name (const char*)
+: The name of the annotation.
+
+Returns
+-------
+const char**
+: NULL terminated list of annotation values. Caller to free.
+
+NULL
+: The signal or annotation was not found.
+*/
+const char** fmu_annotation_index_get_array(FmuAnnotationIndex* index,
+    SignalVector* sv, const char* signal, const char* name)
+{
+    if (index == NULL || sv == NULL || sv->mi == NULL) return NULL;
+
+    char*     key = _key(sv->mi->name, sv->name, signal);
+    YamlNode* a_node = hashmap_get(&index->map, key);
+    free(key);
+    if (a_node == NULL) return NULL;
+
+    return dse_yaml_get_array(a_node, name, NULL);
+}
+
+
+/**
+fmu_annotation_index_destroy
+============================
+
+Release the annotation index. The indexed annotations (YamlNode objects) are
+owned by the Simulation and are not released.
+
+Parameters
+----------
+index (FmuAnnotationIndex*)
+: The annotation index.
+*/
+void fmu_annotation_index_destroy(FmuAnnotationIndex* index)
+{
+    if (index == NULL) return;
+    hashmap_destroy(&index->map);
+    free(index);
+}
@@ -0,0 +1,39 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_FMU_ANNOTATION_H_
+#define DSE_FMU_ANNOTATION_H_
+
+#include <dse/clib/collections/hashmap.h>
+#include <dse/modelc/runtime.h>
+#include <dse/modelc/model.h>
+
+#ifndef DLL_PRIVATE
+#define DLL_PRIVATE __attribute__((visibility("hidden")))
+#endif
+
+
+/**
+Annotation Index
+================
+
+Index of Signal annotations, keyed by Model Instance, Channel and Signal. The
+index is built with a single pass over the SignalGroups selected by each
+channel of each Model Instance, and replaces per-signal schema searches.
+*/
+typedef struct FmuAnnotationIndex {
+    /* Key: "<instance>:<channel>:<signal>", value: YamlNode* (annotations). */
+    HashMap map;
+} FmuAnnotationIndex;
+
+
+DLL_PRIVATE FmuAnnotationIndex* fmu_annotation_index_create(
+    SimulationSpec* sim);
+DLL_PRIVATE const char** fmu_annotation_index_get_array(
+    FmuAnnotationIndex* index, SignalVector* sv, const char* signal,
+    const char* name);
+DLL_PRIVATE void fmu_annotation_index_destroy(FmuAnnotationIndex* index);
+
+
+#endif  // DSE_FMU_ANNOTATION_H_
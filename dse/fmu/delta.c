@@ -0,0 +1,134 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/fmu/fmu.h>
+
+
+/**
+fmu_delta_setup
+===============
+
+Setup the Changed Outputs (delta query extension) tables of an FMU. With
+Direct Indexing all variables are tracked (the VR is the offset address),
+otherwise the scalar outputs are tracked. The changed tables are initialised
+with all tracked variables, so that the first query reports all of them.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+Returns
+-------
+true
+: The tables were already setup.
+false
+: The tables were setup by this call (first query).
+*/
+bool fmu_delta_setup(FmuInstanceData* fmu)
+{
+    if (fmu->delta.vr) return true;
+
+    if (fmu->direct_index.map) {
+        /* Direct Indexing: all variables, vr == offset address. */
+        fmu->delta.count = fmu->direct_index.size / sizeof(double);
+        fmu->delta.vr = calloc(fmu->delta.count + 1, sizeof(uint32_t));
+        fmu->delta.signal = calloc(fmu->delta.count + 1, sizeof(double*));
+        for (uint32_t i = 0; i < fmu->delta.count; i++) {
+            fmu->delta.vr[i] = i * sizeof(double);
+            fmu->delta.signal[i] =
+                (double*)(fmu->direct_index.map + fmu->delta.vr[i]);
+        }
+    } else {
+        /* Hashmap based indexing: scalar outputs. */
+        HashMap* map = &fmu->variables.scalar.output;
+        char**   keys = hashmap_keys(map);
+        fmu->delta.vr = calloc(map->used_nodes + 1, sizeof(uint32_t));
+        fmu->delta.signal = calloc(map->used_nodes + 1, sizeof(double*));
+        for (uint64_t i = 0; i < map->used_nodes; i++) {
+            double* signal = hashmap_get(map, keys[i]);
+            if (signal) {
+                fmu->delta.vr[fmu->delta.count] = strtoul(keys[i], NULL, 10);
+                fmu->delta.signal[fmu->delta.count] = signal;
+                fmu->delta.count++;
+            }
+            free(keys[i]);
+        }
+        free(keys);
+    }
+    fmu->delta.value = calloc(fmu->delta.count + 1, sizeof(double));
+    fmu->delta.changed_vr = calloc(fmu->delta.count + 1, sizeof(uint32_t));
+    fmu->delta.changed_value = calloc(fmu->delta.count + 1, sizeof(double));
+
+    /* The first query reports all variables. */
+    for (uint32_t i = 0; i < fmu->delta.count; i++) {
+        fmu->delta.value[i] = *fmu->delta.signal[i];
+        fmu->delta.changed_vr[i] = fmu->delta.vr[i];
+        fmu->delta.changed_value[i] = fmu->delta.value[i];
+    }
+    return false;
+}
+
+
+/**
+fmu_delta_query
+===============
+
+Query the variables which changed since the previous query. The VRs and
+values of the changed variables are written to `fmu->delta.changed_vr` and
+`fmu->delta.changed_value`. The first query reports all tracked variables.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+Returns
+-------
+size_t
+: The number of changed variables.
+*/
+size_t fmu_delta_query(FmuInstanceData* fmu)
+{
+    if (fmu_delta_setup(fmu) == false) return fmu->delta.count;
+
+    size_t count = 0;
+    for (uint32_t i = 0; i < fmu->delta.count; i++) {
+        double value = *fmu->delta.signal[i];
+        if (memcmp(&value, &fmu->delta.value[i], sizeof(double)) == 0) continue;
+        fmu->delta.value[i] = value;
+        fmu->delta.changed_vr[count] = fmu->delta.vr[i];
+        fmu->delta.changed_value[count] = value;
+        count++;
+    }
+    return count;
+}
+
+
+/**
+fmu_delta_destroy
+=================
+
+Release the Changed Outputs tables of an FMU. A following query will setup
+the tables again.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+*/
+void fmu_delta_destroy(FmuInstanceData* fmu)
+{
+    free(fmu->delta.vr);
+    free(fmu->delta.signal);
+    free(fmu->delta.value);
+    free(fmu->delta.changed_vr);
+    free(fmu->delta.changed_value);
+    memset(&fmu->delta, 0, sizeof(fmu->delta));
+}
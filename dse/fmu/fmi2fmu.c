@@ -75,6 +75,24 @@ void fmu_log(FmuInstanceData* fmu, const int status, const char* category,
 }
 
 
+/* Early return and intermediate update are not available in FMI 2. */
+bool fmu_request_early_return(FmuInstanceData* fmu, double time)
+{
+    UNUSED(fmu);
+    UNUSED(time);
+    return false;
+}
+
+
+bool fmu_intermediate_update(FmuInstanceData* fmu, double time, bool event)
+{
+    UNUSED(fmu);
+    UNUSED(time);
+    UNUSED(event);
+    return false;
+}
+
+
 static void _log_binary_signal(
     FmuInstanceData* fmu, FmuSignalVectorIndex* idx, const char* op)
 {
@@ -101,6 +119,29 @@ static void _log_binary_signal(
 }
 
 
+static int32_t _step(
+    FmuInstanceData* fmu, double communication_point, double step_size)
+{
+    /* Marshal Signal Vectors to the VarTable. */
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->variable = *mi->signal;
+    }
+
+    /* Step the model. */
+    int32_t rc = fmu_step(fmu, communication_point, step_size);
+    /* Flush (encode) the messages written by the model. */
+    if (fmu->variables.vtable.flush) fmu->variables.vtable.flush(fmu);
+
+    /* Marshal the VarTable to the Signal Vectors. */
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->signal = *mi->variable;
+    }
+    return rc;
+}
+
+
 /**
 fmi2Instantiate
 ===============
@@ -288,7 +329,7 @@ fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[],
 
     /* Hashmap based indexing. */
     for (size_t i = 0; i < nvr; i++) {
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", vr[i]);
         double* signal = NULL;
         signal = hashmap_get(&fmu->variables.scalar.output, vr_idx);
@@ -306,6 +347,53 @@ fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[],
 }
 
 
+/**
+dseGetChangedReal
+=================
+
+Extension (not part of the FMI Standard). Get the scalar output variables
+which changed since the previous call of this function. The first call
+returns all scalar output variables.
+
+Importers can use this function, when exported by an FMU, to retrieve only
+the changed (delta) outputs after each step, rather than calling
+`fmi2GetReal()` for all output variables. With Direct Indexing all variables
+of the bypass map are considered.
+
+Parameters
+----------
+c (fmi2Component*)
+: An FmuInstanceData object representing an instance of this FMU.
+
+vr (const fmi2ValueReference**)
+: Set to the list of changed value references (owned by the FMU, valid until
+  the next call).
+
+value (const fmi2Real**)
+: Set to the list of values of the changed value references (owned by the
+  FMU, valid until the next call).
+
+nvr (size_t*)
+: Set to the number of changed value references.
+
+Returns
+-------
+fmi2OK (fmi2Status)
+: The changed variables are returned.
+*/
+fmi2Status dseGetChangedReal(fmi2Component c, const fmi2ValueReference** vr,
+    const fmi2Real** value, size_t* nvr)
+{
+    assert(c);
+    FmuInstanceData* fmu = (FmuInstanceData*)c;
+
+    *nvr = fmu_delta_query(fmu);
+    *vr = fmu->delta.changed_vr;
+    *value = fmu->delta.changed_value;
+    return fmi2OK;
+}
+
+
 /**
 fmi2GetString
 =============
@@ -345,7 +433,7 @@ fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference vr[],
         value[i] = NULL;
 
         /* Lookup the binary signal, by VRef. */
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", vr[i]);
         FmuSignalVectorIndex* idx =
             hashmap_get(&fmu->variables.binary.tx, vr_idx);
@@ -420,7 +508,7 @@ fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[],
 
     /* Hashmap based indexing. */
     for (size_t i = 0; i < nvr; i++) {
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", vr[i]);
         double* signal = hashmap_get(&fmu->variables.scalar.input, vr_idx);
         if (signal == NULL) continue;
@@ -476,7 +564,7 @@ fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[],
         if (value[i] == NULL) continue;
 
         /* Lookup the binary signal, by VRef. */
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", vr[i]);
         FmuSignalVectorIndex* idx =
             hashmap_get(&fmu->variables.binary.rx, vr_idx);
@@ -495,8 +583,7 @@ fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[],
         }
 
         /* Append the binary string to the Binary Signal. */
-        dse_buffer_append(&idx->sv->binary[idx->vi], &idx->sv->length[idx->vi],
-            &idx->sv->buffer_size[idx->vi], (void*)data, data_len);
+        fmu_sv_binary_append(idx->sv, idx->vi, data, data_len);
         _log_binary_signal(fmu, idx, "SetString");
 
         /* Release the decode string/memory. Caller owns value[]. */
@@ -517,6 +604,10 @@ variables are always appended to the ModelC Binary Signal.
   for instance in a Bus Topology, then each variable will be appended to that
   ModelC Binary Signal.
 
+> Note: When the step is pipelined (`FMU_STEP_PIPELINE`) the model is stepped
+  on a worker thread, and the outputs and status are those of the previous
+  step.
+
 Parameters
 ----------
 c (fmi2Component*)
@@ -550,21 +641,17 @@ fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint,
 
     /* Make sure that all binary signals were reset at some point. */
     if (fmu->variables.vtable.reset) fmu->variables.vtable.reset(fmu);
-    /* Marshal Signal Vectors to the VarTable. */
-    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
-        mi && mi->variable; mi++) {
-        *mi->variable = *mi->signal;
-    }
 
-    /* Step the model. */
-    int32_t rc =
-        fmu_step(fmu, currentCommunicationPoint, communicationStepSize);
-
-    /* Marshal the VarTable to the Signal Vectors. */
-    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
-        mi && mi->variable; mi++) {
-        *mi->signal = *mi->variable;
+    /* Step the model, when pipelined the step runs on a worker thread and the
+       status (and outputs) are those of the previous step. */
+    int32_t rc;
+    if (fmu->variables.vtable.pipeline) {
+        rc = fmu->variables.vtable.pipeline(
+            fmu, _step, currentCommunicationPoint, communicationStepSize);
+    } else {
+        rc = _step(fmu, currentCommunicationPoint, communicationStepSize);
     }
+
     /* Reset the binary signal reset mechanism. */
     fmu->variables.signals_reset = false;
 
@@ -589,6 +676,14 @@ void fmi2FreeInstance(fmi2Component c)
     assert(c);
     FmuInstanceData* fmu = (FmuInstanceData*)c;
 
+    /* Complete a pipelined step (and stop the worker thread). */
+    if (fmu->variables.vtable.pipeline) {
+        if (fmu->variables.vtable.pipeline(fmu, NULL, 0, 0) != 0) {
+            fmu_log(fmu, fmi2Error, "Error",
+                "Pipelined step failed (final step)");
+        }
+    }
+
     if (fmu_destroy(fmu) < fmi2OK) {
         fmu_log(fmu, fmi2Error, "Error", "Could not release model");
     }
@@ -614,6 +709,10 @@ void fmi2FreeInstance(fmi2Component c)
     hashmap_destroy(&fmu->variables.binary.encode_func);
     hashmap_destroy(&fmu->variables.binary.decode_func);
     hashlist_destroy(&fmu->variables.binary.free_list);
+    if (fmu->partition.map.hash_function) {
+        hashmap_destroy(&fmu->partition.map);
+    }
+    fmu_delta_destroy(fmu);
 
     fmu_log(fmu, fmi2OK, "Debug", "Release FMI instance resources");
     free(fmu->instance.name);
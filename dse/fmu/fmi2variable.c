@@ -13,6 +13,15 @@
 
 
 #define FMI2_SCALAR_XPATH "/fmiModelDescription/ModelVariables/ScalarVariable"
+#define FMI2_ANNOTATION_XPATH                                                  \
+    "Annotations/Tool[@name='%s']/Annotation[@name='%s']"
+
+
+extern xmlChar* fmu_variable_annotation(
+    xmlNode* node, const char* xpath, const char* tool, const char* name);
+extern void     fmu_variable_index_binary(FmuInstanceData* fmu,
+        FmuSignalVector* sv, uint32_t sv_idx, xmlChar* vr, xmlChar* causality,
+        const char* encoding, char* mime_type, const char* capacity);
 
 
 static bool __is_scalar_var(xmlNodePtr child)
@@ -31,49 +40,12 @@ static bool __is_binary_var(xmlNodePtr child)
 }
 
 
-static xmlChar* __parse_tool_anno(
-    xmlNode* node, const char* tool, const char* name)
+size_t fmu_variable_count(xmlDoc* doc, FmuSignalType type)
 {
-    xmlChar* result = NULL;
-
-    /* Build the XPath query. */
-    size_t query_len =
-        snprintf(NULL, 0, "Annotations/Tool[@name='%s']/Annotation", tool) + 1;
-    char* query = calloc(query_len, sizeof(char));
-    snprintf(query, query_len, "Annotations/Tool[@name='%s']/Annotation", tool);
-    xmlXPathContext* ctx = xmlXPathNewContext(node->doc);
-    ctx->node = node;
-    xmlXPathObject* obj = xmlXPathEvalExpression((xmlChar*)query, ctx);
-
-    /* Locate the annotation value (if present). */
-    if (obj->type == XPATH_NODESET && obj->nodesetval) {
-        /* Annotation. */
-        for (int i = 0; i < obj->nodesetval->nodeNr; i++) {
-            xmlNode* a_node = obj->nodesetval->nodeTab[i];
-            xmlChar* a_name = xmlGetProp(a_node, (xmlChar*)"name");
-            xmlChar* a_value =
-                xmlNodeListGetString(a_node->doc, a_node->xmlChildrenNode, 1);
-            if (strcmp((char*)a_name, name) == 0) {
-                result = a_value;
-                xmlFree(a_name);
-                break;
-            } else {
-                xmlFree(a_name);
-                xmlFree(a_value);
-            }
-        }
-    }
-
-    /* Cleanup and return the result. */
-    free(query);
-    xmlXPathFreeObject(obj);
-    xmlXPathFreeContext(ctx);
-    return result;
-}
-
+    /* FMI 2 Integer and Boolean variables are stored as scalar (double). */
+    if (type != FmuSignalScalar && type != FmuSignalBinary) return 0;
+    bool is_binary = (type == FmuSignalBinary);
 
-size_t fmu_variable_count(xmlDoc* doc, bool is_binary)
-{
     size_t           count = 0;
     xmlXPathContext* ctx = xmlXPathNewContext(doc);
     xmlXPathObject*  obj =
@@ -120,15 +92,6 @@ static void __index_scalar_variable(FmuInstanceData* fmu, FmuSignalVector* sv,
 static void __index_binary_variable(FmuInstanceData* fmu, FmuSignalVector* sv,
     uint32_t sv_idx, xmlNode* node, xmlChar* vr, xmlChar* causality)
 {
-    FmuSignalVectorIndex* idx = calloc(1, sizeof(FmuSignalVectorIndex));
-    idx->sv = sv;
-    idx->vi = sv_idx;
-    if (xmlStrcmp(causality, (xmlChar*)"output") == 0) {
-        hashmap_set_alt(&(fmu->variables.binary.tx), (char*)vr, idx);
-    } else if (xmlStrcmp(causality, (xmlChar*)"input") == 0) {
-        hashmap_set_alt(&(fmu->variables.binary.rx), (char*)vr, idx);
-    }
-
     /*
     fmi-ls-binary-to-text
     ---------------------
@@ -137,17 +100,8 @@ static void __index_binary_variable(FmuInstanceData* fmu, FmuSignalVector* sv,
     Annotation value:
         * ascii85
     */
-    xmlChar* encoding = __parse_tool_anno(
-        node, "dse.standards.fmi-ls-binary-to-text", "encoding");
-    if (encoding) {
-        if (strcmp((char*)encoding, "ascii85") == 0) {
-            hashmap_set(&fmu->variables.binary.encode_func, (char*)vr,
-                dse_ascii85_encode);
-            hashmap_set(&fmu->variables.binary.decode_func, (char*)vr,
-                dse_ascii85_decode);
-        }
-        xmlFree(encoding);
-    }
+    xmlChar* encoding = fmu_variable_annotation(node, FMI2_ANNOTATION_XPATH,
+        "dse.standards.fmi-ls-binary-to-text", "encoding");
 
     /*
     fmi-ls-binary-codec
@@ -156,16 +110,32 @@ static void __index_binary_variable(FmuInstanceData* fmu, FmuSignalVector* sv,
     Annotation name: mimetype
     Annotation value: <mimetype string>
     */
-    sv->mime_type[sv_idx] = (char*)__parse_tool_anno(
-        node, "dse.standards.fmi-ls-binary-codec", "mimetype");
+    xmlChar* mime_type = fmu_variable_annotation(node, FMI2_ANNOTATION_XPATH,
+        "dse.standards.fmi-ls-binary-codec", "mimetype");
 
-    sv->ncodec[sv_idx] = fmu_ncodec_open(fmu, sv->mime_type[sv_idx], idx);
+    /*
+    Binary Buffer
+    -------------
+    Tool name: dse.fmi.binary-buffer
+    Annotation name: capacity
+    Annotation value: <bytes> (initial capacity of the buffer)
+    */
+    xmlChar* capacity = fmu_variable_annotation(
+        node, FMI2_ANNOTATION_XPATH, "dse.fmi.binary-buffer", "capacity");
+
+    fmu_variable_index_binary(fmu, sv, sv_idx, vr, causality, (char*)encoding,
+        (char*)mime_type, (char*)capacity);
+    xmlFree(encoding);
+    xmlFree(capacity);
 }
 
 
 void fmu_variable_index(
-    xmlDoc* doc, FmuInstanceData* fmu, FmuSignalVector* sv, bool is_binary)
+    xmlDoc* doc, FmuInstanceData* fmu, FmuSignalVector* sv, FmuSignalType type)
 {
+    if (type != FmuSignalScalar && type != FmuSignalBinary) return;
+    bool is_binary = (type == FmuSignalBinary);
+
     xmlXPathContext* ctx = xmlXPathNewContext(doc);
     xmlXPathObject*  obj =
         xmlXPathEvalExpression((xmlChar*)FMI2_SCALAR_XPATH, ctx);
@@ -4,6 +4,7 @@
 
 #include <errno.h>
 #include <assert.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -56,6 +57,42 @@ void fmu_log(FmuInstanceData* fmu, const int status, const char* category,
 }
 
 
+bool fmu_request_early_return(FmuInstanceData* fmu, double time)
+{
+    if (fmu->early_return.allowed == false) return false;
+    if (time >= fmu->early_return.step_end) return false;
+    if (time < fmu->early_return.step_begin) {
+        time = fmu->early_return.step_begin;
+    }
+
+    /* Keep the earliest requested time. */
+    if (fmu->early_return.requested == false || time < fmu->early_return.time) {
+        fmu->early_return.time = time;
+    }
+    fmu->early_return.requested = true;
+    return true;
+}
+
+
+bool fmu_intermediate_update(FmuInstanceData* fmu, double time, bool event)
+{
+    fmi3IntermediateUpdateCallback cb = fmu->early_return.intermediate_update;
+    if (cb == NULL) return false;
+    /* Only with early return allowed, and from the importer thread (a
+       pipelined step runs on a worker thread). */
+    if (fmu->early_return.allowed == false) return false;
+    if (fmu->variables.vtable.pipeline) return false;
+
+    fmi3Boolean early_return_requested = fmi3False;
+    fmi3Float64 early_return_time = fmu->early_return.step_end;
+    cb(fmu->instance.environment, time, fmi3False, fmi3True, event,
+        fmu->early_return.allowed, &early_return_requested, &early_return_time);
+    if (early_return_requested == fmi3False) return false;
+
+    return fmu_request_early_return(fmu, early_return_time);
+}
+
+
 static void _log_binary_signal(
     FmuInstanceData* fmu, FmuSignalVectorIndex* idx, const char* op)
 {
@@ -81,6 +118,269 @@ static void _log_binary_signal(
     }
 }
 
+
+/* Typed variables (Int8 ... UInt64, Boolean, Float32). */
+
+static double _typed_to_double(FmuSignalType type, const void* value)
+{
+    switch (type) {
+    case FmuSignalFloat32:
+        return *(const fmi3Float32*)value;
+    case FmuSignalInt8:
+        return *(const fmi3Int8*)value;
+    case FmuSignalUInt8:
+        return *(const fmi3UInt8*)value;
+    case FmuSignalInt16:
+        return *(const fmi3Int16*)value;
+    case FmuSignalUInt16:
+        return *(const fmi3UInt16*)value;
+    case FmuSignalInt32:
+        return *(const fmi3Int32*)value;
+    case FmuSignalUInt32:
+        return *(const fmi3UInt32*)value;
+    case FmuSignalInt64:
+        return *(const fmi3Int64*)value;
+    case FmuSignalUInt64:
+        return *(const fmi3UInt64*)value;
+    case FmuSignalBoolean:
+        return *(const fmi3Boolean*)value ? 1.0 : 0.0;
+    default:
+        return 0.0;
+    }
+}
+
+
+static double _clamp(double scalar, double min, double max)
+{
+    if (isnan(scalar)) return 0.0;
+    if (scalar < min) return min;
+    if (scalar > max) return max;
+    return scalar;
+}
+
+
+static void _typed_from_double(FmuSignalType type, double scalar, void* value)
+{
+    /* Out of range conversions to integer types are undefined, clamp to the
+       range of the target type first (NaN is converted to 0). The maximum of
+       the 64 bit types is not representable as a double (rounds up). */
+    switch (type) {
+    case FmuSignalFloat32:
+        *(fmi3Float32*)value = scalar;
+        break;
+    case FmuSignalInt8:
+        *(fmi3Int8*)value = _clamp(scalar, INT8_MIN, INT8_MAX);
+        break;
+    case FmuSignalUInt8:
+        *(fmi3UInt8*)value = _clamp(scalar, 0, UINT8_MAX);
+        break;
+    case FmuSignalInt16:
+        *(fmi3Int16*)value = _clamp(scalar, INT16_MIN, INT16_MAX);
+        break;
+    case FmuSignalUInt16:
+        *(fmi3UInt16*)value = _clamp(scalar, 0, UINT16_MAX);
+        break;
+    case FmuSignalInt32:
+        *(fmi3Int32*)value = _clamp(scalar, INT32_MIN, INT32_MAX);
+        break;
+    case FmuSignalUInt32:
+        *(fmi3UInt32*)value = _clamp(scalar, 0, UINT32_MAX);
+        break;
+    case FmuSignalInt64:
+        scalar = _clamp(scalar, (double)INT64_MIN, (double)INT64_MAX);
+        *(fmi3Int64*)value =
+            (scalar >= (double)INT64_MAX) ? INT64_MAX : (fmi3Int64)scalar;
+        break;
+    case FmuSignalUInt64:
+        scalar = _clamp(scalar, 0, (double)UINT64_MAX);
+        *(fmi3UInt64*)value =
+            (scalar >= (double)UINT64_MAX) ? UINT64_MAX : (fmi3UInt64)scalar;
+        break;
+    case FmuSignalBoolean:
+        *(fmi3Boolean*)value = (scalar != 0.0);
+        break;
+    default:
+        break;
+    }
+}
+
+
+static fmi3Status _get_typed(FmuInstanceData* fmu, FmuSignalType type,
+    const fmi3ValueReference valueReferences[], size_t nValueReferences,
+    void* values)
+{
+    fmi3Status rc = fmi3OK;
+    size_t     size = fmu_signal_type_size(type);
+
+    for (size_t i = 0; i < nValueReferences; i++) {
+        char vr_idx[VREF_KEY_LEN];
+        snprintf(vr_idx, VREF_KEY_LEN, "%i", valueReferences[i]);
+        void* value = (uint8_t*)values + i * size;
+
+        /* Typed storage, get operations can also be used on inputs. */
+        FmuSignalVectorIndex* idx =
+            hashmap_get(&fmu->variables.typed.output, vr_idx);
+        if (idx == NULL) idx = hashmap_get(&fmu->variables.typed.input, vr_idx);
+        if (idx) {
+            if (idx->sv->type != type) {
+                fmu_log(fmu, fmi3Error, "Error",
+                    "Variable type mismatch (vr=%s)", vr_idx);
+                rc = fmi3Error;
+                continue;
+            }
+            memcpy(value, (uint8_t*)idx->sv->typed + idx->vi * size, size);
+            continue;
+        }
+
+        /* Scalar storage (i.e. ModelC signals), convert from double. */
+        double* signal = hashmap_get(&fmu->variables.scalar.output, vr_idx);
+        if (signal == NULL) {
+            signal = hashmap_get(&fmu->variables.scalar.input, vr_idx);
+            if (signal == NULL) continue;
+        }
+        _typed_from_double(type, *signal, value);
+    }
+
+    return rc;
+}
+
+
+static fmi3Status _set_typed(FmuInstanceData* fmu, FmuSignalType type,
+    const fmi3ValueReference valueReferences[], size_t nValueReferences,
+    const void* values)
+{
+    fmi3Status rc = fmi3OK;
+    size_t     size = fmu_signal_type_size(type);
+
+    for (size_t i = 0; i < nValueReferences; i++) {
+        char vr_idx[VREF_KEY_LEN];
+        snprintf(vr_idx, VREF_KEY_LEN, "%i", valueReferences[i]);
+        const void* value = (const uint8_t*)values + i * size;
+
+        /* Typed storage. */
+        FmuSignalVectorIndex* idx =
+            hashmap_get(&fmu->variables.typed.input, vr_idx);
+        if (idx) {
+            if (idx->sv->type != type) {
+                fmu_log(fmu, fmi3Error, "Error",
+                    "Variable type mismatch (vr=%s)", vr_idx);
+                rc = fmi3Error;
+                continue;
+            }
+            memcpy((uint8_t*)idx->sv->typed + idx->vi * size, value, size);
+            continue;
+        }
+
+        /* Scalar storage (i.e. ModelC signals), convert to double. */
+        double* signal = hashmap_get(&fmu->variables.scalar.input, vr_idx);
+        if (signal == NULL) continue;
+        *signal = _typed_to_double(type, value);
+    }
+
+    return rc;
+}
+
+
+static FmuModelPartition* _lookup_partition(
+    FmuInstanceData* fmu, uint32_t clock_vref)
+{
+    if (fmu->partition.map.hash_function == NULL) return NULL;
+
+    char vr_idx[VREF_KEY_LEN];
+    snprintf(vr_idx, VREF_KEY_LEN, "%i", clock_vref);
+    return hashmap_get(&fmu->partition.map, vr_idx);
+}
+
+
+static void _marshal_in(FmuInstanceData* fmu)
+{
+    /* Make sure that all binary signals were reset at some point. */
+    if (fmu->variables.vtable.reset) fmu->variables.vtable.reset(fmu);
+    /* Marshal Signal Vectors to the VarTable. */
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->variable = *mi->signal;
+    }
+}
+
+
+static void _marshal_out(FmuInstanceData* fmu)
+{
+    /* Flush (encode) the messages written by the model. */
+    if (fmu->variables.vtable.flush) fmu->variables.vtable.flush(fmu);
+    /* Marshal the VarTable to the Signal Vectors. */
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->signal = *mi->variable;
+    }
+    /* Reset the binary signal reset mechanism. */
+    fmu->variables.signals_reset = false;
+}
+
+
+/* Variable Table of a preempted partition (FMI 3 Scheduled Execution). */
+typedef struct FmuPartitionSave {
+    size_t  count;
+    double* value; /* Variable Table of the preempted partition. */
+    double* in;    /* Variable Table as marshalled in for the preemption. */
+} FmuPartitionSave;
+
+
+static void _partition_save(FmuInstanceData* fmu, FmuPartitionSave* save)
+{
+    save->count = 0;
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        save->count++;
+    }
+    save->value = calloc(save->count * 2 + 1, sizeof(double));
+    save->in = save->value + save->count;
+    for (size_t i = 0; i < save->count; i++) {
+        FmuVarTableMarshalItem* mi = &fmu->var_table.marshal_list[i];
+        save->value[i] = *mi->variable;
+        save->in[i] = *mi->signal;
+    }
+}
+
+
+static void _partition_restore(FmuInstanceData* fmu, FmuPartitionSave* save)
+{
+    /* Restore the variables of the preempted partition, variables written by
+       the preempting partition are retained. */
+    for (size_t i = 0; i < save->count; i++) {
+        FmuVarTableMarshalItem* mi = &fmu->var_table.marshal_list[i];
+        if (*mi->variable == save->in[i]) *mi->variable = save->value[i];
+    }
+    free(save->value);
+    *save = (FmuPartitionSave){ 0 };
+}
+
+
+static int32_t _step(
+    FmuInstanceData* fmu, double communication_point, double step_size)
+{
+    /* Marshal Signal Vectors to the VarTable. */
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->variable = *mi->signal;
+    }
+
+    /* Step the model, fmu_step() may request an early return. */
+    fmu->early_return.step_begin = communication_point;
+    fmu->early_return.step_end = communication_point + step_size;
+    fmu->early_return.requested = false;
+    int32_t rc = fmu_step(fmu, communication_point, step_size);
+
+    /* Flush (encode) the messages written by the model. */
+    if (fmu->variables.vtable.flush) fmu->variables.vtable.flush(fmu);
+    /* Marshal the VarTable to the Signal Vectors. */
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->signal = *mi->variable;
+    }
+    return rc;
+}
+
 /* Inquire version numbers and setting logging status */
 
 const char* fmi3GetVersion()
@@ -117,23 +417,11 @@ fmi3Instance fmi3InstantiateModelExchange(fmi3String instanceName,
     return NULL;
 }
 
-fmi3Instance fmi3InstantiateCoSimulation(fmi3String instanceName,
-    fmi3String instantiationToken, fmi3String resourcePath, fmi3Boolean visible,
-    fmi3Boolean loggingOn, fmi3Boolean eventModeUsed,
-    fmi3Boolean                    earlyReturnAllowed,
-    const fmi3ValueReference       requiredIntermediateVariables[],
-    size_t                         nRequiredIntermediateVariables,
-    fmi3InstanceEnvironment        instanceEnvironment,
-    fmi3LogMessageCallback         logMessage,
-    fmi3IntermediateUpdateCallback intermediateUpdate)
+static FmuInstanceData* _instantiate(fmi3String instanceName,
+    fmi3String instantiationToken, fmi3String resourcePath,
+    fmi3Boolean loggingOn, fmi3InstanceEnvironment instanceEnvironment,
+    fmi3LogMessageCallback logMessage)
 {
-    UNUSED(visible);
-    UNUSED(eventModeUsed);
-    UNUSED(earlyReturnAllowed);
-    UNUSED(requiredIntermediateVariables);
-    UNUSED(nRequiredIntermediateVariables);
-    UNUSED(intermediateUpdate);
-
     /* Create the FMU Model Instance Data. */
     FmuInstanceData* fmu = calloc(1, sizeof(FmuInstanceData));
     fmu->instance.name = strdup(instanceName);
@@ -175,6 +463,8 @@ fmi3Instance fmi3InstantiateCoSimulation(fmi3String instanceName,
     hashmap_init(&fmu->variables.scalar.output);
     hashmap_init(&fmu->variables.string.input);
     hashmap_init(&fmu->variables.string.output);
+    hashmap_init(&fmu->variables.typed.input);
+    hashmap_init(&fmu->variables.typed.output);
     hashmap_init(&fmu->variables.binary.rx);
     hashmap_init(&fmu->variables.binary.tx);
     hashmap_init(&fmu->variables.binary.encode_func);
@@ -204,6 +494,29 @@ fmi3Instance fmi3InstantiateCoSimulation(fmi3String instanceName,
         fmu_log(fmu, fmi3OK, "Debug", "FMU Var Table is not configured");
     }
 
+    return fmu;
+}
+
+fmi3Instance fmi3InstantiateCoSimulation(fmi3String instanceName,
+    fmi3String instantiationToken, fmi3String resourcePath, fmi3Boolean visible,
+    fmi3Boolean loggingOn, fmi3Boolean eventModeUsed,
+    fmi3Boolean                    earlyReturnAllowed,
+    const fmi3ValueReference       requiredIntermediateVariables[],
+    size_t                         nRequiredIntermediateVariables,
+    fmi3InstanceEnvironment        instanceEnvironment,
+    fmi3LogMessageCallback         logMessage,
+    fmi3IntermediateUpdateCallback intermediateUpdate)
+{
+    UNUSED(visible);
+    UNUSED(eventModeUsed);
+    UNUSED(requiredIntermediateVariables);
+    UNUSED(nRequiredIntermediateVariables);
+
+    FmuInstanceData* fmu = _instantiate(instanceName, instantiationToken,
+        resourcePath, loggingOn, instanceEnvironment, logMessage);
+    fmu->early_return.allowed = earlyReturnAllowed;
+    fmu->early_return.intermediate_update = intermediateUpdate;
+
     /* Return the created instance object. */
     return (fmi3Instance)fmu;
 }
@@ -215,18 +528,20 @@ fmi3Instance fmi3InstantiateScheduledExecution(fmi3String instanceName,
     fmi3LockPreemptionCallback   lockPreemption,
     fmi3UnlockPreemptionCallback unlockPreemption)
 {
-    UNUSED(instanceName);
-    UNUSED(instantiationToken);
-    UNUSED(resourcePath);
     UNUSED(visible);
-    UNUSED(loggingOn);
-    UNUSED(instanceEnvironment);
-    UNUSED(logMessage);
-    UNUSED(clockUpdate);
-    UNUSED(lockPreemption);
-    UNUSED(unlockPreemption);
 
-    return NULL;
+    FmuInstanceData* fmu = _instantiate(instanceName, instantiationToken,
+        resourcePath, loggingOn, instanceEnvironment, logMessage);
+    fmu->partition.clock_update = clockUpdate;
+    fmu->partition.lock_preemption = lockPreemption;
+    fmu->partition.unlock_preemption = unlockPreemption;
+    if (fmu->partition.map.hash_function == NULL) {
+        fmu_log(fmu, fmi3Warning, "Warning",
+            "No model partitions registered (Scheduled Execution)");
+    }
+
+    /* Return the created instance object. */
+    return (fmi3Instance)fmu;
 }
 
 void fmi3FreeInstance(fmi3Instance instance)
@@ -234,6 +549,14 @@ void fmi3FreeInstance(fmi3Instance instance)
     assert(instance);
     FmuInstanceData* fmu = (FmuInstanceData*)instance;
 
+    /* Complete a pipelined step (and stop the worker thread). */
+    if (fmu->variables.vtable.pipeline) {
+        if (fmu->variables.vtable.pipeline(fmu, NULL, 0, 0) != 0) {
+            fmu_log(fmu, fmi3Error, "Error",
+                "Pipelined step failed (final step)");
+        }
+    }
+
     if (fmu_destroy(fmu) < fmi3OK) {
         fmu_log(fmu, fmi3Error, "Error",
             "Error while releasing the allocated specialised model.");
@@ -253,11 +576,17 @@ void fmi3FreeInstance(fmi3Instance instance)
     hashmap_destroy(&fmu->variables.scalar.output);
     hashmap_destroy(&fmu->variables.string.input);
     hashmap_destroy(&fmu->variables.string.output);
+    hashmap_destroy(&fmu->variables.typed.input);
+    hashmap_destroy(&fmu->variables.typed.output);
     hashmap_destroy(&fmu->variables.binary.rx);
     hashmap_destroy(&fmu->variables.binary.tx);
     hashmap_destroy(&fmu->variables.binary.encode_func);
     hashmap_destroy(&fmu->variables.binary.decode_func);
     hashlist_destroy(&fmu->variables.binary.free_list);
+    if (fmu->partition.map.hash_function) {
+        hashmap_destroy(&fmu->partition.map);
+    }
+    fmu_delta_destroy(fmu);
 
     fmu_log(fmu, fmi3OK, "Debug", "Release FMI instance resources");
     free(fmu->instance.name);
@@ -326,13 +655,11 @@ fmi3Status fmi3GetFloat32(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3Float32 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalFloat32,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetFloat64(fmi3Instance instance,
@@ -357,7 +684,7 @@ fmi3Status fmi3GetFloat64(fmi3Instance instance,
 
     /* Hashmap based indexing. */
     for (size_t i = 0; i < nValueReferences; i++) {
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", valueReferences[i]);
         double* signal = hashmap_get(&fmu->variables.scalar.output, vr_idx);
         /* Get operations can also be used on input variables. */
@@ -374,121 +701,152 @@ fmi3Status fmi3GetFloat64(fmi3Instance instance,
     return fmi3OK;
 }
 
+
+/**
+dseGetChangedFloat64
+====================
+
+Extension (not part of the FMI Standard). Get the Float64 output variables
+which changed since the previous call of this function. The first call
+returns all Float64 output variables.
+
+Importers can use this function, when exported by an FMU, to retrieve only
+the changed (delta) outputs after each step, rather than calling
+`fmi3GetFloat64()` for all output variables. With Direct Indexing all
+variables of the bypass map are considered.
+
+Parameters
+----------
+instance (fmi3Instance)
+: An FmuInstanceData object representing an instance of this FMU.
+
+valueReferences (const fmi3ValueReference**)
+: Set to the list of changed value references (owned by the FMU, valid until
+  the next call).
+
+values (const fmi3Float64**)
+: Set to the list of values of the changed value references (owned by the
+  FMU, valid until the next call).
+
+nValueReferences (size_t*)
+: Set to the number of changed value references.
+
+Returns
+-------
+fmi3OK (fmi3Status)
+: The changed variables are returned.
+*/
+fmi3Status dseGetChangedFloat64(fmi3Instance instance,
+    const fmi3ValueReference** valueReferences, const fmi3Float64** values,
+    size_t* nValueReferences)
+{
+    assert(instance);
+    FmuInstanceData* fmu = (FmuInstanceData*)instance;
+
+    *nValueReferences = fmu_delta_query(fmu);
+    *valueReferences = fmu->delta.changed_vr;
+    *values = fmu->delta.changed_value;
+    return fmi3OK;
+}
+
+
 fmi3Status fmi3GetInt8(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3Int8 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalInt8,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetUInt8(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3UInt8 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalUInt8,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetInt16(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3Int16 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalInt16,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetUInt16(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3UInt16 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalUInt16,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetInt32(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3Int32 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalInt32,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetUInt32(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3UInt32 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalUInt32,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetInt64(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3Int64 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalInt64,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetUInt64(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3UInt64 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalUInt64,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetBoolean(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     fmi3Boolean values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _get_typed((FmuInstanceData*)instance, FmuSignalBoolean,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3GetString(fmi3Instance instance,
@@ -520,7 +878,7 @@ fmi3Status fmi3GetBinary(fmi3Instance instance,
         values[i] = NULL;
 
         /* Lookup the binary signal, by VRef. */
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", valueReferences[i]);
         FmuSignalVectorIndex* idx =
             hashmap_get(&fmu->variables.binary.tx, vr_idx);
@@ -557,9 +915,14 @@ fmi3Status fmi3GetClock(fmi3Instance instance,
     fmi3Clock values[])
 {
     assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
+    FmuInstanceData* fmu = (FmuInstanceData*)instance;
+
+    for (size_t i = 0; i < nValueReferences; i++) {
+        FmuModelPartition* p = _lookup_partition(fmu, valueReferences[i]);
+        values[i] = p ? p->active : fmi3ClockInactive;
+        /* Clocks are reset by the get operation. */
+        if (p) p->active = false;
+    }
 
     return fmi3OK;
 }
@@ -568,13 +931,11 @@ fmi3Status fmi3SetFloat32(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3Float32 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalFloat32,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetFloat64(fmi3Instance instance,
@@ -599,7 +960,7 @@ fmi3Status fmi3SetFloat64(fmi3Instance instance,
 
     /* Hashmap based indexing. */
     for (size_t i = 0; i < nValueReferences; i++) {
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", valueReferences[i]);
         double* signal = hashmap_get(&fmu->variables.scalar.input, vr_idx);
         if (signal == NULL) continue;
@@ -610,119 +971,104 @@ fmi3Status fmi3SetFloat64(fmi3Instance instance,
 
     return fmi3OK;
 }
+
 fmi3Status fmi3SetInt8(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3Int8 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalInt8,
+        valueReferences, nValueReferences, values);
 }
+
 fmi3Status fmi3SetUInt8(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3UInt8 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalUInt8,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetInt16(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3Int16 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalInt16,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetUInt16(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3UInt16 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalUInt16,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetInt32(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3Int32 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalInt32,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetUInt32(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3UInt32 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalUInt32,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetInt64(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3Int64 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalInt64,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetUInt64(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3UInt64 values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalUInt64,
+        valueReferences, nValueReferences, values);
 }
+
 fmi3Status fmi3SetBoolean(fmi3Instance instance,
     const fmi3ValueReference valueReferences[], size_t nValueReferences,
     const fmi3Boolean values[], size_t nValues)
 {
-    assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
     UNUSED(nValues);
+    assert(instance);
 
-    return fmi3OK;
+    return _set_typed((FmuInstanceData*)instance, FmuSignalBoolean,
+        valueReferences, nValueReferences, values);
 }
 
 fmi3Status fmi3SetString(fmi3Instance instance,
@@ -738,7 +1084,7 @@ fmi3Status fmi3SetString(fmi3Instance instance,
         if (values[i] == NULL) continue;
 
         /* Lookup the binary signal, by VRef. */
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", valueReferences[i]);
         hashmap_set_string(&fmu->variables.string.input,  // NOLINT
             vr_idx, (char*)values[i]);
@@ -762,7 +1108,7 @@ fmi3Status fmi3SetBinary(fmi3Instance instance,
         if (values[i] == NULL) continue;
 
         /* Lookup the binary signal, by VRef. */
-        static char vr_idx[VREF_KEY_LEN];
+        char vr_idx[VREF_KEY_LEN];
         snprintf(vr_idx, VREF_KEY_LEN, "%i", valueReferences[i]);
         FmuSignalVectorIndex* idx =
             hashmap_get(&fmu->variables.binary.rx, vr_idx);
@@ -776,8 +1122,7 @@ fmi3Status fmi3SetBinary(fmi3Instance instance,
         }
 
         /* Append the binary string to the Binary Signal. */
-        dse_buffer_append(&idx->sv->binary[idx->vi], &idx->sv->length[idx->vi],
-            &idx->sv->buffer_size[idx->vi], (void*)data, valueSizes[i]);
+        fmu_sv_binary_append(idx->sv, idx->vi, data, valueSizes[i]);
 
         /* Release the decode string/memory. Caller owns value[]. */
         if (data != values[i]) free((uint8_t*)data);
@@ -792,9 +1137,12 @@ fmi3Status fmi3SetClock(fmi3Instance instance,
     const fmi3Clock values[])
 {
     assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(values);
+    FmuInstanceData* fmu = (FmuInstanceData*)instance;
+
+    for (size_t i = 0; i < nValueReferences; i++) {
+        FmuModelPartition* p = _lookup_partition(fmu, valueReferences[i]);
+        if (p) p->active = values[i];
+    }
 
     return fmi3OK;
 }
@@ -944,10 +1292,20 @@ fmi3Status fmi3GetIntervalDecimal(fmi3Instance instance,
     fmi3Float64 intervals[], fmi3IntervalQualifier qualifiers[])
 {
     assert(instance);
-    UNUSED(valueReferences);
-    UNUSED(nValueReferences);
-    UNUSED(intervals);
-    UNUSED(qualifiers);
+    FmuInstanceData* fmu = (FmuInstanceData*)instance;
+
+    for (size_t i = 0; i < nValueReferences; i++) {
+        FmuModelPartition* p = _lookup_partition(fmu, valueReferences[i]);
+        if (p == NULL || p->interval <= 0.0) {
+            intervals[i] = 0.0;
+            qualifiers[i] = fmi3IntervalNotYetKnown;
+            continue;
+        }
+        intervals[i] = p->interval;
+        qualifiers[i] =
+            p->interval_reported ? fmi3IntervalUnchanged : fmi3IntervalChanged;
+        p->interval_reported = true;
+    }
 
     return fmi3OK;
 }
@@ -1195,10 +1553,6 @@ fmi3Status fmi3DoStep(fmi3Instance instance,
     fmi3Boolean* earlyReturn, fmi3Float64* lastSuccessfulTime)
 {
     UNUSED(noSetFMUStatePriorToCurrentPoint);
-    UNUSED(eventHandlingNeeded);
-    UNUSED(terminateSimulation);
-    UNUSED(earlyReturn);
-    UNUSED(lastSuccessfulTime);
 
     assert(instance);
     FmuInstanceData* fmu = (FmuInstanceData*)instance;
@@ -1206,24 +1560,32 @@ fmi3Status fmi3DoStep(fmi3Instance instance,
 
     /* Make sure that all binary signals were reset at some point. */
     if (fmu->variables.vtable.reset) fmu->variables.vtable.reset(fmu);
-    /* Marshal Signal Vectors to the VarTable. */
-    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
-        mi && mi->variable; mi++) {
-        *mi->variable = *mi->signal;
-    }
-
-    /* Step the model. */
-    int32_t rc =
-        fmu_step(fmu, currentCommunicationPoint, communicationStepSize);
 
-    /* Marshal the VarTable to the Signal Vectors. */
-    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
-        mi && mi->variable; mi++) {
-        *mi->signal = *mi->variable;
+    /* Step the model, when pipelined the step runs on a worker thread and the
+       status (and outputs) are those of the previous step. */
+    int32_t rc;
+    bool    early_return = false;
+    if (fmu->variables.vtable.pipeline) {
+        rc = fmu->variables.vtable.pipeline(
+            fmu, _step, currentCommunicationPoint, communicationStepSize);
+    } else {
+        rc = _step(fmu, currentCommunicationPoint, communicationStepSize);
+        early_return = fmu->early_return.requested;
     }
+
     /* Reset the binary signal reset mechanism. */
     fmu->variables.signals_reset = false;
 
+    /* Step outcome. */
+    if (eventHandlingNeeded) *eventHandlingNeeded = fmi3False;
+    if (terminateSimulation) *terminateSimulation = fmi3False;
+    if (earlyReturn) *earlyReturn = early_return;
+    if (lastSuccessfulTime) {
+        *lastSuccessfulTime =
+            early_return ? fmu->early_return.time
+                         : currentCommunicationPoint + communicationStepSize;
+    }
+
     /* return final status. */
     return (rc == 0 ? fmi3OK : fmi3Error);
 }
@@ -1232,8 +1594,45 @@ fmi3Status fmi3ActivateModelPartition(fmi3Instance instance,
     fmi3ValueReference clockReference, fmi3Float64 activationTime)
 {
     assert(instance);
-    UNUSED(clockReference);
-    UNUSED(activationTime);
+    FmuInstanceData* fmu = (FmuInstanceData*)instance;
 
-    return fmi3OK;
+    FmuModelPartition* p = _lookup_partition(fmu, clockReference);
+    if (p == NULL || p->func == NULL) {
+        fmu_log(fmu, fmi3Error, "Error",
+            "No model partition for clock (vr=%u)", clockReference);
+        return fmi3Error;
+    }
+
+    /* Partitions share the Variable Table (marshalling is not limited to the
+       variables of a partition). A partition activated while another is
+       running (i.e. by preemption) saves the Variable Table of the preempted
+       partition, which is restored before the preempted partition resumes.
+       Shared state is only accessed with preemption locked. */
+    fmi3LockPreemptionCallback   lock = fmu->partition.lock_preemption;
+    fmi3UnlockPreemptionCallback unlock = fmu->partition.unlock_preemption;
+    FmuPartitionSave             save = { 0 };
+    if (lock) lock();
+    FmuModelPartition* preempted = fmu->partition.running;
+    if (preempted == p) {
+        if (unlock) unlock();
+        fmu_log(fmu, fmi3Error, "Error", "Model partition (vr=%u) is active",
+            clockReference);
+        return fmi3Error;
+    }
+    if (preempted) _partition_save(fmu, &save);
+    fmu->partition.running = p;
+    _marshal_in(fmu);
+    if (unlock) unlock();
+
+    /* Run the partition. */
+    int32_t rc = p->func(fmu, activationTime);
+    p->activations += 1;
+
+    if (lock) lock();
+    _marshal_out(fmu);
+    if (preempted) _partition_restore(fmu, &save);
+    fmu->partition.running = preempted;
+    if (unlock) unlock();
+
+    return (rc == 0 ? fmi3OK : fmi3Error);
 }
@@ -4,27 +4,183 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <libxml/xpath.h>
 #include <dse/clib/collections/hashlist.h>
+#include <dse/ncodec/codec.h>
 #include <dse/fmu/fmu.h>
 
 
-#define UNUSED(x) ((void)x)
+#define ARRAY_SIZE(x)         (sizeof(x) / sizeof(x[0]))
+#define FMI3_VARIABLE_XPATH   "/fmiModelDescription/ModelVariables/*"
+#define FMI3_ANNOTATION_XPATH "Annotations/Annotation[@type='%s']/%s"
 
 
-size_t fmu_variable_count(xmlDoc* doc, bool is_binary)
+extern xmlChar* fmu_variable_annotation(
+    xmlNode* node, const char* xpath, const char* tool, const char* name);
+extern void     fmu_variable_index_binary(FmuInstanceData* fmu,
+        FmuSignalVector* sv, uint32_t sv_idx, xmlChar* vr, xmlChar* causality,
+        const char* encoding, char* mime_type, const char* capacity);
+
+
+static const struct {
+    const char*   name;
+    FmuSignalType type;
+} __variable_type_map[] = {
+    { "Float64", FmuSignalScalar },
+    { "Binary", FmuSignalBinary },
+    { "Float32", FmuSignalFloat32 },
+    { "Int8", FmuSignalInt8 },
+    { "UInt8", FmuSignalUInt8 },
+    { "Int16", FmuSignalInt16 },
+    { "UInt16", FmuSignalUInt16 },
+    { "Int32", FmuSignalInt32 },
+    { "UInt32", FmuSignalUInt32 },
+    { "Int64", FmuSignalInt64 },
+    { "UInt64", FmuSignalUInt64 },
+    { "Boolean", FmuSignalBoolean },
+};
+
+
+static bool __is_type_var(xmlNodePtr node, FmuSignalType type)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(__variable_type_map); i++) {
+        if (__variable_type_map[i].type != type) continue;
+        return (xmlStrcmp(node->name, (xmlChar*)__variable_type_map[i].name) ==
+                0);
+    }
+    return false;
+}
+
+
+size_t fmu_variable_count(xmlDoc* doc, FmuSignalType type)
+{
+    size_t           count = 0;
+    xmlXPathContext* ctx = xmlXPathNewContext(doc);
+    xmlXPathObject*  obj =
+        xmlXPathEvalExpression((xmlChar*)FMI3_VARIABLE_XPATH, ctx);
+    if (obj == NULL) goto cleanup;
+
+    for (int i = 0; i < obj->nodesetval->nodeNr; i++) {
+        xmlNodePtr variable = obj->nodesetval->nodeTab[i];
+        if (__is_type_var(variable, type)) count += 1;
+    }
+
+cleanup:
+    xmlXPathFreeObject(obj);
+    xmlXPathFreeContext(ctx);
+    return count;
+}
+
+
+static void __index_scalar_variable(FmuInstanceData* fmu, FmuSignalVector* sv,
+    uint32_t sv_idx, xmlChar* vr, xmlChar* causality)
+{
+    if (xmlStrcmp(causality, (xmlChar*)"output") == 0) {
+        hashmap_set(
+            &(fmu->variables.scalar.output), (char*)vr, &(sv->scalar[sv_idx]));
+    } else if (xmlStrcmp(causality, (xmlChar*)"input") == 0) {
+        hashmap_set(
+            &(fmu->variables.scalar.input), (char*)vr, &(sv->scalar[sv_idx]));
+    }
+}
+
+
+static void __index_typed_variable(FmuInstanceData* fmu, FmuSignalVector* sv,
+    uint32_t sv_idx, xmlChar* vr, xmlChar* causality)
 {
-    UNUSED(doc);
-    UNUSED(is_binary);
-    return 0;
+    FmuSignalVectorIndex* idx = calloc(1, sizeof(FmuSignalVectorIndex));
+    idx->sv = sv;
+    idx->vi = sv_idx;
+    if (xmlStrcmp(causality, (xmlChar*)"output") == 0) {
+        hashmap_set_alt(&(fmu->variables.typed.output), (char*)vr, idx);
+    } else if (xmlStrcmp(causality, (xmlChar*)"input") == 0) {
+        hashmap_set_alt(&(fmu->variables.typed.input), (char*)vr, idx);
+    } else {
+        free(idx);
+    }
+}
+
+
+static void __index_binary_variable(FmuInstanceData* fmu, FmuSignalVector* sv,
+    uint32_t sv_idx, xmlNode* node, xmlChar* vr, xmlChar* causality)
+{
+    /*
+    fmi-ls-binary-to-text
+    ---------------------
+    Annotation type: dse.standards.fmi-ls-binary-to-text
+    Element: Encoding
+    Value:
+        * ascii85
+    Without this annotation the binary value is exchanged without encoding.
+    */
+    xmlChar* encoding = fmu_variable_annotation(node, FMI3_ANNOTATION_XPATH,
+        "dse.standards.fmi-ls-binary-to-text", "Encoding");
+
+    /*
+    fmi-ls-binary-codec
+    -------------------
+    Annotation type: dse.standards.fmi-ls-binary-codec
+    Element: Mimetype
+    Value: <mimetype string>
+    */
+    xmlChar* mime_type = fmu_variable_annotation(node, FMI3_ANNOTATION_XPATH,
+        "dse.standards.fmi-ls-binary-codec", "Mimetype");
+
+    /*
+    Binary Buffer
+    -------------
+    Annotation type: dse.fmi.binary-buffer
+    Element: Capacity
+    Value: <bytes> (initial capacity of the buffer)
+    */
+    xmlChar* capacity = fmu_variable_annotation(
+        node, FMI3_ANNOTATION_XPATH, "dse.fmi.binary-buffer", "Capacity");
+
+    fmu_variable_index_binary(fmu, sv, sv_idx, vr, causality, (char*)encoding,
+        (char*)mime_type, (char*)capacity);
+    xmlFree(encoding);
+    xmlFree(capacity);
 }
 
 
 void fmu_variable_index(
-    xmlDoc* doc, FmuInstanceData* fmu, FmuSignalVector* sv, bool is_binary)
+    xmlDoc* doc, FmuInstanceData* fmu, FmuSignalVector* sv, FmuSignalType type)
 {
-    UNUSED(doc);
-    UNUSED(fmu);
-    UNUSED(sv);
-    UNUSED(is_binary);
+    xmlXPathContext* ctx = xmlXPathNewContext(doc);
+    xmlXPathObject*  obj =
+        xmlXPathEvalExpression((xmlChar*)FMI3_VARIABLE_XPATH, ctx);
+    if (obj == NULL) goto cleanup;
+
+    /* Scan all variables. */
+    uint32_t sv_idx = 0;
+    for (int i = 0; i < obj->nodesetval->nodeNr; i++) {
+        xmlNodePtr variable = obj->nodesetval->nodeTab[i];
+        if (!__is_type_var(variable, type)) continue;
+
+        xmlChar* name = xmlGetProp(variable, (xmlChar*)"name");
+        xmlChar* vr = xmlGetProp(variable, (xmlChar*)"valueReference");
+        xmlChar* causality = xmlGetProp(variable, (xmlChar*)"causality");
+
+        /* Index this variable. */
+        assert(sv_idx < sv->count);
+        sv->signal[sv_idx] = strdup((char*)name);
+        if (type == FmuSignalBinary) {
+            __index_binary_variable(fmu, sv, sv_idx, variable, vr, causality);
+        } else if (type == FmuSignalScalar) {
+            __index_scalar_variable(fmu, sv, sv_idx, vr, causality);
+        } else {
+            __index_typed_variable(fmu, sv, sv_idx, vr, causality);
+        }
+        sv_idx += 1;
+
+        /* Cleanup. */
+        xmlFree(name);
+        xmlFree(vr);
+        xmlFree(causality);
+    }
+
+cleanup:
+    xmlXPathFreeObject(obj);
+    xmlXPathFreeContext(ctx);
 }
@@ -151,3 +151,69 @@ message (const char*)
 */
 extern void fmu_log(FmuInstanceData* fmu, const int status,
     const char* category, const char* message, ...);
+
+
+/**
+fmu_request_early_return
+========================
+
+Request an early return from the current step. Called from `fmu_step()`, for
+instance when a bus event arrives, to end the communication step at `time`
+rather than at the end of the step. The `fmu_step()` function should return
+after a successful request, the importer then continues the simulation from
+`time` (reported as `lastSuccessfulTime`).
+
+Early return is only available for FMI 3 Co-Simulation, and only when the
+importer allowed it when instantiating the FMU (`earlyReturnAllowed`).
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+time (double)
+: The model time at which the step ends, within the current step.
+
+Returns
+-------
+true
+: The early return was accepted, `fmu_step()` should return.
+
+false
+: Early return is not possible, `fmu_step()` should complete the step.
+*/
+extern bool fmu_request_early_return(FmuInstanceData* fmu, double time);
+
+
+/**
+fmu_intermediate_update
+=======================
+
+Inform the importer of an intermediate update (FMI 3 Co-Simulation), via the
+`intermediateUpdate` callback, during `fmu_step()`. The importer may use this
+update to request an early return, in which case the step should be ended.
+The update is only made when the importer allowed early return, and not when
+the step is pipelined (i.e. `fmu_step()` runs on a worker thread).
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+
+time (double)
+: The model time of the intermediate update.
+
+event (bool)
+: Set `true` if the update represents an event (e.g. a bus event), which may
+  be a reason for the importer to request an early return.
+
+Returns
+-------
+true
+: The importer requested an early return, `fmu_step()` should return.
+
+false
+: Continue the step (also when the update was not made).
+*/
+extern bool fmu_intermediate_update(
+    FmuInstanceData* fmu, double time, bool event);
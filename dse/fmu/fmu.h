@@ -6,7 +6,10 @@
 #define DSE_FMU_FMU_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <dse/clib/collections/hashmap.h>
 #include <dse/clib/collections/hashlist.h>
 
@@ -34,16 +37,24 @@ interface (indexing and storage). The FMU Interface includes the methods:
     * `[fmu_destroy()]({{< ref "#fmu_destroy" >}})`
 * Additional provided functions:
     * `[fmu_log()]({{< ref "#fmu_log" >}})` - logging function
+    * `[fmu_request_early_return()]({{< ref "#fmu_request_early_return" >}})`
+    * `[fmu_intermediate_update()]({{< ref "#fmu_intermediate_update" >}})`
 * Supporting Variable Table mechanism:
     * `[fmu_register_var()]({{< ref "#fmu_register_var" >}})`
     * `[fmu_register_var_table()]({{< ref "#fmu_register_var_table" >}})`
     * `[fmu_var_table()]({{< ref "#fmu_var_table" >}})`
+* Supporting typed (FMI 3) variables:
+    * `[fmu_lookup_typed_var()]({{< ref "#fmu_lookup_typed_var" >}})`
+* Supporting Scheduled Execution (FMI 3) with model partitions:
+    * `[fmu_register_partition()]({{< ref "#fmu_register_partition" >}})`
 
 
 An additional FMU Signal Interface is available for more complex integrations:
 * `[fmu_signals_reset()]({{< ref "#fmu_signals_reset" >}})`
 * `[fmu_signals_setup()]({{< ref "#fmu_signals_setup" >}})`
 * `[fmu_signals_remove()]({{< ref "#fmu_signals_remove" >}})`
+* `[fmu_signals_flush()]({{< ref "#fmu_signals_flush" >}})`
+* `[fmu_signals_pipeline()]({{< ref "#fmu_signals_pipeline" >}})`
 
 
 FMUs implemented using this simplified FMU API can be built for both FMI 2
@@ -187,20 +198,71 @@ static const struct {
     (sizeof(_fmi_log_category_map) / sizeof(_fmi_log_category_map[0]))
 
 /* FMU Signal Interface. */
-#define FMU_SIGNALS_RESET_FUNC_NAME  "fmu_signals_reset"
-#define FMU_SIGNALS_SETUP_FUNC_NAME  "fmu_signals_setup"
-#define FMU_SIGNALS_REMOVE_FUNC_NAME "fmu_signals_remove"
+#define FMU_SIGNALS_RESET_FUNC_NAME    "fmu_signals_reset"
+#define FMU_SIGNALS_SETUP_FUNC_NAME    "fmu_signals_setup"
+#define FMU_SIGNALS_REMOVE_FUNC_NAME   "fmu_signals_remove"
+#define FMU_SIGNALS_FLUSH_FUNC_NAME    "fmu_signals_flush"
+#define FMU_SIGNALS_PIPELINE_FUNC_NAME "fmu_signals_pipeline"
 typedef void (*FmuSignalsResetFunc)(FmuInstanceData* fmu);
 typedef void (*FmuSignalsSetupFunc)(FmuInstanceData* fmu);
 typedef void (*FmuSignalsRemoveFunc)(FmuInstanceData* fmu);
+typedef void (*FmuSignalsFlushFunc)(FmuInstanceData* fmu);
+typedef int32_t (*FmuSignalsPipelineFunc)(FmuInstanceData* fmu,
+    FmuStepFunc step, double communication_point, double step_size);
 
 typedef struct FmuSignalVTable {
-    FmuSignalsResetFunc  reset;
-    FmuSignalsSetupFunc  setup;
-    FmuSignalsRemoveFunc remove;
+    FmuSignalsResetFunc    reset;
+    FmuSignalsSetupFunc    setup;
+    FmuSignalsRemoveFunc   remove;
+    FmuSignalsFlushFunc    flush;
+    FmuSignalsPipelineFunc pipeline; /* Optional, pipelined step. */
 } FmuSignalVTable;
 
 
+/* Signal Vector storage types. */
+typedef enum FmuSignalType {
+    FmuSignalScalar = 0, /* double */
+    FmuSignalBinary,
+    /* Typed (FMI 3) signals, packed storage. */
+    FmuSignalFloat32,
+    FmuSignalInt8,
+    FmuSignalUInt8,
+    FmuSignalInt16,
+    FmuSignalUInt16,
+    FmuSignalInt32,
+    FmuSignalUInt32,
+    FmuSignalInt64,
+    FmuSignalUInt64,
+    FmuSignalBoolean,
+    FmuSignalTypeCount,
+} FmuSignalType;
+
+
+/* Storage size of a single typed signal element, 0 for scalar and binary. */
+static inline size_t fmu_signal_type_size(FmuSignalType type)
+{
+    switch (type) {
+    case FmuSignalInt8:
+    case FmuSignalUInt8:
+        return sizeof(uint8_t);
+    case FmuSignalInt16:
+    case FmuSignalUInt16:
+        return sizeof(uint16_t);
+    case FmuSignalFloat32:
+    case FmuSignalInt32:
+    case FmuSignalUInt32:
+        return sizeof(uint32_t);
+    case FmuSignalInt64:
+    case FmuSignalUInt64:
+        return sizeof(uint64_t);
+    case FmuSignalBoolean:
+        return sizeof(bool);
+    default:
+        return 0;
+    }
+}
+
+
 typedef struct FmuSignalVector {
     HashMap   index;  // map{signal:uint32_t} -> index to vectors
     uint32_t  count;
@@ -210,10 +272,16 @@ typedef struct FmuSignalVector {
     /* Scalar Signals. */
     double* scalar;
 
+    /* Typed Signals (FMI 3), packed array of `type` elements. */
+    FmuSignalType type;
+    void*         typed;
+
     /* Binary Signals. */
     void**    binary;
     uint32_t* length;
     uint32_t* buffer_size;
+    uint32_t  binary_class;  // Smallest size class, 0 for exact growth.
+    uint32_t  binary_growth; // Count of buffer growth events (realloc).
 
     /* Network Codec Objects (related to binary signals).*/
     char** mime_type;
@@ -227,6 +295,43 @@ typedef struct FmuSignalVectorIndex {
 } FmuSignalVectorIndex;
 
 
+/* Binary signal buffers grow in size classes (powers of 2, starting from
+   FMU_BINARY_SIZE_CLASS) and retain their capacity when reset. */
+#define FMU_BINARY_SIZE_CLASS 64
+
+
+static inline void fmu_sv_binary_reserve(
+    FmuSignalVector* sv, uint32_t index, uint32_t capacity)
+{
+    if (capacity <= sv->buffer_size[index]) return;
+    if (sv->binary_class) {
+        uint32_t size = sv->binary_class;
+        while (size < capacity && size < (UINT32_MAX / 2) + 1)
+            size <<= 1;
+        if (size > capacity) capacity = size;
+    }
+    void* buffer = realloc(sv->binary[index], capacity);
+    if (buffer == NULL) return;
+    sv->binary[index] = buffer;
+    sv->buffer_size[index] = capacity;
+}
+
+
+static inline void fmu_sv_binary_append(
+    FmuSignalVector* sv, uint32_t index, const void* data, uint32_t len)
+{
+    if (data == NULL || len == 0) return;
+    uint32_t length = sv->length[index];
+    if (length + len > sv->buffer_size[index]) {
+        fmu_sv_binary_reserve(sv, index, length + len);
+        if (length + len > sv->buffer_size[index]) return;
+        sv->binary_growth += 1;
+    }
+    memcpy((uint8_t*)sv->binary[index] + length, data, len);
+    sv->length[index] = length + len;
+}
+
+
 /* FMU NCodec Interface. */
 #define FMU_NCODEC_OPEN_FUNC_NAME  "fmu_ncodec_open"
 #define FMU_NCODEC_CLOSE_FUNC_NAME "fmu_ncodec_close"
@@ -235,6 +340,21 @@ typedef void* (*FmuNcodecOpenFunc)(
 typedef void (*FmuNcodecCloseFunc)(FmuInstanceData* fmu, void* ncodec);
 
 
+/* FMU Model Partition (FMI 3 Scheduled Execution). */
+typedef int32_t (*FmuPartitionFunc)(
+    FmuInstanceData* fmu, double activation_time);
+
+typedef struct FmuModelPartition {
+    uint32_t         clock_vref;
+    double           interval; /* Clock interval (s), 0 if aperiodic. */
+    FmuPartitionFunc func;
+    /* Clock state (fmi3SetClock/fmi3GetClock). */
+    bool             active;
+    bool             interval_reported;
+    uint64_t         activations;
+} FmuModelPartition;
+
+
 typedef struct FmuVarTableMarshalItem {
     double* variable;  // Pointer to FMU allocated storage.
     double* signal;    // Pointer to FmuSignalVector storage (i.e. scalar).
@@ -268,6 +388,11 @@ typedef struct FmuInstanceData {
             HashMap input;
             HashMap output;
         } string;  // NOLINT(build/include_what_you_use)
+        struct {
+            /* map{vref:FmuSignalVectorIndex*} */
+            HashMap input;
+            HashMap output;
+        } typed;
         struct {
             HashMap  rx;
             HashMap  tx;
@@ -275,11 +400,16 @@ typedef struct FmuInstanceData {
             HashMap  decode_func;
             /* Lazy free list for allocated strings. */
             HashList free_list;
+            /* NULL terminated list of Tx NCodec objects, flushed after
+               each step (i.e. fmu_step() may only call ncodec_write()). */
+            void**   flush_list;
         } binary;
         /* Variable storage, via Signal Vectors. */
         FmuSignalVTable vtable;
         /* Indicate if (binary) signals have been reset. */
         bool            signals_reset;
+        /* Pipelined step (front buffers and worker thread), when active. */
+        void*           pipeline;
     } variables;
 
     /* FMU Instance Data (additional). */
@@ -299,6 +429,39 @@ typedef struct FmuInstanceData {
         void*    map; /* Active when set. */
         uint32_t size;
     } direct_index;
+
+    /* FMU Changed Outputs (delta query extension). */
+    struct {
+        uint32_t  count;
+        uint32_t* vr;
+        double**  signal;
+        double*   value; /* Value at the previous query. */
+        /* Changed since the previous query. */
+        uint32_t* changed_vr;
+        double*   changed_value;
+    } delta;
+
+    /* FMU Early Return (FMI 3 Co-Simulation). */
+    struct {
+        bool   allowed;
+        void*  intermediate_update; /* Importer callback. */
+        /* Current step. */
+        double step_begin;
+        double step_end;
+        bool   requested;
+        double time;
+    } early_return;
+
+    /* FMU Model Partitions (FMI 3 Scheduled Execution). */
+    struct {
+        HashMap            map; /* map{clock_vref:FmuModelPartition*} */
+        /* The running partition (the innermost, when preempted). */
+        FmuModelPartition* running;
+        /* Importer callbacks (Scheduled Execution). */
+        void*              clock_update;
+        void*              lock_preemption;
+        void*              unlock_preemption;
+    } partition;
 } FmuInstanceData;
 
 
@@ -306,6 +469,11 @@ typedef struct FmuInstanceData {
 DLL_PRIVATE char* dse_ascii85_encode(const char* source, size_t len);
 DLL_PRIVATE char* dse_ascii85_decode(const char* source, size_t* len);
 
+/* delta.c (changed outputs, delta query extension) */
+DLL_PRIVATE bool   fmu_delta_setup(FmuInstanceData* fmu);
+DLL_PRIVATE size_t fmu_delta_query(FmuInstanceData* fmu);
+DLL_PRIVATE void   fmu_delta_destroy(FmuInstanceData* fmu);
+
 /* signal.c (default implementations for generic FMU) */
 DLL_PUBLIC void    fmu_load_signal_handlers(FmuInstanceData* fmu);
 DLL_PRIVATE double fmu_register_var(
@@ -314,6 +482,10 @@ DLL_PRIVATE void* fmu_lookup_ncodec(
     FmuInstanceData* fmu, uint32_t vref, bool input);
 DLL_PRIVATE void  fmu_register_var_table(FmuInstanceData* fmu, void* table);
 DLL_PRIVATE void* fmu_var_table(FmuInstanceData* fmu);
+DLL_PRIVATE void* fmu_lookup_typed_var(
+    FmuInstanceData* fmu, uint32_t vref, bool input, FmuSignalType type);
+DLL_PRIVATE void  fmu_register_partition(FmuInstanceData* fmu,
+     uint32_t clock_vref, double interval, FmuPartitionFunc func);
 
 /* FMU Interface (example implementation in fmu.c)  */
 DLL_PRIVATE FmuInstanceData* fmu_create(FmuInstanceData* fmu);
@@ -323,11 +495,17 @@ DLL_PRIVATE int32_t          fmu_step(
 DLL_PRIVATE int32_t fmu_destroy(FmuInstanceData* fmu);
 DLL_PRIVATE void    fmu_log(FmuInstanceData* fmu, const int status,
        const char* category, const char* message, ...);
+DLL_PRIVATE bool fmu_request_early_return(FmuInstanceData* fmu, double time);
+DLL_PRIVATE bool fmu_intermediate_update(
+    FmuInstanceData* fmu, double time, bool event);
 
 /* FMU Signal Interface (optional)  */
 DLL_PUBLIC void fmu_signals_reset(FmuInstanceData* fmu);
 DLL_PUBLIC void fmu_signals_setup(FmuInstanceData* fmu);
 DLL_PUBLIC void fmu_signals_remove(FmuInstanceData* fmu);
+DLL_PUBLIC void fmu_signals_flush(FmuInstanceData* fmu);
+DLL_PUBLIC int32_t fmu_signals_pipeline(FmuInstanceData* fmu, FmuStepFunc step,
+    double communication_point, double step_size);
 
 /* FMU NCodec Interface (optional) */
 DLL_PUBLIC void* fmu_ncodec_open(
@@ -6,9 +6,15 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/clib/util/strings.h>
@@ -27,16 +33,116 @@ Trace Interface.
 #define NCT_BUFFER_LEN 2000
 #define NCT_ENVVAR_LEN 100
 #define NCT_ID_LEN     100
-#define NCT_KEY_LEN    20
+#define NCT_BITMAP_IDS 2048 /* 11-bit CAN IDs. */
+#define NCT_RING_LEN   (256 * 1024)
+#define NCT_POLL_NS    1000000
+
+
+/*
+Binary Trace Sink.
+
+When NCODEC_TRACE_FILE is set, traced frames are not formatted. Instead they
+are appended (raw, with a timestamp) to a per-instance ring buffer which is
+drained by a writer thread to the trace file:
+
+    <file>.log      candump log format (can-utils).
+    <file>          pcapng, CAN frames as LINKTYPE_CAN_SOCKETCAN, PDUs as
+                    LINKTYPE_USER0 (id, swc_id, ecu_id, then the payload,
+                    header fields in network byte order).
+
+The sink exists once per FMU library (each loaded FMU has its own sink), so
+the file name is made unique with the process id and the name of the FMU
+instance which opened the sink (e.g. `trace.<pid>.<instance>.pcapng`).
+Frames are timestamped with CLOCK_MONOTONIC and written with the wall-clock
+offset taken when the file is opened (also recorded in the pcapng header).
+
+Each ring has a single producer (the NCodec) and a single consumer (the
+writer thread). When a ring is full, frames are dropped (the simulation
+never waits on the writer).
+*/
+#define NCT_LINKTYPE_CAN_SOCKETCAN 227
+#define NCT_LINKTYPE_USER0         147
+#define NCT_CAN_EFF_FLAG           0x80000000
+#define NCT_CANFD_FDF              0x04
+#define NCT_CAN_SNAPLEN            (8 + 64)
+#define NCT_PDU_HEADER_LEN         12
+
+
+typedef struct NCodecTraceRecord {
+    uint32_t size; /* Aligned record size, 0 marks wrap padding. */
+    uint32_t len;
+    uint64_t timestamp; /* ns, CLOCK_MONOTONIC. */
+    uint32_t id;
+    uint8_t  rx;
+    uint8_t  frame_type;
+    uint16_t reserved;
+    uint32_t swc_id;
+    uint32_t ecu_id;
+    uint8_t  data[];
+} NCodecTraceRecord;
+
+
+typedef struct NCodecTraceRing {
+    uint8_t* buffer;
+    uint64_t size;
+    uint64_t head; /* Producer (release), consumer (acquire). */
+    uint64_t tail; /* Consumer (release), producer (acquire). */
+    uint64_t dropped;
+    /* Sink interface. */
+    bool     can;
+    uint32_t interface_id;
+    char     name[NCT_ID_LEN];
+    struct NCodecTraceRing* next;
+} NCodecTraceRing;
+
+
+static struct {
+    pthread_mutex_t  lock;
+    pthread_cond_t   cond;
+    pthread_t        thread;
+    bool             stop;
+    bool             stopping; /* Writer shutdown, attach waits (cond). */
+    FILE*            file;
+    bool             candump;
+    bool             truncated; /* File was created by this process. */
+    uint64_t         offset;    /* Wall-clock offset (ns) of timestamps. */
+    uint32_t         interfaces;
+    NCodecTraceRing* rings;
+} __sink = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+
+/*
+Trace Filter.
+
+Compiled from the NCODEC_TRACE_* filter (e.g. "0x42,0x100-0x1ff"). IDs below
+NCT_BITMAP_IDS are matched with a bitmap, other IDs with a binary search of
+the sorted (and merged) ranges.
+*/
+typedef struct NCodecTraceRange {
+    uint32_t lo;
+    uint32_t hi;
+} NCodecTraceRange;
+
+
+typedef struct NCodecTraceFilter {
+    bool              wildcard;
+    uint8_t           bitmap[NCT_BITMAP_IDS / 8];
+    NCodecTraceRange* range;
+    size_t            range_count;
+} NCodecTraceFilter;
 
 
 typedef struct NCodecTraceData {
-    const char*      model_inst_name;
-    FmuInstanceData* fmu;
-    char             identifier[NCT_ID_LEN];
+    const char*       model_inst_name;
+    FmuInstanceData*  fmu;
+    char              identifier[NCT_ID_LEN];
     /* Filters. */
-    bool             wildcard;
-    HashMap          filter;
+    NCodecTraceFilter filter;
+    /* Binary trace (NCODEC_TRACE_FILE). */
+    NCodecTraceRing* ring;
 } NCodecTraceData;
 
 
@@ -72,13 +178,499 @@ static const char* __get_codec_config(NCodecInstance* nc, const char* name)
 }
 
 
+static uint64_t __timestamp(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+static void __ring_push(NCodecTraceRing* r, bool rx, uint32_t id,
+    uint8_t frame_type, uint32_t swc_id, uint32_t ecu_id, const uint8_t* data,
+    size_t len)
+{
+    uint64_t need = (sizeof(NCodecTraceRecord) + len + 7) & ~(uint64_t)7;
+    if (need > r->size / 2) {
+        r->dropped++;
+        return;
+    }
+    uint64_t head = r->head;
+    uint64_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    uint64_t offset = head % r->size;
+    uint64_t contiguous = r->size - offset;
+    uint64_t pad = (contiguous < need) ? contiguous : 0;
+    if (head + pad + need - tail > r->size) {
+        r->dropped++;
+        return;
+    }
+
+    /* Records are not split, pad to the end of the buffer and wrap. */
+    if (pad) {
+        ((NCodecTraceRecord*)(r->buffer + offset))->size = 0;
+        head += pad;
+        offset = 0;
+    }
+    NCodecTraceRecord* rec = (NCodecTraceRecord*)(r->buffer + offset);
+    rec->size = need;
+    rec->len = len;
+    rec->timestamp = __timestamp(CLOCK_MONOTONIC);
+    rec->id = id;
+    rec->rx = rx;
+    rec->frame_type = frame_type;
+    rec->swc_id = swc_id;
+    rec->ecu_id = ecu_id;
+    if (len) memcpy(rec->data, data, len);
+    __atomic_store_n(&r->head, head + need, __ATOMIC_RELEASE);
+}
+
+
+static void __put_u32(FILE* f, uint32_t v)
+{
+    fwrite(&v, sizeof(v), 1, f);
+}
+
+
+static void __put_be32(uint8_t* b, uint32_t v)
+{
+    b[0] = v >> 24;
+    b[1] = v >> 16;
+    b[2] = v >> 8;
+    b[3] = v;
+}
+
+
+static void __pcapng_option(FILE* f, uint16_t code, const void* v, uint16_t len)
+{
+    static const uint8_t zero[4] = { 0 };
+    uint16_t             h[2] = { code, len };
+    fwrite(h, sizeof(h), 1, f);
+    if (len) fwrite(v, len, 1, f);
+    fwrite(zero, (4 - len % 4) % 4, 1, f);
+}
+
+
+static uint32_t __pcapng_option_len(uint16_t len)
+{
+    return 4 + ((len + 3) & ~3);
+}
+
+
+static void __pcapng_shb(FILE* f, uint64_t offset)
+{
+    char comment[NCT_ID_LEN];
+    snprintf(comment, sizeof(comment),
+        "timestamps: CLOCK_MONOTONIC + %" PRIu64 " ns (wall-clock offset)",
+        offset);
+    uint16_t comment_len = strlen(comment);
+    uint32_t total =
+        28 + __pcapng_option_len(comment_len) + __pcapng_option_len(0);
+    __put_u32(f, 0x0A0D0D0A);
+    __put_u32(f, total);
+    __put_u32(f, 0x1A2B3C4D);
+    uint16_t version[2] = { 1, 0 };
+    fwrite(version, sizeof(version), 1, f);
+    int64_t section_len = -1;
+    fwrite(&section_len, sizeof(section_len), 1, f);
+    __pcapng_option(f, 1, comment, comment_len); /* opt_comment */
+    __pcapng_option(f, 0, NULL, 0);              /* opt_endofopt */
+    __put_u32(f, total);
+}
+
+
+static void __pcapng_idb(FILE* f, NCodecTraceRing* r, const char* description)
+{
+    uint8_t  tsresol = 9; /* ns */
+    uint16_t name_len = strlen(r->name);
+    uint16_t desc_len = strlen(description);
+    uint32_t total = 20 + __pcapng_option_len(name_len) +
+                     __pcapng_option_len(desc_len) + __pcapng_option_len(1) +
+                     __pcapng_option_len(0);
+    __put_u32(f, 0x00000001);
+    __put_u32(f, total);
+    uint16_t linktype[2] = {
+        r->can ? NCT_LINKTYPE_CAN_SOCKETCAN : NCT_LINKTYPE_USER0, 0
+    };
+    fwrite(linktype, sizeof(linktype), 1, f);
+    __put_u32(f, r->can ? NCT_CAN_SNAPLEN : 0);
+    __pcapng_option(f, 2, r->name, name_len);       /* if_name */
+    __pcapng_option(f, 3, description, desc_len);   /* if_description */
+    __pcapng_option(f, 9, &tsresol, 1);             /* if_tsresol */
+    __pcapng_option(f, 0, NULL, 0);                 /* opt_endofopt */
+    __put_u32(f, total);
+}
+
+
+static void __pcapng_epb(
+    FILE* f, NCodecTraceRing* r, NCodecTraceRecord* rec, uint64_t timestamp)
+{
+    static const uint8_t zero[4] = { 0 };
+    uint8_t              header[NCT_PDU_HEADER_LEN] = { 0 };
+    uint32_t             header_len;
+    uint32_t             len = rec->len;
+    if (r->can) {
+        /* struct canfd_frame. */
+        bool extended = (rec->frame_type == CAN_EXTENDED_FRAME ||
+                         rec->frame_type == CAN_FD_EXTENDED_FRAME);
+        bool fd = (rec->frame_type == CAN_FD_BASE_FRAME ||
+                   rec->frame_type == CAN_FD_EXTENDED_FRAME);
+        if (len > NCT_CAN_SNAPLEN - 8) len = NCT_CAN_SNAPLEN - 8;
+        __put_be32(header, rec->id | (extended ? NCT_CAN_EFF_FLAG : 0));
+        header[4] = len;
+        header[5] = fd ? NCT_CANFD_FDF : 0;
+        header_len = 8;
+    } else {
+        __put_be32(header, rec->id);
+        __put_be32(header + 4, rec->swc_id);
+        __put_be32(header + 8, rec->ecu_id);
+        header_len = NCT_PDU_HEADER_LEN;
+    }
+    uint32_t caplen = header_len + len;
+    uint32_t flags = rec->rx ? 0x1 : 0x2; /* Inbound : Outbound. */
+    uint32_t total = 28 + ((caplen + 3) & ~3) + __pcapng_option_len(4) +
+                     __pcapng_option_len(0) + 4;
+    __put_u32(f, 0x00000006);
+    __put_u32(f, total);
+    __put_u32(f, r->interface_id);
+    __put_u32(f, timestamp >> 32);
+    __put_u32(f, timestamp & 0xffffffff);
+    __put_u32(f, caplen);
+    __put_u32(f, header_len + rec->len);
+    fwrite(header, header_len, 1, f);
+    if (len) fwrite(rec->data, len, 1, f);
+    fwrite(zero, (4 - caplen % 4) % 4, 1, f);
+    __pcapng_option(f, 2, &flags, 4); /* epb_flags */
+    __pcapng_option(f, 0, NULL, 0);
+    __put_u32(f, total);
+}
+
+
+static void __candump_line(
+    FILE* f, NCodecTraceRing* r, NCodecTraceRecord* rec, uint64_t timestamp)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char              data[2 * 64 + 2];
+    size_t            pos = 0;
+    bool extended = (rec->frame_type == CAN_EXTENDED_FRAME ||
+                     rec->frame_type == CAN_FD_EXTENDED_FRAME);
+    bool fd = (rec->frame_type == CAN_FD_BASE_FRAME ||
+               rec->frame_type == CAN_FD_EXTENDED_FRAME);
+    uint32_t len = rec->len > 64 ? 64 : rec->len;
+
+    if (r->can && fd) data[pos++] = '0'; /* FD flags (#<flags>). */
+    for (uint32_t i = 0; i < len; i++) {
+        data[pos++] = hex[rec->data[i] >> 4];
+        data[pos++] = hex[rec->data[i] & 0xf];
+    }
+    data[pos] = '\0';
+    fprintf(f, "(%lu.%06lu) %s %0*X#%s%s\n",
+        (unsigned long)(timestamp / 1000000000),
+        (unsigned long)(timestamp % 1000000000 / 1000), r->name,
+        extended ? 8 : 3, rec->id, (r->can && fd) ? "#" : "", data);
+}
+
+
+static size_t __sink_drain(NCodecTraceRing* r)
+{
+    size_t   count = 0;
+    uint64_t tail = r->tail;
+    uint64_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    while (tail < head) {
+        uint64_t           offset = tail % r->size;
+        NCodecTraceRecord* rec = (NCodecTraceRecord*)(r->buffer + offset);
+        if (r->size - offset < sizeof(uint32_t) || rec->size == 0) {
+            tail += r->size - offset;
+            continue;
+        }
+        uint64_t timestamp = rec->timestamp + __sink.offset;
+        if (__sink.candump) {
+            __candump_line(__sink.file, r, rec, timestamp);
+        } else {
+            __pcapng_epb(__sink.file, r, rec, timestamp);
+        }
+        tail += rec->size;
+        count++;
+    }
+    __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+    return count;
+}
+
+
+static void* __sink_writer(void* arg)
+{
+    UNUSED(arg);
+    struct timespec poll = { .tv_sec = 0, .tv_nsec = NCT_POLL_NS };
+
+    while (__atomic_load_n(&__sink.stop, __ATOMIC_ACQUIRE) == false) {
+        size_t count = 0;
+        pthread_mutex_lock(&__sink.lock);
+        for (NCodecTraceRing* r = __sink.rings; r; r = r->next) {
+            count += __sink_drain(r);
+        }
+        if (count) fflush(__sink.file);
+        pthread_mutex_unlock(&__sink.lock);
+        if (count == 0) nanosleep(&poll, NULL);
+    }
+    return NULL;
+}
+
+
+static void __sink_path(
+    char* b, size_t size, const char* path, const char* instance_name)
+{
+    /* <stem>.<pid>[.<instance>]<ext>, the extension follows the last '.' of
+       the file name (not of a directory). */
+    const char* name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    const char* ext = strrchr(name, '.');
+    if (ext == NULL || ext == name) ext = path + strlen(path);
+    int len = snprintf(b, size, "%.*s.%ld", (int)(ext - path), path,
+        (long)getpid());
+    if (instance_name && *instance_name && len > 0 && (size_t)len + 1 < size) {
+        size_t pos = len;
+        b[pos++] = '.';
+        for (const char* p = instance_name; *p && pos + 1 < size; p++) {
+            b[pos++] = (isalnum((unsigned char)*p) || *p == '-') ? *p : '_';
+        }
+        b[pos] = '\0';
+        len = pos;
+    }
+    if (len > 0 && (size_t)len < size) {
+        snprintf(b + len, size - len, "%s", ext);
+    }
+}
+
+
+static NCodecTraceRing* __sink_attach(const char* trace_file, bool can,
+    const char* name, const char* description, const char* instance_name)
+{
+    NCodecTraceRing* r = NULL;
+    char             path[PATH_MAX];
+
+    pthread_mutex_lock(&__sink.lock);
+    /* Wait for a previous writer to complete its shutdown. */
+    while (__sink.stopping) {
+        pthread_cond_wait(&__sink.cond, &__sink.lock);
+    }
+    if (__sink.file == NULL) {
+        /* The first sink truncates, subsequent sinks append (new section). */
+        __sink_path(path, sizeof(path), trace_file, instance_name);
+        __sink.file = fopen(path, __sink.truncated ? "ab" : "wb");
+        if (__sink.file == NULL) {
+            __log(NULL, "NCodec Trace: unable to open %s (%s)", path,
+                strerror(errno));
+            goto unlock;
+        }
+        __sink.truncated = true;
+        size_t path_len = strlen(path);
+        __sink.candump =
+            (path_len > 4 && strcmp(path + path_len - 4, ".log") == 0);
+        __sink.interfaces = 0;
+        __sink.offset =
+            __timestamp(CLOCK_REALTIME) - __timestamp(CLOCK_MONOTONIC);
+        if (__sink.candump == false) __pcapng_shb(__sink.file, __sink.offset);
+        __atomic_store_n(&__sink.stop, false, __ATOMIC_RELEASE);
+        if (pthread_create(&__sink.thread, NULL, __sink_writer, NULL)) {
+            fclose(__sink.file);
+            __sink.file = NULL;
+            goto unlock;
+        }
+    }
+
+    r = calloc(1, sizeof(NCodecTraceRing));
+    r->size = NCT_RING_LEN;
+    r->buffer = calloc(r->size, sizeof(uint8_t));
+    r->can = can;
+    r->interface_id = __sink.interfaces++;
+    strncpy(r->name, name, NCT_ID_LEN - 1);
+    if (__sink.candump == false) __pcapng_idb(__sink.file, r, description);
+    r->next = __sink.rings;
+    __sink.rings = r;
+
+unlock:
+    pthread_mutex_unlock(&__sink.lock);
+    return r;
+}
+
+
+static void __sink_detach(NCodecTraceRing* r)
+{
+    pthread_mutex_lock(&__sink.lock);
+    __sink_drain(r);
+    for (NCodecTraceRing** p = &__sink.rings; *p; p = &(*p)->next) {
+        if (*p == r) {
+            *p = r->next;
+            break;
+        }
+    }
+    bool last = (__sink.rings == NULL);
+    if (last) {
+        __atomic_store_n(&__sink.stop, true, __ATOMIC_RELEASE);
+        __sink.stopping = true;
+    }
+    pthread_mutex_unlock(&__sink.lock);
+
+    /* Stop the writer with the last ring, the FMU may be unloaded. The writer
+       takes the lock, so join without holding it, a concurrent attach waits
+       (stopping) until the file is closed. */
+    if (last) {
+        pthread_join(__sink.thread, NULL);
+        pthread_mutex_lock(&__sink.lock);
+        fclose(__sink.file);
+        __sink.file = NULL;
+        __sink.stopping = false;
+        pthread_cond_broadcast(&__sink.cond);
+        pthread_mutex_unlock(&__sink.lock);
+    }
+    if (r->dropped) {
+        __log(NULL, "NCodec Trace: %s dropped %" PRIu64 " frames (buffer full)",
+            r->name, r->dropped);
+    }
+    free(r->buffer);
+    free(r);
+}
+
+
+static void __format_payload(
+    char* b, size_t size, const uint8_t* data, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t            pos = 0;
+    bool              long_form = (len > 16);
+
+    for (size_t i = 0; i < len; i++) {
+        if (pos + 8 >= size) break;
+        if (long_form) {
+            if (i % 32 == 0) {
+                b[pos++] = '\n';
+                b[pos++] = ' ';
+            }
+            if (i % 8 == 0) b[pos++] = ' ';
+        } else if (i && (i % 8 == 0)) {
+            b[pos++] = ' ';
+        }
+        b[pos++] = ' ';
+        b[pos++] = hex[data[i] >> 4];
+        b[pos++] = hex[data[i] & 0xf];
+    }
+    b[pos] = '\0';
+}
+
+
+static inline bool __filter_match(NCodecTraceFilter* f, uint32_t id)
+{
+    if (f->wildcard) return true;
+    if (id < NCT_BITMAP_IDS) return f->bitmap[id / 8] & (1 << (id % 8));
+
+    size_t lo = 0;
+    size_t hi = f->range_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (id < f->range[mid].lo) {
+            hi = mid;
+        } else if (id > f->range[mid].hi) {
+            lo = mid + 1;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static int __range_compar(const void* a, const void* b)
+{
+    const NCodecTraceRange* _a = a;
+    const NCodecTraceRange* _b = b;
+    if (_a->lo < _b->lo) return -1;
+    if (_a->lo > _b->lo) return 1;
+    return 0;
+}
+
+
+static bool __filter_parse_range(const char* token, NCodecTraceRange* range)
+{
+    char*         end = NULL;
+    unsigned long lo = strtoul(token, &end, 0);
+    if (end == token) return false;
+    unsigned long hi = lo;
+    while (isspace(*end))
+        end++;
+    if (*end == '-') {
+        const char* _hi = end + 1;
+        hi = strtoul(_hi, &end, 0);
+        if (end == _hi) return false;
+        while (isspace(*end))
+            end++;
+    }
+    if (*end != '\0' || hi < lo || hi > UINT32_MAX) return false;
+    range->lo = lo;
+    range->hi = hi;
+    return true;
+}
+
+
+static void __filter_compile(
+    NCodecInstance* nc, NCodecTraceFilter* f, const char* filter)
+{
+    if (strcmp(filter, "*") == 0) {
+        f->wildcard = true;
+        __log(nc, "    <wildcard> (all frames)");
+        return;
+    }
+
+    char* _filter = strdup(filter);
+    char* _saveptr = NULL;
+    char* _idptr = strtok_r(_filter, ",", &_saveptr);
+    while (_idptr) {
+        NCodecTraceRange r;
+        if (__filter_parse_range(_idptr, &r) == false) {
+            __log(nc, "    %s (ignored, not an ID or range)", _idptr);
+        } else {
+            if (r.lo == r.hi) {
+                __log(nc, "    %02x", r.lo);
+            } else {
+                __log(nc, "    %02x-%02x", r.lo, r.hi);
+            }
+            /* Bitmap part of the range. */
+            for (uint32_t id = r.lo; id <= r.hi && id < NCT_BITMAP_IDS; id++) {
+                f->bitmap[id / 8] |= (1 << (id % 8));
+            }
+            /* Remaining part of the range. */
+            if (r.hi >= NCT_BITMAP_IDS) {
+                if (r.lo < NCT_BITMAP_IDS) r.lo = NCT_BITMAP_IDS;
+                f->range = realloc(
+                    f->range, (f->range_count + 1) * sizeof(NCodecTraceRange));
+                f->range[f->range_count++] = r;
+            }
+        }
+        _idptr = strtok_r(NULL, ",", &_saveptr);
+    }
+    free(_filter);
+
+    /* Sort and merge the ranges (for binary search). */
+    if (f->range_count == 0) return;
+    qsort(f->range, f->range_count, sizeof(NCodecTraceRange), __range_compar);
+    size_t count = 1;
+    for (size_t i = 1; i < f->range_count; i++) {
+        NCodecTraceRange* last = &f->range[count - 1];
+        if (f->range[i].lo <= (uint64_t)last->hi + 1) {
+            if (f->range[i].hi > last->hi) last->hi = f->range[i].hi;
+        } else {
+            f->range[count++] = f->range[i];
+        }
+    }
+    f->range_count = count;
+}
+
+
 static void trace_can_log(
     NCodecInstance* nc, NCodecMessage* m, const char* direction)
 {
     NCodecTraceData*  td = nc->private;
     NCodecCanMessage* msg = m;
-    static char       b[NCT_BUFFER_LEN];
-    static char       identifier[NCT_ID_LEN];
+    char              b[NCT_BUFFER_LEN];
+    char              identifier[NCT_ID_LEN];
 
     /* Setup bus identifier (on first call). */
     if (strlen(td->identifier) == 0) {
@@ -88,43 +680,24 @@ static void trace_can_log(
     }
 
     /* Filter the message. */
-    if (td->wildcard == false) {
-        char key[NCT_KEY_LEN];
-        snprintf(key, NCT_KEY_LEN, "%u", msg->frame_id);
-        if (hashmap_get(&td->filter, key) == NULL) return;
+    if (__filter_match(&td->filter, msg->frame_id) == false) return;
+
+    /* Binary trace, formatting is done offline. */
+    if (td->ring) {
+        __ring_push(td->ring, direction[0] == 'R', msg->frame_id,
+            msg->frame_type, msg->sender.bus_id, msg->sender.node_id,
+            msg->buffer, msg->len);
+        return;
     }
 
     /* Format and write the log. */
-    memset(b, 0, NCT_BUFFER_LEN);
     if (strcmp(direction, "RX") == 0) {
         snprintf(identifier, NCT_ID_LEN, "%d:%d:%d", msg->sender.bus_id,
             msg->sender.node_id, msg->sender.interface_id);
     } else {
         strncpy(identifier, td->identifier, NCT_ID_LEN);
     }
-    if (msg->len <= 16) {
-        // Short form log.
-        for (uint32_t i = 0; i < msg->len; i++) {
-            if (i && (i % 8 == 0)) {
-                snprintf(b + strlen(b), sizeof(b) - strlen(b), " ");
-            }
-            snprintf(
-                b + strlen(b), sizeof(b) - strlen(b), " %02x", msg->buffer[i]);
-        }
-    } else {
-        // Long form log.
-        for (uint32_t i = 0; i < msg->len; i++) {
-            if (strlen(b) > NCT_BUFFER_LEN) break;
-            if (i % 32 == 0) {
-                snprintf(b + strlen(b), sizeof(b) - strlen(b), "\n ");
-            }
-            if (i % 8 == 0) {
-                snprintf(b + strlen(b), sizeof(b) - strlen(b), " ");
-            }
-            snprintf(
-                b + strlen(b), sizeof(b) - strlen(b), " %02x", msg->buffer[i]);
-        }
-    }
+    __format_payload(b, NCT_BUFFER_LEN, msg->buffer, msg->len);
     __log(nc, "(%s) [%s] %s %02x %d %lu :%s", td->model_inst_name, identifier,
         direction, msg->frame_id, msg->frame_type, msg->len, b);
 }
@@ -145,8 +718,8 @@ static void trace_pdu_log(
 {
     NCodecTraceData* td = nc->private;
     NCodecPdu*       pdu = m;
-    static char      b[NCT_BUFFER_LEN];
-    static char      identifier[NCT_ID_LEN];
+    char             b[NCT_BUFFER_LEN];
+    char             identifier[NCT_ID_LEN];
 
     /* Setup bus identifier (on first call). */
     if (strlen(td->identifier) == 0) {
@@ -155,42 +728,22 @@ static void trace_pdu_log(
     }
 
     /* Filter the message. */
-    if (td->wildcard == false) {
-        char key[NCT_KEY_LEN];
-        snprintf(key, NCT_KEY_LEN, "%u", pdu->id);
-        if (hashmap_get(&td->filter, key) == NULL) return;
+    if (__filter_match(&td->filter, pdu->id) == false) return;
+
+    /* Binary trace, formatting is done offline. */
+    if (td->ring) {
+        __ring_push(td->ring, direction[0] == 'R', pdu->id, 0, pdu->swc_id,
+            pdu->ecu_id, pdu->payload, pdu->payload_len);
+        return;
     }
 
     /* Format and write the log. */
-    memset(b, 0, NCT_BUFFER_LEN);
     if (strcmp(direction, "RX") == 0) {
         snprintf(identifier, NCT_ID_LEN, "%d:%d", pdu->swc_id, pdu->ecu_id);
     } else {
         strncpy(identifier, td->identifier, NCT_ID_LEN);
     }
-    if (pdu->payload_len <= 16) {
-        // Short form log.
-        for (uint32_t i = 0; i < pdu->payload_len; i++) {
-            if (i && (i % 8 == 0)) {
-                snprintf(b + strlen(b), sizeof(b) - strlen(b), " ");
-            }
-            snprintf(
-                b + strlen(b), sizeof(b) - strlen(b), " %02x", pdu->payload[i]);
-        }
-    } else {
-        // Long form log.
-        for (uint32_t i = 0; i < pdu->payload_len; i++) {
-            if (strlen(b) > NCT_BUFFER_LEN) break;
-            if (i % 32 == 0) {
-                snprintf(b + strlen(b), sizeof(b) - strlen(b), "\n ");
-            }
-            if (i % 8 == 0) {
-                snprintf(b + strlen(b), sizeof(b) - strlen(b), " ");
-            }
-            snprintf(
-                b + strlen(b), sizeof(b) - strlen(b), " %02x", pdu->payload[i]);
-        }
-    }
+    __format_payload(b, NCT_BUFFER_LEN, pdu->payload, pdu->payload_len);
     __log(nc, "(%s) [%s] %s %02x %lu :%s", td->model_inst_name, identifier,
         direction, pdu->id, pdu->payload_len, b);
 
@@ -325,26 +878,24 @@ static void trace_configure(NCodecInstance* nc, FmuInstanceData* fmu)
 
     td->model_inst_name = fmu->instance.name;
     td->fmu = fmu;
-    hashmap_init(&td->filter);
-
-    if (strcmp(filter, "*") == 0) {
-        td->wildcard = true;
-        __log(nc, "    <wildcard> (all frames)");
-    } else {
-        char* _filter = strdup(filter);
-        char* _saveptr = NULL;
-        char* _idptr = strtok_r(_filter, ",", &_saveptr);
-        while (_idptr) {
-            int64_t _id = strtol(_idptr, NULL, 0);
-            if (_id > 0) {
-                char key[NCT_KEY_LEN];
-                snprintf(key, NCT_KEY_LEN, "%u", (uint32_t)_id);
-                hashmap_set_long(&td->filter, key, true);
-                __log(nc, "    %02x", (unsigned int)_id);
-            }
-            _idptr = strtok_r(NULL, ",", &_saveptr);
+    __filter_compile(nc, &td->filter, filter);
+
+    /* Binary trace (optional). */
+    const char* trace_file = getenv("NCODEC_TRACE_FILE");
+    if (trace_file && strlen(trace_file)) {
+        char name[NCT_ID_LEN];
+        char description[NCT_ID_LEN * 2];
+        if (type_can) {
+            snprintf(
+                name, NCT_ID_LEN, "can%s", __get_codec_config(nc, "bus_id"));
+        } else {
+            snprintf(
+                name, NCT_ID_LEN, "pdu%s", __get_codec_config(nc, "swc_id"));
         }
-        free(_filter);
+        snprintf(description, sizeof(description), "%s:%s",
+            td->model_inst_name, env_name);
+        td->ring = __sink_attach(
+            trace_file, type_can, name, description, td->model_inst_name);
     }
 
     /* Install the trace. */
@@ -364,7 +915,8 @@ static void trace_destroy(NCodecInstance* nc)
 {
     if (nc->private) {
         NCodecTraceData* td = nc->private;
-        hashmap_destroy(&td->filter);
+        if (td->ring) __sink_detach(td->ring);
+        free(td->filter.range);
         free(td);
         nc->private = NULL;
     }
@@ -430,8 +982,7 @@ static size_t stream_write(NCODEC* nc, uint8_t* data, size_t len)
     /* Write from current pos (i.e. truncate). */
     if (_s->pos > s_len) _s->pos = s_len;
     _s->sv->length[_s->idx] = _s->pos;
-    dse_buffer_append(&_s->sv->binary[_s->idx], &_s->sv->length[_s->idx],
-        &_s->sv->buffer_size[_s->idx], data, len);
+    fmu_sv_binary_append(_s->sv, _s->idx, data, len);
     _s->pos += len;
 
     return len;
@@ -6,19 +6,24 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include <libxml/xpath.h>
 #include <dse/clib/collections/hashlist.h>
 #include <dse/ncodec/codec.h>
 #include <dse/fmu/fmu.h>
 
 
-#define UNUSED(x) ((void)x)
+#define UNUSED(x)                 ((void)x)
+#define FMU_STEP_PIPELINE_ENVAR   "FMU_STEP_PIPELINE"
 
 
-extern size_t fmu_variable_count(xmlDoc* doc, bool is_binary);
-extern void   fmu_variable_index(
-      xmlDoc* doc, FmuInstanceData* fmu, FmuSignalVector* sv, bool is_binary);
-extern void fmu_sv_stream_destroy(void* stream);
+extern size_t fmu_variable_count(xmlDoc* doc, FmuSignalType type);
+extern void   fmu_variable_index(xmlDoc* doc, FmuInstanceData* fmu,
+      FmuSignalVector* sv, FmuSignalType type);
+extern void   fmu_sv_stream_destroy(void* stream);
 
 
 /**
@@ -76,6 +81,108 @@ fmu (FmuInstanceData*)
 */
 extern void fmu_signals_remove(FmuInstanceData* fmu);
 
+/**
+fmu_signals_flush
+=================
+
+This method will flush any NCodec objects representing binary output
+variables, after the FMU has stepped. The messages written by an FMU during
+a step (with `ncodec_write()`) are therefore encoded to the binary variable
+with a single flush, the FMU does not need to call `ncodec_flush()`.
+
+> Integrators may provide their own implementation of this method, which is
+  installed (`fmu->variables.vtable.flush`) by their implementation of
+  `fmu_load_signal_handlers()`.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+*/
+extern void fmu_signals_flush(FmuInstanceData* fmu);
+
+/**
+fmu_signals_pipeline
+====================
+
+This method runs a pipelined step of the FMU. The previous step is completed,
+the (double buffered) variables are exchanged, and then the step function
+is started on a worker thread. The method returns without waiting for the
+step to complete, the outputs of an FMU are therefore delayed by one step.
+
+The return code is delayed in the same way: a failing step is reported by
+the following call of this method (i.e. the next `fmi2DoStep()` or
+`fmi3DoStep()`), or, for the final step, when the pipeline is completed (i.e.
+by `fmi2FreeInstance()` or `fmi3FreeInstance()`, which log the error). The
+outputs of the step which reported the error are those of the step before the
+failing step.
+
+The FMI Get/Set functions operate on the front buffers while the step function
+(i.e. `fmu_step()`) operates on the back buffers (i.e. the Signal Vectors
+referenced by the Variable Table and NCodec objects).
+
+> Enabled by setting the environment variable `FMU_STEP_PIPELINE`. Integrators
+  may provide their own implementation of this method, which is installed
+  (`fmu->variables.vtable.pipeline`) by their implementation of
+  `fmu_load_signal_handlers()`.
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+step (FmuStepFunc)
+: The step function to run on the worker thread. Set to NULL to complete the
+  current step and stop the worker thread.
+communication_point (double)
+: The model time (for the start of this step).
+step_size (double)
+: The model step size.
+
+Returns
+-------
+int32_t
+: The return code of the previous step (0 when there is no previous step).
+*/
+extern int32_t fmu_signals_pipeline(FmuInstanceData* fmu, FmuStepFunc step,
+    double communication_point, double step_size);
+
+
+typedef struct FmuPipelineItem {
+    void*  front;
+    void*  back;
+    size_t size;
+} FmuPipelineItem;
+
+typedef struct FmuPipelineBinary {
+    FmuSignalVector* front;
+    FmuSignalVector* back;
+    uint32_t         vi;
+    bool             rx;
+} FmuPipelineBinary;
+
+typedef struct FmuPipeline {
+    /* Front buffers (Signal Vectors), NULL terminated (i.e. signal). */
+    FmuSignalVector*   front;
+    /* Exchange lists. */
+    FmuPipelineItem*   input;
+    size_t             input_count;
+    FmuPipelineItem*   output;
+    size_t             output_count;
+    FmuPipelineBinary* binary;
+    size_t             binary_count;
+    /* Worker thread. */
+    pthread_t          thread;
+    pthread_mutex_t    lock;
+    pthread_cond_t     cond;
+    bool               running;
+    bool               busy;
+    bool               stop;
+    FmuStepFunc        step;
+    double             communication_point;
+    double             step_size;
+    int32_t            rc;
+} FmuPipeline;
+
 
 /**
 fmu_register_var
@@ -196,6 +303,98 @@ void fmu_register_var_table(FmuInstanceData* fmu, void* table)
 }
 
 
+/**
+fmu_lookup_typed_var
+====================
+
+Lookup the storage of a typed (FMI 3) variable of the FMU. Typed variables
+(e.g. Int32, Boolean) are stored packed in their native representation,
+the returned pointer may be cast accordingly (i.e. `int32_t*` or `bool*`).
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+vref (uint32_t)
+: Variable reference of the typed variable.
+input (bool)
+: Set `true` for input, and `false` for output variable causality.
+type (FmuSignalType)
+: The expected type of the variable.
+
+Returns
+-------
+void*
+: Pointer to the variable storage, or NULL if the variable was not found or
+  has a different type (always NULL for FMI 2 FMUs).
+*/
+void* fmu_lookup_typed_var(
+    FmuInstanceData* fmu, uint32_t vref, bool input, FmuSignalType type)
+{
+    FmuSignalVectorIndex* idx = NULL;
+    char                  key[HASHLIST_KEY_LEN];
+    HashMap*              map =
+        input ? &fmu->variables.typed.input : &fmu->variables.typed.output;
+
+    /* Typed variables are only indexed by FMI 3 FMUs. */
+    if (map->hash_function == NULL) return NULL;
+
+    /* Lookup the signal. */
+    snprintf(key, HASHLIST_KEY_LEN, "%i", vref);
+    idx = hashmap_get(map, key);
+    if (idx == NULL || idx->sv->type != type) return NULL;
+
+    /* Return the storage pointer. */
+    return (uint8_t*)idx->sv->typed + idx->vi * fmu_signal_type_size(type);
+}
+
+
+/**
+fmu_register_partition
+======================
+
+Register a Model Partition of the FMU. When the FMU is instantiated for
+Scheduled Execution (FMI 3) the importer activates each partition, via its
+clock, with `fmi3ActivateModelPartition()` and only the partition function
+of that clock is called (instead of `fmu_step()`). Partitions are typically
+registered in `fmu_create()`.
+
+> Partitions share the Variable Table, and are marshalled in full. When a
+  partition preempts another, the Variable Table of the preempted partition
+  is saved and restored (retaining the variables written by the preempting
+  partition) before the preempted partition resumes. A partition can not
+  preempt itself (`fmi3Error`).
+
+Parameters
+----------
+fmu (FmuInstanceData*)
+: The FMU Descriptor object representing an instance of the FMU Model.
+clock_vref (uint32_t)
+: Variable reference of the (input) Clock which activates the partition.
+interval (double)
+: Interval of the clock in seconds, or 0 for an aperiodic clock.
+func (FmuPartitionFunc)
+: The partition function, called with the FMU and the activation time.
+*/
+void fmu_register_partition(FmuInstanceData* fmu, uint32_t clock_vref,
+    double interval, FmuPartitionFunc func)
+{
+    char key[HASHLIST_KEY_LEN];
+
+    if (fmu->partition.map.hash_function == NULL) {
+        hashmap_init(&fmu->partition.map);
+    }
+    FmuModelPartition* p = calloc(1, sizeof(FmuModelPartition));
+    *p = (FmuModelPartition){
+        .clock_vref = clock_vref,
+        .interval = interval,
+        .func = func,
+    };
+    snprintf(key, HASHLIST_KEY_LEN, "%i", clock_vref);
+    hashmap_set_alt(&fmu->partition.map, key, p);
+}
+
+
 /**
 fmu_var_table
 =============
@@ -218,22 +417,86 @@ void* fmu_var_table(FmuInstanceData* fmu)
 }
 
 
-static FmuSignalVector* __allocate_sv(xmlDoc* doc, bool is_binary)
+/* Annotation lookup common to FMI 2 and FMI 3 variable indexing (the XPath
+   query selects the annotation element relative to the variable node). */
+xmlChar* fmu_variable_annotation(
+    xmlNode* node, const char* xpath, const char* tool, const char* name)
 {
-    size_t count = fmu_variable_count(doc, is_binary);
+    xmlChar* result = NULL;
+
+    /* Build the XPath query. */
+    size_t query_len = snprintf(NULL, 0, xpath, tool, name) + 1;
+    char*  query = calloc(query_len, sizeof(char));
+    snprintf(query, query_len, xpath, tool, name);
+    xmlXPathContext* ctx = xmlXPathNewContext(node->doc);
+    ctx->node = node;
+    xmlXPathObject* obj = xmlXPathEvalExpression((xmlChar*)query, ctx);
+
+    /* Locate the annotation value (if present). */
+    if (obj && obj->type == XPATH_NODESET && obj->nodesetval &&
+        obj->nodesetval->nodeNr > 0) {
+        result = xmlNodeGetContent(obj->nodesetval->nodeTab[0]);
+    }
+
+    /* Cleanup and return the result. */
+    free(query);
+    xmlXPathFreeObject(obj);
+    xmlXPathFreeContext(ctx);
+    return result;
+}
+
+
+/* Binary variable indexing common to FMI 2 and FMI 3, the annotation values
+   are parsed by the caller (mime_type is retained by the signal vector). */
+void fmu_variable_index_binary(FmuInstanceData* fmu, FmuSignalVector* sv,
+    uint32_t sv_idx, xmlChar* vr, xmlChar* causality, const char* encoding,
+    char* mime_type, const char* capacity)
+{
+    FmuSignalVectorIndex* idx = calloc(1, sizeof(FmuSignalVectorIndex));
+    idx->sv = sv;
+    idx->vi = sv_idx;
+    if (xmlStrcmp(causality, (xmlChar*)"output") == 0) {
+        hashmap_set_alt(&(fmu->variables.binary.tx), (char*)vr, idx);
+    } else if (xmlStrcmp(causality, (xmlChar*)"input") == 0) {
+        hashmap_set_alt(&(fmu->variables.binary.rx), (char*)vr, idx);
+    }
+
+    if (encoding && strcmp(encoding, "ascii85") == 0) {
+        hashmap_set(
+            &fmu->variables.binary.encode_func, (char*)vr, dse_ascii85_encode);
+        hashmap_set(
+            &fmu->variables.binary.decode_func, (char*)vr, dse_ascii85_decode);
+    }
+
+    sv->mime_type[sv_idx] = mime_type;
+    sv->ncodec[sv_idx] = fmu_ncodec_open(fmu, sv->mime_type[sv_idx], idx);
+
+    if (capacity) {
+        fmu_sv_binary_reserve(sv, sv_idx, strtoul(capacity, NULL, 0));
+    }
+}
+
+
+static FmuSignalVector* __allocate_sv(xmlDoc* doc, FmuSignalType type)
+{
+    size_t count = fmu_variable_count(doc, type);
     if (count == 0) return NULL;
 
     FmuSignalVector* sv = calloc(1, sizeof(FmuSignalVector));
     sv->count = count;
     sv->signal = calloc(count, sizeof(char*));
-    if (is_binary) {
+    sv->type = type;
+    if (type == FmuSignalBinary) {
         sv->binary = calloc(count, sizeof(void*));
         sv->length = calloc(count, sizeof(uint32_t));
         sv->buffer_size = calloc(count, sizeof(uint32_t));
+        sv->binary_class = FMU_BINARY_SIZE_CLASS;
         sv->mime_type = calloc(count, sizeof(char*));
         sv->ncodec = calloc(count, sizeof(void*));
-    } else {
+    } else if (type == FmuSignalScalar) {
         sv->scalar = calloc(count, sizeof(double));
+    } else {
+        sv->typed = calloc(count, fmu_signal_type_size(type));
     }
     return sv;
 }
@@ -244,10 +507,15 @@ static void fmu_default_signals_reset(FmuInstanceData* fmu)
     assert(fmu);
 
     if (fmu->variables.signals_reset == false) {
-        for (FmuSignalVector* sv = fmu->data; sv && sv->signal; sv++) {
+        /* When pipelined, reset the front buffers (used by FMI Get/Set). */
+        FmuSignalVector* data = fmu->data;
+        FmuPipeline*     p = fmu->variables.pipeline;
+        if (p) data = p->front;
+        for (FmuSignalVector* sv = data; sv && sv->signal; sv++) {
             if (sv->binary == NULL) continue;
             for (uint32_t i = 0; i < sv->count; i++) {
-                if (sv->ncodec[i]) {
+                /* NCodec objects only operate on the back buffers. */
+                if (sv->ncodec[i] && p == NULL) {
                     ncodec_truncate(sv->ncodec[i]);
                 } else {
                     sv->length[i] = 0;
@@ -274,27 +542,359 @@ static void fmu_default_signals_setup(FmuInstanceData* fmu)
         return;
     }
 
-    /* Setup scalar variables. */
-    FmuSignalVector* scalar_sv = __allocate_sv(doc, false);
-    if (scalar_sv) hashlist_append(&sv_list, scalar_sv);
-
-    /* Setup binary variables. */
-    FmuSignalVector* binary_sv = __allocate_sv(doc, true);
-    if (binary_sv) hashlist_append(&sv_list, binary_sv);
+    /* Setup scalar, binary and typed variables (one vector per type). */
+    for (FmuSignalType type = 0; type < FmuSignalTypeCount; type++) {
+        FmuSignalVector* _sv = __allocate_sv(doc, type);
+        if (_sv) hashlist_append(&sv_list, _sv);
+    }
 
     /* Complete and store the signal vectors. */
     FmuSignalVector* sv = hashlist_ntl(&sv_list, sizeof(FmuSignalVector), true);
     for (FmuSignalVector* _sv = sv; _sv && _sv->signal; _sv++) {
-        fmu_variable_index(doc, fmu, _sv, _sv->scalar ? false : true);
+        fmu_variable_index(doc, fmu, _sv, _sv->type);
     }
 
     fmu->data = sv;
     xmlFreeDoc(doc);
+
+    /* Collect the Tx NCodec objects (flushed after each step). */
+    HashMap* tx = &fmu->variables.binary.tx;
+    if (tx->used_nodes) {
+        char** keys = hashmap_keys(tx);
+        size_t count = 0;
+        fmu->variables.binary.flush_list =
+            calloc(tx->used_nodes + 1, sizeof(void*));
+        for (uint64_t i = 0; i < tx->used_nodes; i++) {
+            FmuSignalVectorIndex* idx = hashmap_get(tx, keys[i]);
+            if (idx && idx->sv->ncodec && idx->sv->ncodec[idx->vi]) {
+                fmu->variables.binary.flush_list[count++] =
+                    idx->sv->ncodec[idx->vi];
+            }
+            free(keys[i]);
+        }
+        free(keys);
+    }
+}
+
+
+static void fmu_default_signals_flush(FmuInstanceData* fmu)
+{
+    for (void** nc = fmu->variables.binary.flush_list; nc && *nc; nc++) {
+        ncodec_flush(*nc);
+    }
+}
+
+
+static bool __pipeline_enabled(void)
+{
+    const char* value = getenv(FMU_STEP_PIPELINE_ENVAR);
+    if (value == NULL) return false;
+    return (strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
+}
+
+
+static void __pipeline_item(FmuPipelineItem** list, size_t* count,
+    void* front, void* back, size_t size)
+{
+    *list = realloc(*list, (*count + 1) * sizeof(FmuPipelineItem));
+    (*list)[(*count)++] =
+        (FmuPipelineItem){ .front = front, .back = back, .size = size };
+}
+
+
+static void __pipeline_index_scalar(
+    FmuInstanceData* fmu, FmuPipeline* p, HashMap* map, bool input)
+{
+    if (map->hash_function == NULL || map->used_nodes == 0) return;
+    char** keys = hashmap_keys(map);
+    for (uint64_t i = 0; i < map->used_nodes; i++) {
+        double* signal = hashmap_get(map, keys[i]);
+        size_t  k = 0;
+        for (FmuSignalVector* sv = fmu->data; sv && sv->signal; sv++, k++) {
+            if (sv->scalar == NULL) continue;
+            if (signal < sv->scalar) continue;
+            if (signal >= sv->scalar + sv->count) continue;
+            double* front = p->front[k].scalar + (signal - sv->scalar);
+            if (input) {
+                __pipeline_item(
+                    &p->input, &p->input_count, front, signal, sizeof(double));
+            } else {
+                __pipeline_item(&p->output, &p->output_count, front, signal,
+                    sizeof(double));
+            }
+            /* FMI Get/Set operate on the front buffer. */
+            hashmap_set(map, keys[i], front);
+            break;
+        }
+        free(keys[i]);
+    }
+    free(keys);
+}
+
+
+static void __pipeline_index_typed(
+    FmuInstanceData* fmu, FmuPipeline* p, HashMap* map, bool input)
+{
+    if (map->hash_function == NULL || map->used_nodes == 0) return;
+    char** keys = hashmap_keys(map);
+    for (uint64_t i = 0; i < map->used_nodes; i++) {
+        FmuSignalVectorIndex* idx = hashmap_get(map, keys[i]);
+        FmuSignalVector*      front =
+            &p->front[idx->sv - (FmuSignalVector*)fmu->data];
+        size_t   size = fmu_signal_type_size(idx->sv->type);
+        uint8_t* f = (uint8_t*)front->typed + idx->vi * size;
+        uint8_t* b = (uint8_t*)idx->sv->typed + idx->vi * size;
+        if (input) {
+            __pipeline_item(&p->input, &p->input_count, f, b, size);
+        } else {
+            __pipeline_item(&p->output, &p->output_count, f, b, size);
+        }
+        idx->sv = front;
+        free(keys[i]);
+    }
+    free(keys);
+}
+
+
+static void __pipeline_exchange_binary(FmuPipelineBinary* b)
+{
+    void*    binary = b->front->binary[b->vi];
+    uint32_t length = b->front->length[b->vi];
+    uint32_t buffer_size = b->front->buffer_size[b->vi];
+    b->front->binary[b->vi] = b->back->binary[b->vi];
+    b->front->length[b->vi] = b->back->length[b->vi];
+    b->front->buffer_size[b->vi] = b->back->buffer_size[b->vi];
+    b->back->binary[b->vi] = binary;
+    b->back->length[b->vi] = length;
+    b->back->buffer_size[b->vi] = buffer_size;
+}
+
+
+static void __pipeline_index_binary(
+    FmuInstanceData* fmu, FmuPipeline* p, HashMap* map, bool rx)
+{
+    if (map->hash_function == NULL || map->used_nodes == 0) return;
+    char** keys = hashmap_keys(map);
+    for (uint64_t i = 0; i < map->used_nodes; i++) {
+        FmuSignalVectorIndex* idx = hashmap_get(map, keys[i]);
+        FmuSignalVector*      front =
+            &p->front[idx->sv - (FmuSignalVector*)fmu->data];
+        p->binary =
+            realloc(p->binary, (p->binary_count + 1) * sizeof(*p->binary));
+        p->binary[p->binary_count] = (FmuPipelineBinary){
+            .front = front, .back = idx->sv, .vi = idx->vi, .rx = rx
+        };
+        /* Binary values already set (i.e. before the first step) are moved
+           to the front buffer. */
+        __pipeline_exchange_binary(&p->binary[p->binary_count++]);
+        idx->sv = front;
+        free(keys[i]);
+    }
+    free(keys);
+}
+
+
+static FmuPipeline* __pipeline_create(FmuInstanceData* fmu)
+{
+    FmuPipeline* p = calloc(1, sizeof(FmuPipeline));
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->cond, NULL);
+
+    /* Front buffers, initially a copy of the (back) Signal Vectors. */
+    size_t count = 0;
+    for (FmuSignalVector* sv = fmu->data; sv && sv->signal; sv++) {
+        count++;
+    }
+    p->front = calloc(count + 1, sizeof(FmuSignalVector));
+    for (size_t i = 0; i < count; i++) {
+        FmuSignalVector* sv = (FmuSignalVector*)fmu->data + i;
+        FmuSignalVector* f = &p->front[i];
+        *f = *sv;
+        if (sv->scalar) {
+            f->scalar = calloc(sv->count, sizeof(double));
+            memcpy(f->scalar, sv->scalar, sv->count * sizeof(double));
+        }
+        if (sv->typed) {
+            size_t size = fmu_signal_type_size(sv->type);
+            f->typed = calloc(sv->count, size);
+            memcpy(f->typed, sv->typed, sv->count * size);
+        }
+        if (sv->binary) {
+            f->binary = calloc(sv->count, sizeof(void*));
+            f->length = calloc(sv->count, sizeof(uint32_t));
+            f->buffer_size = calloc(sv->count, sizeof(uint32_t));
+            f->binary_growth = 0;
+        }
+    }
+
+    /* Redirect the variable indexes (FMI Get/Set) to the front buffers. */
+    __pipeline_index_scalar(fmu, p, &fmu->variables.scalar.input, true);
+    __pipeline_index_scalar(fmu, p, &fmu->variables.scalar.output, false);
+    __pipeline_index_typed(fmu, p, &fmu->variables.typed.input, true);
+    __pipeline_index_typed(fmu, p, &fmu->variables.typed.output, false);
+    __pipeline_index_binary(fmu, p, &fmu->variables.binary.rx, true);
+    __pipeline_index_binary(fmu, p, &fmu->variables.binary.tx, false);
+
+    /* The step runs on a worker thread, an early return is not possible. */
+    fmu->early_return.allowed = false;
+
+    fmu_log(fmu, FmiLogOk, "Debug",
+        "Pipelined step: inputs=%zu, outputs=%zu, binary=%zu", p->input_count,
+        p->output_count, p->binary_count);
+    return p;
+}
+
+
+static void __pipeline_swap(FmuPipeline* p)
+{
+    /* Binary: reset the consumed Rx (back) buffers, exchange the buffers and
+       then reset the delivered Tx (back) buffers. */
+    for (size_t i = 0; i < p->binary_count; i++) {
+        FmuPipelineBinary* b = &p->binary[i];
+        NCODEC*            nc = b->back->ncodec[b->vi];
+        if (b->rx) {
+            if (nc) {
+                ncodec_truncate(nc);
+            } else {
+                b->back->length[b->vi] = 0;
+            }
+        }
+        __pipeline_exchange_binary(b);
+        if (b->rx) {
+            b->front->length[b->vi] = 0;
+        } else {
+            if (nc) {
+                ncodec_truncate(nc);
+            } else {
+                b->back->length[b->vi] = 0;
+            }
+        }
+    }
+
+    /* Scalar and typed variables. */
+    for (size_t i = 0; i < p->output_count; i++) {
+        memcpy(p->output[i].front, p->output[i].back, p->output[i].size);
+    }
+    for (size_t i = 0; i < p->input_count; i++) {
+        memcpy(p->input[i].back, p->input[i].front, p->input[i].size);
+    }
+}
+
+
+static void* __pipeline_worker(void* arg)
+{
+    FmuInstanceData* fmu = arg;
+    FmuPipeline*     p = fmu->variables.pipeline;
+
+    pthread_mutex_lock(&p->lock);
+    while (true) {
+        while (p->busy == false && p->stop == false) {
+            pthread_cond_wait(&p->cond, &p->lock);
+        }
+        if (p->busy == false) break;
+
+        pthread_mutex_unlock(&p->lock);
+        int32_t rc = p->step(fmu, p->communication_point, p->step_size);
+        pthread_mutex_lock(&p->lock);
+
+        /* Reported by the next call of fmu_default_signals_pipeline(). */
+        p->rc = rc;
+        p->busy = false;
+        pthread_cond_broadcast(&p->cond);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+
+static int32_t fmu_default_signals_pipeline(FmuInstanceData* fmu,
+    FmuStepFunc step, double communication_point, double step_size)
+{
+    FmuPipeline* p = fmu->variables.pipeline;
+    if (p == NULL) {
+        if (step == NULL) return 0;
+        if (fmu->direct_index.map) {
+            /* Direct Index variables are not double buffered. */
+            return step(fmu, communication_point, step_size);
+        }
+        p = fmu->variables.pipeline = __pipeline_create(fmu);
+    }
+
+    /* Complete the previous step. */
+    pthread_mutex_lock(&p->lock);
+    while (p->busy) {
+        pthread_cond_wait(&p->cond, &p->lock);
+    }
+    int32_t rc = p->rc;
+    p->rc = 0;
+    if (step == NULL) {
+        p->stop = true;
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->lock);
+        if (p->running) pthread_join(p->thread, NULL);
+        p->running = false;
+        p->stop = false;
+        return rc;
+    }
+
+    /* Exchange the buffers and start the next step. */
+    __pipeline_swap(p);
+    p->step = step;
+    p->communication_point = communication_point;
+    p->step_size = step_size;
+    p->busy = true;
+    if (p->running == false) {
+        if (pthread_create(&p->thread, NULL, __pipeline_worker, fmu) == 0) {
+            p->running = true;
+        } else {
+            fmu_log(fmu, FmiLogWarning, "Warning",
+                "Pipelined step: worker thread not started");
+            p->rc = step(fmu, communication_point, step_size);
+            p->busy = false;
+        }
+    } else {
+        pthread_cond_broadcast(&p->cond);
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    return rc;
+}
+
+
+static void __pipeline_destroy(FmuInstanceData* fmu)
+{
+    FmuPipeline* p = fmu->variables.pipeline;
+    if (p == NULL) return;
+
+    fmu_default_signals_pipeline(fmu, NULL, 0, 0);
+    for (FmuSignalVector* f = p->front; f->signal; f++) {
+        if (f->binary) {
+            for (uint32_t i = 0; i < f->count; i++) {
+                free(f->binary[i]);
+            }
+        }
+        free(f->binary);
+        free(f->length);
+        free(f->buffer_size);
+        free(f->scalar);
+        free(f->typed);
+    }
+    free(p->front);
+    free(p->input);
+    free(p->output);
+    free(p->binary);
+    pthread_cond_destroy(&p->cond);
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+    fmu->variables.pipeline = NULL;
 }
 
 
 static void fmu_default_signals_remove(FmuInstanceData* fmu)
 {
+    __pipeline_destroy(fmu);
+    free(fmu->variables.binary.flush_list);
+    fmu->variables.binary.flush_list = NULL;
     if (fmu->data == NULL) return;
     for (FmuSignalVector* sv = fmu->data; sv && sv->signal; sv++) {
         if (sv->signal) {
@@ -320,7 +920,15 @@ static void fmu_default_signals_remove(FmuInstanceData* fmu)
             free(sv->mime_type);
         }
         free(sv->scalar);
+        free(sv->typed);
         if (sv->binary) {
+            uint64_t capacity = 0;
+            for (uint32_t i = 0; i < sv->count; i++) {
+                capacity += sv->buffer_size[i];
+            }
+            fmu_log(fmu, FmiLogOk, "Debug",
+                "Binary buffers: count=%u, capacity=%lu, growth=%u", sv->count,
+                (unsigned long)capacity, sv->binary_growth);
             for (uint32_t i = 0; i < sv->count; i++) {
                 free(sv->binary[i]);
                 sv->binary[i] = NULL;
@@ -352,4 +960,8 @@ void fmu_load_signal_handlers(FmuInstanceData* fmu)
     fmu->variables.vtable.reset = fmu_default_signals_reset;
     fmu->variables.vtable.setup = fmu_default_signals_setup;
     fmu->variables.vtable.remove = fmu_default_signals_remove;
+    fmu->variables.vtable.flush = fmu_default_signals_flush;
+    if (__pipeline_enabled()) {
+        fmu->variables.vtable.pipeline = fmu_default_signals_pipeline;
+    }
 }
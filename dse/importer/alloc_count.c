@@ -0,0 +1,79 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <dse/importer/importer.h>
+
+
+/**
+Allocation Counting
+===================
+
+Interposes the glibc allocator (process wide, includes allocations made by
+the FMU) to count heap allocations for the Step Report. Only linked when the
+Importer is built with `IMPORTER_ALLOC_COUNT=ON`, the interposer adds an
+atomic operation to each allocation and bypasses allocators installed by
+tools such as ASan or valgrind.
+*/
+
+
+#if defined(__GLIBC__)
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+static uint64_t _alloc_count;
+
+void* malloc(size_t size)
+{
+    __atomic_fetch_add(&_alloc_count, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size)
+{
+    __atomic_fetch_add(&_alloc_count, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    __atomic_fetch_add(&_alloc_count, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    __atomic_fetch_add(&_alloc_count, 1, __ATOMIC_RELAXED);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void*) || (alignment & (alignment - 1))) {
+        return EINVAL;
+    }
+    __atomic_fetch_add(&_alloc_count, 1, __ATOMIC_RELAXED);
+    void* ptr = __libc_memalign(alignment, size);
+    if (ptr == NULL) return ENOMEM;
+    *memptr = ptr;
+    return 0;
+}
+
+bool importer_alloc_count(uint64_t* count)
+{
+    *count = __atomic_load_n(&_alloc_count, __ATOMIC_RELAXED);
+    return true;
+}
+#else
+bool importer_alloc_count(uint64_t* count)
+{
+    *count = 0;
+    return false;
+}
+#endif
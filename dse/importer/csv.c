@@ -2,85 +2,357 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <inttypes.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <dse/importer/importer.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CSV_MMAP 1
+#endif
+
 
 extern void _log(const char* format, ...);
 
 
+/**
+CSV Stimulus
+============
+
+CSV files are mapped into memory and parsed in place, there is no limit on
+the length of a line. The first line holds the VRs of the columns, each
+following line holds a timestamp and the sample values. Fields are delimited
+by `,` or `;`, an empty field leaves the value of that column unchanged.
+
+A CSV file may be compiled (`--csv-compile`) into a columnar binary stimulus
+file which is replayed (via `--csv`) without any parsing. Layout (native
+byte order):
+
+```text
+CsvBinHeader                    magic, version, columns, rows
+uint32_t vr[columns]            padded to 8 bytes
+double   timestamp[rows]
+double   value[columns][rows]
+uint8_t  set[columns][rows]     1 when the value is set, 0 for "no value"
+```
+*/
+
+
+#define CSV_BIN_VERSION 2
+
+
+static const double _pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+    1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+    1e21, 1e22 };
+
+
+static inline bool _is_space(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+static inline bool _is_digit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+
+static bool _parse_double_slow(const char* s, const char* e, double* value)
+{
+    char buffer[64];
+    if ((size_t)(e - s) >= sizeof(buffer)) return false;
+    memcpy(buffer, s, e - s);
+    buffer[e - s] = '\0';
+
+    char* end = NULL;
+    errno = 0;
+    double v = strtod(buffer, &end);
+    if (errno || end == buffer) return false;
+    while (_is_space(*end))
+        end++;
+    if (*end != '\0') return false;
+    *value = v;
+    return true;
+}
+
+
+/* Parse the double in [s, e). Decimal numbers with up to 15 significant
+ * digits and a small exponent (i.e. exactly representable operands) are
+ * converted directly, everything else falls back to strtod(). */
+static bool _parse_double(const char* s, const char* e, double* value)
+{
+    const char* p = s;
+    while (p < e && _is_space(*p))
+        p++;
+
+    bool neg = false;
+    if (p < e && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int      digits = 0;
+    int      scale = 0;
+    bool     any = false;
+    for (; p < e && _is_digit(*p); p++, any = true) {
+        if (digits < 15) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            return _parse_double_slow(s, e, value);
+        }
+    }
+    if (p < e && *p == '.') {
+        for (p++; p < e && _is_digit(*p); p++, any = true) {
+            if (digits < 15) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa) digits++;
+                scale--;
+            } else if (*p != '0') {
+                return _parse_double_slow(s, e, value);
+            }
+        }
+    }
+    if (any == false) return _parse_double_slow(s, e, value);
+    if (p < e && (*p == 'e' || *p == 'E')) {
+        bool exp_neg = false;
+        int  exp = 0;
+        p++;
+        if (p < e && (*p == '-' || *p == '+')) {
+            exp_neg = (*p == '-');
+            p++;
+        }
+        if (p >= e || !_is_digit(*p)) return _parse_double_slow(s, e, value);
+        for (; p < e && _is_digit(*p); p++) {
+            if (exp < 1000) exp = exp * 10 + (*p - '0');
+        }
+        scale += exp_neg ? -exp : exp;
+    }
+    while (p < e && _is_space(*p))
+        p++;
+    if (p != e) return _parse_double_slow(s, e, value);
+    if (scale < -22 || scale > 22) return _parse_double_slow(s, e, value);
+
+    double v = (double)mantissa;
+    v = (scale < 0) ? v / _pow10[-scale] : v * _pow10[scale];
+    *value = neg ? -v : v;
+    return true;
+}
+
+
+/* Locate the field starting at p, returns the start of the next field. */
+static inline const char* _next_field(
+    const char* p, const char* end, const char** field_end)
+{
+    while (p < end && *p != ',' && *p != ';')
+        p++;
+    *field_end = p;
+    return (p < end) ? p + 1 : end;
+}
+
+
+static bool _map_file(CsvDesc* c, const char* path)
+{
+#ifdef CSV_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    c->size = (size_t)st.st_size;
+    if (c->size) {
+        void* data = mmap(NULL, c->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(data, c->size, MADV_SEQUENTIAL);
+        c->data = data;
+        c->mapped = true;
+    }
+    close(fd);
+    return true;
+#else
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return false;
+    }
+    c->size = (size_t)size;
+    c->data = malloc(c->size + 1);
+    c->size = fread(c->data, 1, c->size, file);
+    fclose(file);
+    return true;
+#endif
+}
+
+
+static bool _load_bin(CsvDesc* c)
+{
+    const CsvBinHeader* h = (const CsvBinHeader*)c->data;
+    if (c->size < sizeof(CsvBinHeader)) return false;
+    if (memcmp(h->magic, CSV_BIN_MAGIC, sizeof(h->magic)) != 0) return false;
+
+    /* Bound columns and rows by the file size before they are used (the
+       size calculation must not overflow). */
+    size_t avail = c->size - sizeof(CsvBinHeader);
+    size_t vr_size = (((size_t)h->columns * sizeof(uint32_t)) + 7) & ~(size_t)7;
+    size_t row_size = ((size_t)h->columns + 1) * sizeof(double) + h->columns;
+    if (h->version != CSV_BIN_VERSION || vr_size > avail ||
+        h->rows > (avail - vr_size) / row_size) {
+        _log("ERROR: Bad compiled CSV file (version %u, columns %u, rows "
+             "%" PRIu64 ", size %zu)",
+            h->version, h->columns, h->rows, c->size);
+        exit(1);
+    }
+    c->bin.header = h;
+    c->bin.vr = (const uint32_t*)(c->data + sizeof(CsvBinHeader));
+    c->bin.timestamp =
+        (const double*)(c->data + sizeof(CsvBinHeader) + vr_size);
+    c->bin.value = c->bin.timestamp + h->rows;
+    c->bin.set = (const uint8_t*)(c->bin.value + h->rows * h->columns);
+    return true;
+}
+
+
 CsvDesc* csv_open(const char* path)
 {
     if (path == NULL) return NULL;
 
     CsvDesc* c = malloc(sizeof(CsvDesc));
     *c = (CsvDesc){
-        .line = calloc(CSV_LINE_MAXLEN, sizeof(char)),
         .index = vector_make(sizeof(double*), 0, NULL),
     };
-    c->file = fopen(path, "r");
-    if (c->file == NULL) {
+    if (_map_file(c, path) == false) {
         _log("ERROR: Could not open CSV file: %s", path);
         perror("Error opening file");
         exit(1);
     }
+    if (_load_bin(c) == false) {
+        c->pos = c->data;
+        c->end = c->data + c->size;
+    }
 
     return c;
 }
 
+
+static size_t _parse_header(
+    CsvDesc* c, unsigned int* rx_vr, double* rx_real, size_t count)
+{
+    if (c->pos >= c->end) return 0;
+
+    /* The first line holds the VRs (after the timestamp column). */
+    const char* end = memchr(c->pos, '\n', c->end - c->pos);
+    if (end == NULL) end = c->end;
+    const char* p = c->pos;
+    const char* field_end;
+    size_t      index = 0;
+    p = _next_field(p, end, &field_end); /* Consume the timestamp column. */
+    while (p < end) {
+        const char* field = p;
+        p = _next_field(p, end, &field_end);
+        double vr;
+        if (_parse_double(field, field_end, &vr) == false) break;
+        if (rx_vr) {
+            if (index >= count) break;
+            double* signal_val = NULL;
+            for (size_t i = 0; i < count; i++) {
+                if (rx_vr[i] == (unsigned int)vr) {
+                    signal_val = &rx_real[i];
+                    break;
+                }
+            }
+            if (signal_val == NULL) {
+                _log("ERROR: VR not found: %u", (unsigned int)vr);
+                exit(1);
+            }
+            vector_push(&c->index, &signal_val);
+        } else {
+            uint32_t _vr = (uint32_t)vr;
+            vector_push(&c->index, &_vr);
+        }
+        index++;
+    }
+    c->pos = (end < c->end) ? end + 1 : c->end;
+    return index;
+}
+
+
 void csv_index(CsvDesc* c, unsigned int* rx_vr, double* rx_real, size_t count)
 {
     if (c == NULL) return;
 
     // Build an index based on the first line of the CSV file.
     // The Index is a mapping based on VR.
-    fgets(c->line, CSV_LINE_MAXLEN, c->file);
-    char* _saveptr = NULL;
-    strtok_r(c->line, CSV_DELIMITER, &_saveptr);
-    char*  vr;
-    size_t index = 0;
-    while ((vr = strtok_r(NULL, CSV_DELIMITER, &_saveptr))) {
-        if (index >= count) break;
-
-        unsigned int _vr = atoi(vr);
-        double*      signal_val = NULL;
-        for (size_t i = 0; i < count; i++) {
-            if (rx_vr[i] == _vr) {
-                signal_val = &rx_real[i];
-                break;
+    if (c->bin.header) {
+        for (size_t col = 0; col < c->bin.header->columns; col++) {
+            if (col >= count) break;
+            double* signal_val = NULL;
+            for (size_t i = 0; i < count; i++) {
+                if (rx_vr[i] == c->bin.vr[col]) {
+                    signal_val = &rx_real[i];
+                    break;
+                }
             }
+            if (signal_val == NULL) {
+                _log("ERROR: VR not found: %u", c->bin.vr[col]);
+                exit(1);
+            }
+            vector_push(&c->index, &signal_val);
         }
-        if (signal_val == NULL) {
-            _log("ERROR: VR not found: %s", vr);
-            exit(1);
-        }
-        vector_push(&c->index, &signal_val);
-        index++;
+    } else {
+        _parse_header(c, rx_vr, rx_real, count);
     }
 
     // Preload the CSV Desc object with the first sample.
     csv_read_line(c);
 }
 
+
 bool csv_read_line(CsvDesc* c)
 {
     if (c == NULL) return false;
 
     c->timestamp = -1;  // Set a safe time (i.e. no valid value set).
+    if (c->bin.header) {
+        if (c->bin.next >= c->bin.header->rows) return false;
+        c->bin.row = c->bin.next++;
+        c->timestamp = c->bin.timestamp[c->bin.row];
+        return true;
+    }
     while (c->timestamp < 0) {
         // Read a line.
-        char* line = fgets(c->line, CSV_LINE_MAXLEN, c->file);
-        if (line == NULL) return false;
-        if (strlen(line) == 0) continue;
+        if (c->pos >= c->end) return false;
+        c->line = c->pos;
+        c->line_end = memchr(c->pos, '\n', c->end - c->pos);
+        if (c->line_end == NULL) c->line_end = c->end;
+        c->pos = (c->line_end < c->end) ? c->line_end + 1 : c->end;
+        const char* p = c->line;
+        while (p < c->line_end && _is_space(*p))
+            p++;
+        if (p == c->line_end) continue;
 
         // Get the timestamp.
-        errno = 0;
-        double ts = strtod(c->line, NULL);
-        if (errno) {
+        const char* field_end;
+        double      ts;
+        _next_field(c->line, c->line_end, &field_end);
+        if (_parse_double(c->line, field_end, &ts) == false) {
             _log("Bad line, timestamp conversion failed");
-            _log("%s", c->line);
+            _log("%.*s", (int)(c->line_end - c->line), c->line);
             continue;
         }
         if (ts >= 0) c->timestamp = ts;
@@ -89,15 +361,155 @@ bool csv_read_line(CsvDesc* c)
     return true;
 }
 
+
+void csv_apply(CsvDesc* c, double simulation_time)
+{
+    if (c == NULL) return;
+
+    /* Apply value sets from CSV. */
+    while ((c->timestamp >= 0) && (c->timestamp <= simulation_time)) {
+        size_t count = vector_len(&c->index);
+        if (c->bin.header) {
+            const double*  v = c->bin.value + c->bin.row;
+            const uint8_t* set = c->bin.set + c->bin.row;
+            for (size_t idx = 0; idx < count; idx++) {
+                double* signal = NULL;
+                vector_at(&c->index, idx, &signal);
+                if (signal && *set) *signal = *v;
+                v += c->bin.header->rows;
+                set += c->bin.header->rows;
+            }
+        } else {
+            const char* field_end;
+            const char* p = _next_field(c->line, c->line_end, &field_end);
+            for (size_t idx = 0; idx < count && p < c->line_end; idx++) {
+                const char* field = p;
+                p = _next_field(p, c->line_end, &field_end);
+                if (field == field_end) continue; /* Empty, no value. */
+                double v;
+                if (_parse_double(field, field_end, &v)) {
+                    double* signal = NULL;
+                    vector_at(&c->index, idx, &signal);
+                    if (signal) *signal = v;
+                } else {
+                    _log("Error decoding sample [%f][%zu]", c->timestamp, idx);
+                }
+            }
+        }
+        /* Load the next line. */
+        if (csv_read_line(c) == false) break;
+    }
+}
+
+
 void csv_close(CsvDesc* c)
 {
     if (c == NULL) return;
 
-    if (c->line) free(c->line);
-    c->line = NULL;
-    if (c->file) fclose(c->file);
-    c->file = NULL;
+#ifdef CSV_MMAP
+    if (c->mapped) munmap(c->data, c->size);
+#else
+    free(c->data);
+#endif
+    c->data = NULL;
     vector_reset(&c->index);
 
     free(c);
 }
+
+
+/**
+csv_compile
+===========
+
+Compile a CSV stimulus file into a columnar binary stimulus file.
+
+Parameters
+----------
+path (const char*)
+: Path of the CSV file.
+out_path (const char*)
+: Path of the compiled (binary) stimulus file.
+
+Returns
+-------
+0 (int)
+: The CSV file was compiled.
++ve (int)
+: An error occurred (errno).
+*/
+int csv_compile(const char* path, const char* out_path)
+{
+    CsvDesc* c = csv_open(path);
+    if (c == NULL) return EINVAL;
+    if (c->bin.header) {
+        _log("ERROR: CSV file is already compiled: %s", path);
+        csv_close(c);
+        return EINVAL;
+    }
+
+    /* Header, the index holds the VRs of each column. */
+    vector_reset(&c->index);
+    c->index = vector_make(sizeof(uint32_t), 0, NULL);
+    size_t      columns = _parse_header(c, NULL, NULL, 0);
+    const char* body = c->pos;
+
+    /* Count the rows. */
+    uint64_t rows = 0;
+    while (csv_read_line(c))
+        rows++;
+
+    /* Parse the rows into columns. */
+    double* timestamp = calloc(rows ? rows : 1, sizeof(double));
+    double*  value = calloc(rows * columns + 1, sizeof(double));
+    uint8_t* set = calloc(rows * columns + 1, sizeof(uint8_t));
+    c->pos = body;
+    for (uint64_t row = 0; row < rows && csv_read_line(c); row++) {
+        timestamp[row] = c->timestamp;
+        const char* field_end;
+        const char* p = _next_field(c->line, c->line_end, &field_end);
+        for (size_t col = 0; col < columns && p < c->line_end; col++) {
+            const char* field = p;
+            p = _next_field(p, c->line_end, &field_end);
+            if (field == field_end) continue;
+            if (_parse_double(field, field_end, &value[col * rows + row])) {
+                set[col * rows + row] = 1;
+            } else {
+                _log("Error decoding sample [%f][%zu]", c->timestamp, col);
+            }
+        }
+    }
+
+    /* Write the compiled file. */
+    int   rc = 0;
+    FILE* file = fopen(out_path, "wb");
+    if (file) {
+        CsvBinHeader h = {
+            .magic = CSV_BIN_MAGIC,
+            .version = CSV_BIN_VERSION,
+            .columns = columns,
+            .rows = rows,
+        };
+        uint64_t pad = 0;
+        size_t   vr_size = columns * sizeof(uint32_t);
+        fwrite(&h, sizeof(h), 1, file);
+        fwrite(vector_at(&c->index, 0, NULL), sizeof(uint32_t), columns, file);
+        fwrite(&pad, 1, ((vr_size + 7) & ~(size_t)7) - vr_size, file);
+        fwrite(timestamp, sizeof(double), rows, file);
+        fwrite(value, sizeof(double), rows * columns, file);
+        fwrite(set, sizeof(uint8_t), rows * columns, file);
+        if (ferror(file)) rc = EIO;
+        fclose(file);
+        _log("CSV compiled: %s (columns=%zu, rows=%" PRIu64 ")", out_path,
+            columns, rows);
+    } else {
+        _log("ERROR: Could not open file: %s", out_path);
+        rc = errno ? errno : EINVAL;
+    }
+
+    free(timestamp);
+    free(value);
+    free(set);
+    csv_close(c);
+    return rc;
+}
@@ -33,30 +33,13 @@ This Importer is able to load and operate an FMU with a simple Co-Simulation.
 
 Support for both FMI 2 and FMI 3 Co-Simulation.
 
-*/
-
+When a connection file is specified (`--multi`) the Importer loads all listed
+FMUs and operates them in a parallel Jacobi Co-Simulation (see `multi.c`).
 
-/* Define types for the FMI 2 inteface methods being used. */
-typedef void* (*fmi2Instantiate)();
-typedef int32_t (*fmi2SetDebugLogging)();
-typedef int32_t (*fmi2ExitInitializationMode)();
-typedef int32_t (*fmi2GetReal)();
-typedef int32_t (*fmi2GetString)();
-typedef int32_t (*fmi2SetReal)();
-typedef int32_t (*fmi2SetString)();
-typedef int32_t (*fmi2DoStep)();
-typedef void (*fmi2FreeInstance)();
+Output variables can be streamed to a columnar recording (`--output`, see
+`recorder.c`) which is converted to CSV with `--dump`.
 
-
-/* Define types for the FMI 3 inteface methods being used. */
-typedef void* (*fmi3InstantiateCoSimulation)();
-typedef int32_t (*fmi3ExitInitializationMode)();
-typedef int32_t (*fmi3GetFloat64)();
-typedef int32_t (*fmi3GetBinary)();
-typedef int32_t (*fmi3SetFloat64)();
-typedef int32_t (*fmi3SetBinary)();
-typedef int32_t (*fmi3DoStep)();
-typedef void (*fmi3FreeInstance)();
+*/
 
 
 #define UNUSED(x)      ((void)x)
@@ -64,7 +47,7 @@ typedef void (*fmi3FreeInstance)();
 #define MODEL_XML_FILE "modelDescription.xml"
 
 
-#define OPT_LIST       "hs:X:P:Bvc:"
+#define OPT_LIST       "hs:X:P:Bvc:C:M:T:R:o:bD:"
 static struct option long_options[] = {
     { "help", no_argument, NULL, 'h' },
     { "step_size", optional_argument, NULL, 's' },
@@ -73,6 +56,13 @@ static struct option long_options[] = {
     { "signal_bus", no_argument, NULL, 'B' },
     { "verbose", no_argument, NULL, 'v' },
     { "csv", required_argument, NULL, 'c' },
+    { "csv-compile", required_argument, NULL, 'C' },
+    { "multi", required_argument, NULL, 'M' },
+    { "threads", required_argument, NULL, 'T' },
+    { "report", required_argument, NULL, 'R' },
+    { "output", required_argument, NULL, 'o' },
+    { "output-binary", no_argument, NULL, 'b' },
+    { "dump", required_argument, NULL, 'D' },
 };
 
 static inline void print_usage()
@@ -86,6 +76,13 @@ static inline void print_usage()
     printf("      [-B, --signal_bus]\n");
     printf("      [-v, --verbose]\n");
     printf("      [-c, --csv=<csv_file>]\n");
+    printf("      [-C, --csv-compile=<bin_file>] (compile --csv and exit)\n");
+    printf("      [-M, --multi=<connection_file>] (<fmu_path> ...)\n");
+    printf("      [-T, --threads=<count>] (with --multi)\n");
+    printf("      [-R, --report=<json_file>]\n");
+    printf("      [-o, --output=<rec_file>] (record output variables)\n");
+    printf("      [-b, --output-binary] (also record binary sizes)\n");
+    printf("      [-D, --dump=<rec_file>] (print recording as CSV and exit)\n");
 }
 
 void _log(const char* format, ...)
@@ -99,35 +96,7 @@ void _log(const char* format, ...)
     fflush(stdout);
 }
 
-static void _apply_samples(CsvDesc* c, double simulation_time)
-{
-    if (c == NULL) return;
-
-    /* Apply value sets from CSV. */
-    while ((c->timestamp >= 0) && (c->timestamp <= simulation_time)) {
-        size_t idx = 0;
-        char*  _saveptr = NULL;
-        char*  _valueptr;
-        strtok_r(c->line, CSV_DELIMITER, &_saveptr);  // Consume the timestamp.
-        while ((_valueptr = strtok_r(NULL, CSV_DELIMITER, &_saveptr))) {
-            errno = 0;
-            double v = strtod(_valueptr, NULL);
-            if (errno == 0) {
-                double* signal = NULL;
-                vector_at(&c->index, idx, &signal);
-                if (signal) *signal = v;
-            } else {
-                _log("Error decoding sample [%f][%zu]", c->timestamp, idx);
-            }
-            /* Check limit. */
-            if (++idx >= vector_len(&c->index)) break;
-        }
-        /* Load the next line. */
-        if (csv_read_line(c) == false) break;
-    }
-}
-
-static void _fmu2_log(fmi2ComponentEnvironment componentEnvironment,
+void _fmu2_log(fmi2ComponentEnvironment componentEnvironment,
     fmi2String instanceName, fmi2Status status, fmi2String category,
     fmi2String message, ...)
 {
@@ -153,8 +122,112 @@ static void _fmu2_log(fmi2ComponentEnvironment componentEnvironment,
     }
 }
 
+static void _network_setup(modelDescription* desc)
+{
+    /* Resolve the network of each binary variable. */
+    for (size_t i = 0; i < desc->binary.tx_count; i++) {
+        BinaryData* info = desc->binary.tx_binary_info[i];
+        if (info && info->mime_type) {
+            info->network = network_open(info->mime_type);
+        }
+    }
+    for (size_t i = 0; i < desc->binary.rx_count; i++) {
+        BinaryData* info = desc->binary.rx_binary_info[i];
+        if (info && info->mime_type) {
+            info->network = network_open(info->mime_type);
+        }
+    }
+}
+
+static inline bool _native_binary(BinaryData* info, bool fmi3)
+{
+    /* FMI 3 Binary variables without a binary-to-text encoding. */
+    return fmi3 && info->encoding == NULL;
+}
+
+static void _network_loopback(modelDescription* desc, size_t step, bool fmi3)
+{
+    /* From FMU perspective: TX -> Bus (-> Rx). */
+    for (size_t i = 0; i < desc->binary.tx_count; i++) {
+        BinaryData* info = desc->binary.tx_binary_info[i];
+        if (info == NULL || info->network == NULL) continue;
+        if (desc->binary.val_tx_binary[i] == NULL) continue;
+
+        if (_native_binary(info, fmi3)) {
+            /* Push the FMU buffer (valid until the next fmi3GetBinary). */
+            network_push(info->network,
+                (const uint8_t*)desc->binary.val_tx_binary[i],
+                desc->binary.val_size_tx_binary[i]);
+        } else {
+            size_t data_len = strlen(desc->binary.val_tx_binary[i]);
+            char*  ncodec_tx =
+                dse_ascii85_decode(desc->binary.val_tx_binary[i], &data_len);
+            network_push(info->network, (uint8_t*)ncodec_tx, data_len);
+            free(ncodec_tx);
+        }
+        /* FMI 3 buffers are owned by the FMU, FMI 2 strings are duplicates. */
+        if (fmi3 == false) free(desc->binary.val_tx_binary[i]);
+        desc->binary.val_tx_binary[i] = NULL;
+    }
+    /* Inject a CAN Frame. */
+    if (desc->binary.tx_count && desc->binary.tx_binary_info[0] &&
+        desc->binary.tx_binary_info[0]->network &&
+        desc->binary.tx_binary_info[0]->type &&
+        strcmp(desc->binary.tx_binary_info[0]->type, "frame") == 0) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "Hello from Importer (%zu)", step + 1);
+        network_inject_frame(desc->binary.tx_binary_info[0]->network,
+            (42 + step * 10), (uint8_t*)msg, strlen(msg) + 1);
+    }
+    /* From FMU perspective: (TX ->) Bus -> Rx. */
+    for (size_t i = 0; i < desc->binary.rx_count; i++) {
+        BinaryData* info = desc->binary.rx_binary_info[i];
+        if (info == NULL || info->network == NULL) continue;
+
+        /* Pass (native) or encode directly from the network stream view. */
+        const uint8_t* stream = NULL;
+        size_t         data_len = 0;
+        network_pull(info->network, &stream, &data_len);
+        if (_native_binary(info, fmi3)) {
+            desc->binary.val_rx_binary[i] = (char*)stream;
+        } else {
+            desc->binary.val_rx_binary[i] =
+                dse_ascii85_encode((const char*)stream, data_len);
+            if (desc->binary.val_rx_binary[i]) {
+                data_len = strlen(desc->binary.val_rx_binary[i]);
+            }
+        }
+        if (desc->binary.val_size_rx_binary) {
+            desc->binary.val_size_rx_binary[i] = data_len;
+        }
+    }
+}
+
+static void _delta_index(HashMap* index, modelDescription* desc)
+{
+    hashmap_init(index);
+    for (size_t i = 0; i < desc->real.tx_count; i++) {
+        char key[HASHLIST_KEY_LEN];
+        snprintf(key, HASHLIST_KEY_LEN, "%u", desc->real.vr_tx_real[i]);
+        hashmap_set(index, key, &desc->real.val_tx_real[i]);
+    }
+}
+
+static void _delta_apply(HashMap* index, const unsigned int* vr,
+    const double* value, size_t count)
+{
+    /* Changed variables which are not outputs are ignored. */
+    for (size_t i = 0; i < count; i++) {
+        char key[HASHLIST_KEY_LEN];
+        snprintf(key, HASHLIST_KEY_LEN, "%u", vr[i]);
+        double* val = hashmap_get(index, key);
+        if (val) *val = value[i];
+    }
+}
+
 static int _run_fmu2_cosim(modelDescription* desc, void* handle,
-    double step_size, unsigned int steps, CsvDesc* csv)
+    double step_size, unsigned int steps, CsvDesc* csv, Report* report,
+    Recorder* recorder)
 {
     /* Setup the FMU
      * ============= */
@@ -209,7 +282,7 @@ static int _run_fmu2_cosim(modelDescription* desc, void* handle,
     fmi2GetString get_string = dlsym(handle, "fmi2GetString");
     if (get_string == NULL) return EINVAL;
 
-    _apply_samples(csv, model_time);
+    csv_apply(csv, model_time);
 
     fmi2SetReal set_real = dlsym(handle, "fmi2SetReal");
     if (set_real == NULL) return EINVAL;
@@ -220,52 +293,19 @@ static int _run_fmu2_cosim(modelDescription* desc, void* handle,
     fmi2DoStep do_step = dlsym(handle, "fmi2DoStep");
     if (do_step == NULL) return EINVAL;
 
+    /* Delta query extension (optional), get only the changed outputs. */
+    dseGetChanged get_changed = dlsym(handle, "dseGetChangedReal");
+    HashMap       tx_index;
+    _delta_index(&tx_index, desc);
+    if (get_changed) _log("Scalar Variables: using dseGetChangedReal()");
+
+    _network_setup(desc);
     for (size_t step = 0; step < steps; step++) {
+        uint64_t t = report_step_begin(report);
         network_truncate();
 
-        /* Loopback the binary data. */
-        /* From FMU perspective: TX -> Bus (-> Rx). */
-        for (size_t i = 0; i < desc->binary.tx_count; i++) {
-            if (desc->binary.tx_binary_info == NULL) continue;
-            if (desc->binary.tx_binary_info[i] == NULL) continue;
-            if (desc->binary.tx_binary_info[i]->mime_type == NULL) continue;
-            if (desc->binary.val_tx_binary[i] == NULL) continue;
-            size_t data_len = strlen(desc->binary.val_tx_binary[i]);
-            char*  ncodec_tx =
-                dse_ascii85_decode(desc->binary.val_tx_binary[i], &data_len);
-            free(desc->binary.val_tx_binary[i]);
-            desc->binary.val_tx_binary[i] = NULL;
-
-            network_push(
-                "one_network",  // TODO: Currently only one network signal.
-                desc->binary.tx_binary_info[i]->mime_type, (uint8_t*)ncodec_tx,
-                data_len);
-            free(ncodec_tx);
-        }
-        /* Inject a CAN Frame. */
-        if (desc->binary.tx_binary_info && desc->binary.tx_binary_info[0] &&
-            desc->binary.tx_binary_info[0]->mime_type &&
-            strcmp(desc->binary.tx_binary_info[0]->type, "frame") == 0) {
-            char msg[128];
-            snprintf(msg, sizeof(msg), "Hello from Importer (%zu)", step + 1);
-            network_inject_frame("one_network",
-                desc->binary.tx_binary_info[0]->mime_type, (42 + step * 10),
-                (uint8_t*)msg, strlen(msg) + 1);
-        }
-        /* From FMU perspective: (TX ->) Bus -> Rx. */
-        for (size_t i = 0; i < desc->binary.rx_count; i++) {
-            if (desc->binary.rx_binary_info == NULL) continue;
-            if (desc->binary.rx_binary_info[i]->mime_type == NULL) continue;
-
-            size_t data_len = 0;
-            char*  ncodec_rx = NULL;
-            network_pull("one_network",
-                desc->binary.rx_binary_info[i]->mime_type,
-                (uint8_t**)&ncodec_rx, &data_len);
-            desc->binary.val_rx_binary[i] =
-                dse_ascii85_encode(ncodec_rx, data_len);
-            free(ncodec_rx);
-        }
+        _network_loopback(desc, step, false);
+        t = report_phase(report, ReportPhaseNetwork, t);
 
         set_string(fmu, desc->binary.vr_rx_binary, desc->binary.rx_count,
             desc->binary.val_rx_binary);
@@ -276,21 +316,35 @@ static int _run_fmu2_cosim(modelDescription* desc, void* handle,
                 desc->binary.val_rx_binary[i] = NULL;
             }
         }
+        t = report_phase(report, ReportPhaseSetString, t);
         set_real(fmu, desc->real.vr_rx_real, desc->real.rx_count,
             desc->real.val_rx_real);
+        t = report_phase(report, ReportPhaseSetReal, t);
 
         if (__verbose__) {
             _log("Calling fmi2DoStep(): model_time=%f, step_size=%f",
                 model_time, step_size);
+            t = report_now(report);
         }
         int rc = do_step(fmu, model_time, step_size);
+        t = report_phase(report, ReportPhaseDoStep, t);
         if (rc != 0) {
             _log("step() returned error code: %d", rc);
+            t = report_now(report);
         }
 
         /* Read from FMU. */
-        get_real(fmu, desc->real.vr_tx_real, desc->real.tx_count,
-            desc->real.val_tx_real);
+        if (get_changed) {
+            const unsigned int* vr = NULL;
+            const double*       value = NULL;
+            size_t              count = 0;
+            get_changed(fmu, &vr, &value, &count);
+            _delta_apply(&tx_index, vr, value, count);
+        } else {
+            get_real(fmu, desc->real.vr_tx_real, desc->real.tx_count,
+                desc->real.val_tx_real);
+        }
+        t = report_phase(report, ReportPhaseGetReal, t);
         get_string(fmu, desc->binary.vr_tx_binary, desc->binary.tx_count,
             desc->binary.val_tx_binary);
         for (size_t i = 0; i < desc->binary.tx_count; i++) {
@@ -300,13 +354,18 @@ static int _run_fmu2_cosim(modelDescription* desc, void* handle,
                     strdup(desc->binary.val_tx_binary[i]);
             }
         }
+        report_phase(report, ReportPhaseGetString, t);
 
         /* Increment model time. */
         model_time += step_size;
+        recorder_append(recorder, model_time);
 
-        _apply_samples(csv, model_time);
+        csv_apply(csv, model_time);
+        report_step_end(report);
     }
     network_close();
+    hashmap_destroy(&tx_index);
+    report_log(report);
 
     if (desc->real.tx_count <= 50 || __verbose__) {
         _log("Scalar Variables (RX):");
@@ -337,7 +396,7 @@ static int _run_fmu2_cosim(modelDescription* desc, void* handle,
 }
 
 
-static void _fmu3_log(fmi3InstanceEnvironment instanceEnvironment,
+void _fmu3_log(fmi3InstanceEnvironment instanceEnvironment,
     fmi3Status status, fmi3String category, fmi3String message)
 {
     UNUSED(instanceEnvironment);
@@ -361,7 +420,8 @@ static void _fmu3_log(fmi3InstanceEnvironment instanceEnvironment,
 }
 
 static int _run_fmu3_cosim(modelDescription* desc, void* handle,
-    double step_size, unsigned int steps, CsvDesc* csv)
+    double step_size, unsigned int steps, CsvDesc* csv, Report* report,
+    Recorder* recorder)
 {
     /* Setup the FMU
      * ============= */
@@ -371,7 +431,7 @@ static int _run_fmu3_cosim(modelDescription* desc, void* handle,
     fmi3InstantiateCoSimulation instantiate =
         dlsym(handle, "fmi3InstantiateCoSimulation");
     if (instantiate == NULL) return EINVAL;
-    fmu = instantiate("fmu", "guid", "resources", false, true, false, false,
+    fmu = instantiate("fmu", "guid", "resources", false, true, false, true,
         NULL, 0, NULL, &_fmu3_log, NULL);
     if (fmu == NULL) return EINVAL;
 
@@ -397,7 +457,7 @@ static int _run_fmu3_cosim(modelDescription* desc, void* handle,
     fmi3GetBinary get_binary = dlsym(handle, "fmi3GetBinary");
     if (get_binary == NULL) return EINVAL;
 
-    _apply_samples(csv, model_time);
+    csv_apply(csv, model_time);
 
     fmi3SetFloat64 set_float64 = dlsym(handle, "fmi3SetFloat64");
     if (set_float64 == NULL) return EINVAL;
@@ -408,96 +468,92 @@ static int _run_fmu3_cosim(modelDescription* desc, void* handle,
     fmi3DoStep do_step = dlsym(handle, "fmi3DoStep");
     if (do_step == NULL) return EINVAL;
 
+    /* Delta query extension (optional), get only the changed outputs. */
+    dseGetChanged get_changed = dlsym(handle, "dseGetChangedFloat64");
+    HashMap       tx_index;
+    _delta_index(&tx_index, desc);
+    if (get_changed) _log("Scalar Variables: using dseGetChangedFloat64()");
+
+    _network_setup(desc);
     for (size_t step = 0; step < steps; step++) {
+        uint64_t t = report_step_begin(report);
         network_truncate();
 
-        /* Loopback the binary data. */
-        /* From FMU perspective: TX -> Bus (-> Rx). */
-        for (size_t i = 0; i < desc->binary.tx_count; i++) {
-            if (desc->binary.tx_binary_info == NULL) continue;
-            if (desc->binary.tx_binary_info[i] == NULL) continue;
-            if (desc->binary.tx_binary_info[i]->mime_type == NULL) continue;
-            if (desc->binary.val_tx_binary[i] == NULL) continue;
-
-            size_t data_len = strlen(desc->binary.val_tx_binary[i]);
-            char*  ncodec_tx =
-                dse_ascii85_decode(desc->binary.val_tx_binary[i], &data_len);
-            free(desc->binary.val_tx_binary[i]);
-            desc->binary.val_tx_binary[i] = NULL;
-
-            network_push(
-                "one_network",  // TODO: Currently only one network signal.
-                desc->binary.tx_binary_info[i]->mime_type, (uint8_t*)ncodec_tx,
-                data_len);
-            free(ncodec_tx);
-        }
-        /* Inject a CAN Frame. */
-        if (desc->binary.tx_binary_info && desc->binary.tx_binary_info[0] &&
-            desc->binary.tx_binary_info[0]->mime_type &&
-            strcmp(desc->binary.tx_binary_info[0]->type, "frame") == 0) {
-            char msg[128];
-            snprintf(msg, sizeof(msg), "Hello from Importer (%zu)", step + 1);
-            network_inject_frame("one_network",
-                desc->binary.tx_binary_info[0]->mime_type, (42 + step * 10),
-                (uint8_t*)msg, strlen(msg) + 1);
-        }
-        /* From FMU perspective: (TX ->) Bus -> Rx. */
-        for (size_t i = 0; i < desc->binary.rx_count; i++) {
-            if (desc->binary.rx_binary_info == NULL) continue;
-            if (desc->binary.rx_binary_info[i]->mime_type == NULL) continue;
-
-            size_t data_len = 0;
-            char*  ncodec_rx = NULL;
-            network_pull("one_network",
-                desc->binary.rx_binary_info[i]->mime_type,
-                (uint8_t**)&ncodec_rx, &data_len);
-            desc->binary.val_rx_binary[i] =
-                dse_ascii85_encode(ncodec_rx, data_len);
-            free(ncodec_rx);
-        }
+        _network_loopback(desc, step, true);
+        t = report_phase(report, ReportPhaseNetwork, t);
 
         set_binary(fmu, desc->binary.vr_rx_binary, desc->binary.rx_count,
             desc->binary.val_size_rx_binary, desc->binary.val_rx_binary,
             desc->binary.rx_count);
         for (size_t i = 0; i < desc->binary.rx_count; i++) {
-            /* Release the string (FMU should have duplicated). */
-            if (desc->binary.val_rx_binary[i]) {
+            /* Release the encoded string (FMU should have duplicated), native
+             * values are a view of the network stream. */
+            BinaryData* info = desc->binary.rx_binary_info[i];
+            if (desc->binary.val_rx_binary[i] && info &&
+                !_native_binary(info, true)) {
                 free(desc->binary.val_rx_binary[i]);
-                desc->binary.val_rx_binary[i] = NULL;
             }
+            desc->binary.val_rx_binary[i] = NULL;
         }
+        t = report_phase(report, ReportPhaseSetString, t);
         set_float64(fmu, desc->real.vr_rx_real, desc->real.rx_count,
             desc->real.val_rx_real, desc->real.rx_count);
+        t = report_phase(report, ReportPhaseSetReal, t);
 
         if (__verbose__) {
             _log("Calling fmi3DoStep(): model_time=%f, step_size=%f",
                 model_time, step_size);
+            t = report_now(report);
         }
-        int rc = do_step(fmu, model_time, step_size);
+        bool   event_handling_needed = false;
+        bool   terminate_simulation = false;
+        bool   early_return = false;
+        double last_successful_time = model_time + step_size;
+        int    rc = do_step(fmu, model_time, step_size, false,
+               &event_handling_needed, &terminate_simulation, &early_return,
+               &last_successful_time);
+        t = report_phase(report, ReportPhaseDoStep, t);
         if (rc != 0) {
             _log("step() returned error code: %d", rc);
+            t = report_now(report);
         }
 
         /* Read from FMU. */
-        get_float64(fmu, desc->real.vr_tx_real, desc->real.tx_count,
-            desc->real.val_tx_real, desc->real.tx_count);
+        if (get_changed) {
+            const unsigned int* vr = NULL;
+            const double*       value = NULL;
+            size_t              count = 0;
+            get_changed(fmu, &vr, &value, &count);
+            _delta_apply(&tx_index, vr, value, count);
+        } else {
+            get_float64(fmu, desc->real.vr_tx_real, desc->real.tx_count,
+                desc->real.val_tx_real, desc->real.tx_count);
+        }
+        t = report_phase(report, ReportPhaseGetReal, t);
         get_binary(fmu, desc->binary.vr_tx_binary, desc->binary.tx_count,
             desc->binary.val_size_tx_binary, desc->binary.val_tx_binary,
             desc->binary.tx_count);
-        for (size_t i = 0; i < desc->binary.tx_count; i++) {
-            /* Duplicate received strings (in-case FMU releases). */
-            if (desc->binary.val_tx_binary[i]) {
-                desc->binary.val_tx_binary[i] =
-                    strdup(desc->binary.val_tx_binary[i]);
+        /* Binary values remain valid (FMU owned) until the next call. */
+        report_phase(report, ReportPhaseGetString, t);
+
+        /* Increment model time (to the early return time, if requested). */
+        if (early_return) {
+            if (__verbose__) {
+                _log("Early return: last_successful_time=%f",
+                    last_successful_time);
             }
+            model_time = last_successful_time;
+        } else {
+            model_time += step_size;
         }
+        recorder_append(recorder, model_time);
 
-        /* Increment model time. */
-        model_time += step_size;
-
-        _apply_samples(csv, model_time);
+        csv_apply(csv, model_time);
+        report_step_end(report);
     }
     network_close();
+    hashmap_destroy(&tx_index);
+    report_log(report);
 
     if (desc->real.tx_count <= 50 || __verbose__) {
         _log("Scalar Variables:");
@@ -507,10 +563,22 @@ static int _run_fmu3_cosim(modelDescription* desc, void* handle,
         }
         _log("String Variables:");
         for (size_t i = 0; i < desc->binary.tx_count; i++) {
-            _log("  [%d] %s", desc->binary.vr_tx_binary[i],
-                desc->binary.val_tx_binary[i]);
+            if (desc->binary.tx_binary_info[i] &&
+                _native_binary(desc->binary.tx_binary_info[i], true)) {
+                _log("  [%d] (%zu bytes)", desc->binary.vr_tx_binary[i],
+                    desc->binary.val_tx_binary[i]
+                        ? desc->binary.val_size_tx_binary[i]
+                        : 0);
+            } else {
+                _log("  [%d] %s", desc->binary.vr_tx_binary[i],
+                    desc->binary.val_tx_binary[i]);
+            }
         }
     }
+    /* Binary values are owned by the FMU. */
+    for (size_t i = 0; i < desc->binary.tx_count; i++) {
+        desc->binary.val_tx_binary[i] = NULL;
+    }
 
 
     /* Terminate/Free the FMU
@@ -525,7 +593,10 @@ static int _run_fmu3_cosim(modelDescription* desc, void* handle,
 
 static inline void _parse_arguments(int argc, char** argv, double* step_size,
     unsigned int* steps, const char** fmu_path, const char** platform,
-    bool* signal_bus, const char** csv_path)
+    bool* signal_bus, const char** csv_path, const char** csv_compile_path,
+    const char** multi_path, const char** report_path, unsigned int* threads,
+    const char** output_path, bool* output_binary, const char** dump_path,
+    const char*** fmu_paths, size_t* fmu_count)
 {
     extern int   optind, optopt;
     extern char* optarg;
@@ -566,6 +637,27 @@ static inline void _parse_arguments(int argc, char** argv, double* step_size,
         case 'c':
             *csv_path = optarg;
             break;
+        case 'C':
+            *csv_compile_path = optarg;
+            break;
+        case 'M':
+            *multi_path = optarg;
+            break;
+        case 'T':
+            if (optarg) *threads = atoi(optarg);
+            break;
+        case 'R':
+            *report_path = optarg;
+            break;
+        case 'o':
+            *output_path = optarg;
+            break;
+        case 'b':
+            *output_binary = true;
+            break;
+        case 'D':
+            *dump_path = optarg;
+            break;
         default:
             exit(1);
         }
@@ -575,6 +667,8 @@ static inline void _parse_arguments(int argc, char** argv, double* step_size,
     if ((optind + 1) <= argc) {
         *fmu_path = argv[optind];
     }
+    *fmu_paths = (const char**)&argv[optind];
+    *fmu_count = argc - optind;
 }
 
 extern bool signal_bus_enabled;
@@ -586,15 +680,55 @@ int main(int argc, char** argv)
     const char*  fmu_path = NULL;
     const char*  platform = "linux-amd64";
     const char*  csv_path = NULL;
+    const char*  csv_compile_path = NULL;
+    const char*  multi_path = NULL;
+    const char*  report_path = NULL;
+    const char*  output_path = NULL;
+    bool         output_binary = false;
+    const char*  dump_path = NULL;
+    unsigned int threads = 0;
+    const char** fmu_paths = NULL;
+    size_t       fmu_count = 0;
 
     static char _cwd[PATH_MAX];
+    static char _report_path[PATH_MAX];
+    static char _output_path[PATH_MAX];
 
 
     /* Parse arguments
      * =============== */
     _parse_arguments(argc, argv, &step_size, &steps, &fmu_path, &platform,
-        &signal_bus_enabled, &csv_path);
+        &signal_bus_enabled, &csv_path, &csv_compile_path, &multi_path,
+        &report_path, &threads, &output_path, &output_binary, &dump_path,
+        &fmu_paths, &fmu_count);
+    if (dump_path) {
+        return recorder_dump(dump_path, stdout);
+    }
+    if (csv_compile_path) {
+        _log("Compile CSV: %s -> %s", csv_path, csv_compile_path);
+        if (csv_path == NULL) return EINVAL;
+        return csv_compile(csv_path, csv_compile_path);
+    }
+    if (multi_path) {
+        _log("Step Size: %f", step_size);
+        _log("Steps: %u", steps);
+        _log("Connections: %s", multi_path);
+        _log("Platform: %s", platform);
+        int rc = multi_run(fmu_paths, fmu_count, multi_path, platform,
+            step_size, steps, threads);
+        _log("Simulation return value: %d", rc);
+        return rc;
+    }
     getcwd(_cwd, PATH_MAX);
+    if (report_path && report_path[0] != '/') {
+        /* Relative to the working directory (i.e. not the FMU path). */
+        snprintf(_report_path, PATH_MAX, "%s/%s", _cwd, report_path);
+        report_path = _report_path;
+    }
+    if (output_path && output_path[0] != '/') {
+        snprintf(_output_path, PATH_MAX, "%s/%s", _cwd, output_path);
+        output_path = _output_path;
+    }
     if (fmu_path == NULL) {
         fmu_path = _cwd;
     }
@@ -637,62 +771,38 @@ int main(int argc, char** argv)
 
     /* Run a CoSimulation
      * ================== */
-    int rc = 0;
+    int       rc = 0;
+    Report*   report = report_create();
+    Recorder* recorder = NULL;
+    if (output_path) {
+        recorder = recorder_open(
+            output_path, desc, atoi(desc->version) == 3, output_binary);
+        if (recorder == NULL) return EINVAL;
+    }
     switch (atoi(desc->version)) {
     case 2:
-        rc = _run_fmu2_cosim(desc, handle, step_size, steps, csv);
+        rc = _run_fmu2_cosim(
+            desc, handle, step_size, steps, csv, report, recorder);
         break;
     case 3:
-        rc = _run_fmu3_cosim(desc, handle, step_size, steps, csv);
+        rc = _run_fmu3_cosim(
+            desc, handle, step_size, steps, csv, report, recorder);
         break;
     default:
         _log("Unsupported FMI version (%s)!", desc->version);
         return EINVAL;
     }
     _log("Simulation return value: %d", rc);
+    if (recorder_close(recorder) && rc == 0) rc = EIO;
+    if (report_path) {
+        report_write_json(
+            report, report_path, _cwd, atoi(desc->version), step_size);
+    }
+    report_destroy(report);
 
     /* Release allocated resources
      * =========================== */
-    free(desc->version);
-    free(desc->fmu_lib_path);
-    for (size_t i = 0; i < desc->binary.tx_count; i++) {
-        if (desc->binary.val_tx_binary[i]) {
-            free(desc->binary.val_tx_binary[i]);
-            desc->binary.val_tx_binary[i] = NULL;
-        }
-        if (desc->binary.tx_binary_info[i]) {
-            free(desc->binary.tx_binary_info[i]->mime_type);
-            free(desc->binary.tx_binary_info[i]->start);
-            free(desc->binary.tx_binary_info[i]->type);
-            free(desc->binary.tx_binary_info[i]);
-        }
-    }
-    for (size_t i = 0; i < desc->binary.rx_count; i++) {
-        if (desc->binary.val_rx_binary[i]) {
-            free(desc->binary.val_rx_binary[i]);
-            desc->binary.val_rx_binary[i] = NULL;
-        }
-        if (desc->binary.rx_binary_info[i]) {
-            free(desc->binary.rx_binary_info[i]->mime_type);
-            free(desc->binary.rx_binary_info[i]->start);
-            free(desc->binary.rx_binary_info[i]->type);
-            free(desc->binary.rx_binary_info[i]);
-        }
-    }
-    free(desc->binary.rx_binary_info);
-    free(desc->binary.tx_binary_info);
-
-    free(desc->binary.vr_tx_binary);
-    free(desc->binary.val_tx_binary);
-    free(desc->binary.val_size_tx_binary);
-    free(desc->binary.vr_rx_binary);
-    free(desc->binary.val_rx_binary);
-    free(desc->binary.val_size_rx_binary);
-    free(desc->real.vr_tx_real);
-    free(desc->real.val_tx_real);
-    free(desc->real.vr_rx_real);
-    free(desc->real.val_rx_real);
-    free(desc);
+    free_model_desc(desc);
 
     dlclose(handle);
     csv_close(csv);
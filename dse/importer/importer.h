@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <dse/clib/collections/vector.h>
 #include <dse/ncodec/codec.h>
 
@@ -41,10 +42,44 @@ center footer Dynamic Simulation Environment
 */
 
 
+/* Define types for the FMI 2 inteface methods being used. */
+typedef void* (*fmi2Instantiate)();
+typedef int32_t (*fmi2SetDebugLogging)();
+typedef int32_t (*fmi2ExitInitializationMode)();
+typedef int32_t (*fmi2GetReal)();
+typedef int32_t (*fmi2GetString)();
+typedef int32_t (*fmi2SetReal)();
+typedef int32_t (*fmi2SetString)();
+typedef int32_t (*fmi2DoStep)();
+typedef void (*fmi2FreeInstance)();
+
+
+/* Define types for the FMI 3 inteface methods being used. */
+typedef void* (*fmi3InstantiateCoSimulation)();
+typedef int32_t (*fmi3ExitInitializationMode)();
+typedef int32_t (*fmi3GetFloat64)();
+typedef int32_t (*fmi3GetBinary)();
+typedef int32_t (*fmi3SetFloat64)();
+typedef int32_t (*fmi3SetBinary)();
+typedef int32_t (*fmi3DoStep)();
+typedef void (*fmi3FreeInstance)();
+
+
+/* Define types for the FMU extension methods being used (optional). */
+typedef int32_t (*dseGetChanged)();
+
+
+typedef struct NetworkSignal NetworkSignal;
+
+
 typedef struct BinaryData {
     char* start;
     char* mime_type;
     char* type;
+    char* encoding; /* Binary-to-text encoding (FMI 3), NULL if none. */
+
+    /* Resolved at setup (see network_open). */
+    NetworkSignal* network;
 } BinaryData;
 
 
@@ -80,30 +115,114 @@ typedef struct modelDescription {
 } modelDescription;
 
 
+#define CSV_BIN_MAGIC "DSECSVB1"
+
+typedef struct CsvBinHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t columns;
+    uint64_t rows;
+} CsvBinHeader;
+
+
 typedef struct CsvDesc {
-    FILE*  file;
-    char*  line;
-    double timestamp;
-    Vector index; /* vector_at[idx] -> *double */
+    char*       data; /* File content (mapped). */
+    size_t      size;
+    bool        mapped;
+    const char* pos; /* Start of the next line. */
+    const char* end;
+    const char* line; /* Current line: [line, line_end). */
+    const char* line_end;
+    double      timestamp;
+    Vector      index; /* vector_at[idx] -> *double */
+
+    /* Compiled stimulus (see csv_compile). */
+    struct {
+        const CsvBinHeader* header;
+        const uint32_t*     vr;
+        const double*       timestamp;
+        const double*       value; /* value[column * rows + row] */
+        const uint8_t*      set;   /* set[column * rows + row] */
+        uint64_t            row;
+        uint64_t            next;
+    } bin;
 } CsvDesc;
 
 
-#define CSV_LINE_MAXLEN 1024
-#define CSV_DELIMITER   ",;\n"
+typedef struct MultiFmu {
+    char*             path; /* Absolute path of the FMU directory. */
+    modelDescription* desc;
+    void*             handle;
+    void*             instance;
+    int               version;
+
+    /* FMI interface (FMI 2 or FMI 3, see version). */
+    int32_t (*set_real)();
+    int32_t (*get_real)();
+    int32_t (*do_step)();
+    void (*free_instance)();
+} MultiFmu;
+
+
+typedef struct MultiConnection {
+    double* src; /* Output value (val_tx_real) of the source FMU. */
+    double* dst; /* Input value (val_rx_real) of the destination FMU. */
+} MultiConnection;
+
+
+typedef enum {
+    ReportPhaseNetwork,
+    ReportPhaseSetString,
+    ReportPhaseSetReal,
+    ReportPhaseDoStep,
+    ReportPhaseGetReal,
+    ReportPhaseGetString,
+    ReportPhaseCount,
+} ReportPhase;
+
+
+#define REPORT_HIST_SUB_BITS    4
+#define REPORT_HIST_SUB_BUCKETS (1u << REPORT_HIST_SUB_BITS)
+#define REPORT_HIST_BUCKETS     (64u << REPORT_HIST_SUB_BITS)
+
+typedef struct ReportHistogram {
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint64_t bucket[REPORT_HIST_BUCKETS];
+} ReportHistogram;
+
+
+typedef struct Recorder Recorder;
+
+
+typedef struct Report {
+    ReportHistogram phase[ReportPhaseCount];
+    ReportHistogram step;
+    uint64_t        steps;
+    uint64_t        allocs;
+    uint64_t        start_ns;
+    uint64_t        end_ns;
+
+    /* Current step. */
+    uint64_t step_ns;
+    uint64_t step_allocs;
+} Report;
 
 
 /* xml.c */
 DLL_PRIVATE modelDescription* parse_model_desc(
     const char* docname, const char* platform);
+DLL_PRIVATE void              free_model_desc(modelDescription* desc);
 
 /* signal_bus.c */
 char* network_mime_type_value(const char* mime_type, const char* key);
-void  network_inject_frame(const char* name, const char* mime_type, int32_t id,
-     uint8_t* data, size_t len);
-void  network_push(
-     const char* name, const char* mime_type, const uint8_t* buffer, size_t len);
-void network_pull(
-    const char* name, const char* mime_type, uint8_t** buffer, size_t* len);
+NetworkSignal* network_open(const char* mime_type);
+void           network_inject_frame(
+              NetworkSignal* ns, int32_t id, uint8_t* data, size_t len);
+void network_push(NetworkSignal* ns, const uint8_t* buffer, size_t len);
+void network_pull(NetworkSignal* ns, const uint8_t** buffer, size_t* len);
 void network_truncate(void);
 void network_close(void);
 
@@ -111,7 +230,35 @@ void network_close(void);
 CsvDesc* csv_open(const char* path);
 void csv_index(CsvDesc* c, unsigned int* rx_vr, double* rx_real, size_t count);
 bool csv_read_line(CsvDesc* c);
+void csv_apply(CsvDesc* c, double simulation_time);
 void csv_close(CsvDesc* c);
+int  csv_compile(const char* path, const char* out_path);
+
+/* alloc_count.c */
+bool importer_alloc_count(uint64_t* count);
+
+/* report.c */
+Report*  report_create(void);
+uint64_t report_now(Report* r);
+uint64_t report_step_begin(Report* r);
+uint64_t report_phase(Report* r, ReportPhase phase, uint64_t t0);
+void     report_step_end(Report* r);
+void     report_log(Report* r);
+int      report_write_json(Report* r, const char* path, const char* fmu_path,
+         int fmi_version, double step_size);
+void     report_destroy(Report* r);
+
+/* recorder.c */
+Recorder* recorder_open(
+    const char* path, modelDescription* desc, bool fmi3, bool binary);
+void recorder_append(Recorder* r, double model_time);
+int  recorder_close(Recorder* r);
+int  recorder_dump(const char* path, FILE* out);
+
+/* multi.c */
+int multi_run(const char** fmu_paths, size_t fmu_count,
+    const char* connection_path, const char* platform, double step_size,
+    unsigned int steps, unsigned int threads);
 
 
 #endif  // DSE_IMPORTER_IMPORTER_H_
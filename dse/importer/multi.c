@@ -0,0 +1,487 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <dlfcn.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fmi2FunctionTypes.h>
+#include <fmi3FunctionTypes.h>
+#include <dse/importer/importer.h>
+
+
+/**
+Multi-FMU Co-Simulation
+=======================
+
+Operates a list of FMUs in a Jacobi co-simulation scheme. At the start of each
+step the outputs of all FMUs (from the previous step) are copied to the
+connected inputs, then all FMUs are stepped in parallel by a pool of worker
+threads. A barrier completes the step.
+
+Connections are listed in a text file, one connection per line:
+
+```text
+# from_fmu,from_vr,to_fmu,to_vr
+0,1,1,1
+0,1,1,2
+```
+
+where `from_fmu`/`to_fmu` is the (0 based) position of the FMU in the list
+of FMUs given to the importer. Only scalar (Real/Float64) variables are
+connected.
+
+*/
+
+
+#define MODEL_XML_FILE   "modelDescription.xml"
+#define CONN_LINE_MAXLEN 256
+
+
+extern uint8_t __verbose__;
+extern void    _log(const char* format, ...);
+extern void    _fmu2_log(fmi2ComponentEnvironment componentEnvironment,
+       fmi2String instanceName, fmi2Status status, fmi2String category,
+       fmi2String message, ...);
+extern void    _fmu3_log(fmi3InstanceEnvironment instanceEnvironment,
+       fmi3Status status, fmi3String category, fmi3String message);
+
+
+static const fmi2CallbackFunctions _fmu2_functions = {
+    .logger = _fmu2_log,
+};
+
+
+typedef struct MultiRun MultiRun;
+
+typedef struct MultiWorker {
+    pthread_t thread;
+    MultiRun* run;
+    size_t    index;
+    double    busy; /* Time spent stepping FMUs (current step). */
+    double    wait; /* Accumulated barrier wait time. */
+} MultiWorker;
+
+typedef struct MultiRun {
+    MultiFmu*        fmu;
+    size_t           fmu_count;
+    MultiConnection* conn;
+    size_t           conn_count;
+    MultiWorker*     worker;
+    size_t           worker_count;
+
+    pthread_mutex_t   gate; /* Held while the worker pool is started. */
+    pthread_barrier_t start;
+    pthread_barrier_t end;
+    double            model_time;
+    double            step_size;
+    bool              stop;
+} MultiRun;
+
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+
+static int _load_fmu(MultiFmu* f, size_t index, const char* path,
+    const char* platform, const char* cwd)
+{
+    char dir[PATH_MAX];
+    char name[32];
+    char resources[PATH_MAX + 16];
+
+    /* Model Description and library paths are relative to the FMU. */
+    if (chdir(path)) {
+        _log("ERROR: Could not change to FMU path: %s", path);
+        return ENOENT;
+    }
+    if (getcwd(dir, PATH_MAX) == NULL) return errno;
+    f->path = strdup(dir);
+    f->desc = parse_model_desc(MODEL_XML_FILE, platform);
+    if (f->desc) {
+        dlerror();
+        f->handle = dlopen(f->desc->fmu_lib_path, RTLD_NOW | RTLD_LOCAL);
+        if (f->handle == NULL) {
+            _log("ERROR: dlopen call failed: %s", dlerror());
+        }
+    }
+    if (chdir(cwd)) return errno;
+    if (f->desc == NULL) {
+        _log("ERROR: Could not parse the model correctly! (%s)", f->path);
+        return EINVAL;
+    }
+    if (f->handle == NULL) return ENOSYS;
+
+    f->version = atoi(f->desc->version);
+    _log("FMU [%zu]: %s (FMI %d)", index, f->path, f->version);
+    _log("  Scalar Variables: Input %lu, Output %lu", f->desc->real.rx_count,
+        f->desc->real.tx_count);
+
+    /* Instantiate with an absolute resource location. */
+    snprintf(name, sizeof(name), "fmu%zu", index);
+    snprintf(resources, sizeof(resources), "%s/resources", f->path);
+    switch (f->version) {
+    case 2: {
+        fmi2Instantiate instantiate = dlsym(f->handle, "fmi2Instantiate");
+        fmi2ExitInitializationMode exit_init_mode =
+            dlsym(f->handle, "fmi2ExitInitializationMode");
+        f->set_real = dlsym(f->handle, "fmi2SetReal");
+        f->get_real = dlsym(f->handle, "fmi2GetReal");
+        f->do_step = dlsym(f->handle, "fmi2DoStep");
+        f->free_instance = dlsym(f->handle, "fmi2FreeInstance");
+        if (instantiate == NULL || exit_init_mode == NULL) return EINVAL;
+        f->instance = instantiate(name, fmi2CoSimulation, "guid", resources,
+            &_fmu2_functions, true, true);
+        if (f->instance == NULL) return EINVAL;
+        exit_init_mode(f->instance);
+        break;
+    }
+    case 3: {
+        fmi3InstantiateCoSimulation instantiate =
+            dlsym(f->handle, "fmi3InstantiateCoSimulation");
+        fmi3ExitInitializationMode exit_init_mode =
+            dlsym(f->handle, "fmi3ExitInitializationMode");
+        f->set_real = dlsym(f->handle, "fmi3SetFloat64");
+        f->get_real = dlsym(f->handle, "fmi3GetFloat64");
+        f->do_step = dlsym(f->handle, "fmi3DoStep");
+        f->free_instance = dlsym(f->handle, "fmi3FreeInstance");
+        if (instantiate == NULL || exit_init_mode == NULL) return EINVAL;
+        f->instance = instantiate(name, "guid", resources, false, true, false,
+            false, NULL, 0, NULL, &_fmu3_log, NULL);
+        if (f->instance == NULL) return EINVAL;
+        exit_init_mode(f->instance);
+        break;
+    }
+    default:
+        _log("Unsupported FMI version (%s)!", f->desc->version);
+        return EINVAL;
+    }
+    if (f->set_real == NULL || f->get_real == NULL || f->do_step == NULL ||
+        f->free_instance == NULL) {
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+
+static void _unload_fmu(MultiFmu* f)
+{
+    if (f->instance && f->free_instance) f->free_instance(f->instance);
+    f->instance = NULL;
+    if (f->handle) dlclose(f->handle);
+    f->handle = NULL;
+    free_model_desc(f->desc);
+    f->desc = NULL;
+    free(f->path);
+    f->path = NULL;
+}
+
+
+static double* _find_vr(
+    MultiRun* r, unsigned int fmu, unsigned int vr, bool input)
+{
+    if (fmu >= r->fmu_count) return NULL;
+    modelDescription* desc = r->fmu[fmu].desc;
+
+    unsigned int* vrs = input ? desc->real.vr_rx_real : desc->real.vr_tx_real;
+    double* vals = input ? desc->real.val_rx_real : desc->real.val_tx_real;
+    size_t  count = input ? desc->real.rx_count : desc->real.tx_count;
+    for (size_t i = 0; i < count; i++) {
+        if (vrs[i] == vr) return &vals[i];
+    }
+    return NULL;
+}
+
+
+static int _load_connections(MultiRun* r, const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        _log("ERROR: Could not open connection file: %s", path);
+        return ENOENT;
+    }
+
+    Vector conn = vector_make(sizeof(MultiConnection), 0, NULL);
+    char   line[CONN_LINE_MAXLEN];
+    size_t lineno = 0;
+    int    rc = 0;
+    while (fgets(line, sizeof(line), file)) {
+        lineno++;
+        char* p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        unsigned int from_fmu, from_vr, to_fmu, to_vr;
+        if (sscanf(p, "%u , %u , %u , %u", &from_fmu, &from_vr, &to_fmu,
+                &to_vr) != 4) {
+            _log("ERROR: Bad connection (line %zu): %s", lineno, p);
+            rc = EINVAL;
+            break;
+        }
+        MultiConnection c = {
+            .src = _find_vr(r, from_fmu, from_vr, false),
+            .dst = _find_vr(r, to_fmu, to_vr, true),
+        };
+        if (c.src == NULL || c.dst == NULL) {
+            _log("ERROR: Connection VR not found (line %zu): %u:%u -> %u:%u",
+                lineno, from_fmu, from_vr, to_fmu, to_vr);
+            rc = EINVAL;
+            break;
+        }
+        vector_push(&conn, &c);
+    }
+    fclose(file);
+
+    if (rc == 0) {
+        r->conn_count = vector_len(&conn);
+        r->conn = calloc(r->conn_count + 1, sizeof(MultiConnection));
+        for (size_t i = 0; i < r->conn_count; i++) {
+            vector_at(&conn, i, &r->conn[i]);
+        }
+        _log("Connections: %zu", r->conn_count);
+    }
+    vector_reset(&conn);
+    return rc;
+}
+
+
+static void _step_fmu(MultiFmu* f, double model_time, double step_size)
+{
+    modelDescription* desc = f->desc;
+    int               rc;
+
+    if (f->version == 3) {
+        bool   event = false;
+        bool   terminate = false;
+        bool   early_return = false;
+        double last_time = 0.0;
+        f->set_real(f->instance, desc->real.vr_rx_real, desc->real.rx_count,
+            desc->real.val_rx_real, desc->real.rx_count);
+        rc = f->do_step(f->instance, model_time, step_size, true, &event,
+            &terminate, &early_return, &last_time);
+        f->get_real(f->instance, desc->real.vr_tx_real, desc->real.tx_count,
+            desc->real.val_tx_real, desc->real.tx_count);
+    } else {
+        f->set_real(f->instance, desc->real.vr_rx_real, desc->real.rx_count,
+            desc->real.val_rx_real);
+        rc = f->do_step(f->instance, model_time, step_size, fmi2True);
+        f->get_real(f->instance, desc->real.vr_tx_real, desc->real.tx_count,
+            desc->real.val_tx_real);
+    }
+    if (rc != 0) {
+        _log("step() returned error code: %d (%s)", rc, f->path);
+    }
+}
+
+
+static void* _worker_thread(void* arg)
+{
+    MultiWorker* w = arg;
+    MultiRun*    r = w->run;
+
+    /* Wait until the complete worker pool is started. */
+    pthread_mutex_lock(&r->gate);
+    pthread_mutex_unlock(&r->gate);
+    if (r->stop) return NULL;
+
+    while (true) {
+        pthread_barrier_wait(&r->start);
+        if (r->stop) break;
+
+        /* Static partition, FMU i is stepped by worker (i % worker_count). */
+        double t0 = _now();
+        for (size_t i = w->index; i < r->fmu_count; i += r->worker_count) {
+            _step_fmu(&r->fmu[i], r->model_time, r->step_size);
+        }
+        w->busy = _now() - t0;
+
+        pthread_barrier_wait(&r->end);
+    }
+    return NULL;
+}
+
+
+static void _cosim(MultiRun* r, double step_size, unsigned int steps)
+{
+    double model_time = 0.0;
+    double step_total = 0.0;
+    double step_max = 0.0;
+
+    r->step_size = step_size;
+    for (unsigned int step = 0; step < steps; step++) {
+        /* Jacobi: inputs are taken from the outputs of the previous step. */
+        for (size_t i = 0; i < r->conn_count; i++) {
+            *r->conn[i].dst = *r->conn[i].src;
+        }
+        r->model_time = model_time;
+        if (__verbose__) {
+            _log("Step: model_time=%f, step_size=%f", model_time, step_size);
+        }
+
+        /* Release the workers and wait for the step to complete. */
+        double t0 = _now();
+        pthread_barrier_wait(&r->start);
+        pthread_barrier_wait(&r->end);
+        double t = _now() - t0;
+
+        step_total += t;
+        if (t > step_max) step_max = t;
+        for (size_t i = 0; i < r->worker_count; i++) {
+            r->worker[i].wait += t - r->worker[i].busy;
+        }
+
+        model_time += step_size;
+    }
+
+    if (steps == 0) return;
+    double wait_total = 0.0;
+    for (size_t i = 0; i < r->worker_count; i++) {
+        wait_total += r->worker[i].wait;
+    }
+    _log("Step Timing: steps=%u, workers=%zu, mean=%.1f us, max=%.1f us",
+        steps, r->worker_count, step_total / steps * 1e6, step_max * 1e6);
+    _log("Barrier Wait: mean=%.1f us (per worker per step)",
+        wait_total / (steps * r->worker_count) * 1e6);
+}
+
+
+/**
+multi_run
+=========
+
+Load a list of FMUs, connect them according to the connection file and run
+a Jacobi co-simulation with the FMUs stepped in parallel on a pool of worker
+threads.
+
+Parameters
+----------
+fmu_paths (const char**)
+: List of FMU directories.
+fmu_count (size_t)
+: Number of FMU directories in the list.
+connection_path (const char*)
+: Path of the connection file.
+platform (const char*)
+: Platform of the FMU binaries.
+step_size (double)
+: The step size of the co-simulation.
+steps (unsigned int)
+: The number of steps to run.
+threads (unsigned int)
+: Number of worker threads, 0 selects one thread per available processor.
+  The number of threads is limited to the number of FMUs.
+
+Returns
+-------
+0 (int)
+: The co-simulation was completed.
++ve (int)
+: An error occurred (errno).
+*/
+int multi_run(const char** fmu_paths, size_t fmu_count,
+    const char* connection_path, const char* platform, double step_size,
+    unsigned int steps, unsigned int threads)
+{
+    char cwd[PATH_MAX];
+    int  rc = 0;
+
+    if (fmu_count == 0) {
+        _log("ERROR: No FMUs specified!");
+        return EINVAL;
+    }
+    if (getcwd(cwd, PATH_MAX) == NULL) return errno;
+
+    MultiRun r = {
+        .fmu = calloc(fmu_count, sizeof(MultiFmu)),
+        .fmu_count = fmu_count,
+    };
+
+    /* Load the FMUs and connections. */
+    for (size_t i = 0; i < fmu_count && rc == 0; i++) {
+        rc = _load_fmu(&r.fmu[i], i, fmu_paths[i], platform, cwd);
+    }
+    if (rc == 0) rc = _load_connections(&r, connection_path);
+
+    /* Start the worker pool and run the co-simulation. */
+    if (rc == 0) {
+        if (threads == 0) {
+            long n = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = (n > 0) ? (unsigned int)n : 1;
+        }
+        r.worker_count = (threads < fmu_count) ? threads : fmu_count;
+        r.worker = calloc(r.worker_count, sizeof(MultiWorker));
+        _log("Workers: %zu", r.worker_count);
+        pthread_mutex_init(&r.gate, NULL);
+        pthread_mutex_lock(&r.gate);
+        size_t started = 0;
+        for (size_t i = 0; i < r.worker_count; i++) {
+            r.worker[i].run = &r;
+            r.worker[i].index = i;
+            rc = pthread_create(
+                &r.worker[i].thread, NULL, _worker_thread, &r.worker[i]);
+            if (rc != 0) {
+                _log("ERROR: Could not start worker %zu (%d)", i, rc);
+                break;
+            }
+            started++;
+        }
+        if (rc != 0) {
+            /* Release (and stop) the started workers, the barriers are not
+               yet initialised. */
+            r.stop = true;
+            pthread_mutex_unlock(&r.gate);
+            for (size_t i = 0; i < started; i++) {
+                pthread_join(r.worker[i].thread, NULL);
+            }
+            pthread_mutex_destroy(&r.gate);
+            goto cleanup;
+        }
+        pthread_barrier_init(&r.start, NULL, r.worker_count + 1);
+        pthread_barrier_init(&r.end, NULL, r.worker_count + 1);
+        pthread_mutex_unlock(&r.gate);
+
+        _cosim(&r, step_size, steps);
+
+        r.stop = true;
+        pthread_barrier_wait(&r.start);
+        for (size_t i = 0; i < r.worker_count; i++) {
+            pthread_join(r.worker[i].thread, NULL);
+        }
+        pthread_barrier_destroy(&r.start);
+        pthread_barrier_destroy(&r.end);
+        pthread_mutex_destroy(&r.gate);
+
+        for (size_t i = 0; i < r.fmu_count; i++) {
+            modelDescription* desc = r.fmu[i].desc;
+            if (desc->real.tx_count > 50 && !__verbose__) continue;
+            _log("FMU [%zu] Scalar Variables (TX):", i);
+            for (size_t j = 0; j < desc->real.tx_count; j++) {
+                _log("  [%d] %lf", desc->real.vr_tx_real[j],
+                    desc->real.val_tx_real[j]);
+            }
+        }
+    }
+
+cleanup:
+    /* Release allocated resources. */
+    for (size_t i = 0; i < r.fmu_count; i++) {
+        _unload_fmu(&r.fmu[i]);
+    }
+    free(r.fmu);
+    free(r.conn);
+    free(r.worker);
+
+    return rc;
+}
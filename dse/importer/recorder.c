@@ -0,0 +1,437 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dse/importer/importer.h>
+
+
+extern void _log(const char* format, ...);
+
+
+/**
+Output Recorder
+===============
+
+Streams the output (TX) scalar variables of an FMU, and optionally the sizes
+of the output binary variables, to a chunked columnar file. Each step appends
+one row to the current chunk; full chunks are handed to a background writer
+thread so that file IO does not block the step loop (the step loop only
+waits when all `RECORDER_CHUNKS` chunks are queued for writing).
+
+File Format
+-----------
+
+All values are in native byte order.
+
+    RecorderHeader                      magic "DSEREC01", columns, chunk_rows
+    RecorderColumn[columns]             vr, kind (RecorderColumnKind)
+    Chunk ...
+        RecorderChunkHeader             rows
+        double time[rows]
+        double value[columns][rows]     column-major (within the chunk)
+
+The sizes of binary variables are the length of the string (FMI 2, encoded)
+or the length of the binary value (FMI 3).
+
+A recording can be converted to CSV with `--dump` (see `recorder_dump()`).
+*/
+
+
+#define RECORDER_MAGIC      "DSEREC01"
+#define RECORDER_VERSION    1
+#define RECORDER_CHUNKS     4
+#define RECORDER_CHUNK_SIZE (1024 * 1024) /* Target chunk size (bytes). */
+#define RECORDER_CHUNK_ROWS 64            /* Minimum rows per chunk. */
+
+
+typedef enum {
+    RecorderColumnReal = 0,
+    RecorderColumnBinarySize = 1,
+} RecorderColumnKind;
+
+
+typedef struct RecorderHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t columns;
+    uint32_t chunk_rows;
+    uint32_t reserved;
+} RecorderHeader;
+
+
+typedef struct RecorderColumn {
+    uint32_t vr;
+    uint32_t kind;
+} RecorderColumn;
+
+
+typedef struct RecorderChunkHeader {
+    uint32_t rows;
+    uint32_t reserved;
+} RecorderChunkHeader;
+
+
+typedef struct RecorderChunk {
+    uint32_t rows;
+    double*  time;
+    double*  value; /* value[column * chunk_rows + row] */
+} RecorderChunk;
+
+
+struct Recorder {
+    FILE*             file;
+    modelDescription* desc;
+    bool              fmi3;
+    uint32_t          columns;
+    uint32_t          chunk_rows;
+    bool              binary;
+
+    /* Chunk queue: chunk[fill] is owned by the step loop, `pending` chunks
+     * starting at chunk[write] are owned by the writer thread. */
+    RecorderChunk   chunk[RECORDER_CHUNKS];
+    size_t          fill;
+    size_t          write;
+    size_t          pending;
+    bool            stop;
+    int             error;
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+
+    /* Statistics. */
+    uint64_t rows;
+    uint64_t chunks;
+    uint64_t stalls;
+    uint64_t bytes;
+};
+
+
+static int _write_chunk(Recorder* r, RecorderChunk* chunk)
+{
+    RecorderChunkHeader ch = { .rows = chunk->rows };
+    size_t              rc = 0;
+
+    rc += fwrite(&ch, sizeof(ch), 1, r->file);
+    rc += fwrite(chunk->time, sizeof(double), chunk->rows, r->file);
+    for (uint32_t c = 0; c < r->columns; c++) {
+        rc += fwrite(&chunk->value[c * r->chunk_rows], sizeof(double),
+            chunk->rows, r->file);
+    }
+    if (rc != 1 + (size_t)chunk->rows * (r->columns + 1)) return EIO;
+    r->bytes += sizeof(ch) + sizeof(double) * chunk->rows * (r->columns + 1);
+    return 0;
+}
+
+
+static void* _writer(void* arg)
+{
+    Recorder* r = arg;
+
+    pthread_mutex_lock(&r->lock);
+    for (;;) {
+        while (r->pending == 0 && r->stop == false) {
+            pthread_cond_wait(&r->cond, &r->lock);
+        }
+        if (r->pending == 0) break;
+        RecorderChunk* chunk = &r->chunk[r->write];
+        pthread_mutex_unlock(&r->lock);
+
+        /* Write (without the lock), the step loop continues filling. */
+        int rc = r->error ? 0 : _write_chunk(r, chunk);
+
+        pthread_mutex_lock(&r->lock);
+        if (rc) r->error = rc;
+        r->chunks++;
+        chunk->rows = 0;
+        r->write = (r->write + 1) % RECORDER_CHUNKS;
+        r->pending--;
+        pthread_cond_broadcast(&r->cond);
+    }
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
+
+
+static void _submit(Recorder* r)
+{
+    pthread_mutex_lock(&r->lock);
+    r->pending++;
+    r->fill = (r->fill + 1) % RECORDER_CHUNKS;
+    pthread_cond_broadcast(&r->cond);
+    if (r->pending == RECORDER_CHUNKS) {
+        /* All chunks are queued, wait for the writer. */
+        r->stalls++;
+        while (r->pending == RECORDER_CHUNKS) {
+            pthread_cond_wait(&r->cond, &r->lock);
+        }
+    }
+    pthread_mutex_unlock(&r->lock);
+}
+
+
+/**
+recorder_open
+=============
+
+Open an output recording and start the writer thread.
+
+Parameters
+----------
+path (const char*)
+: Path of the recording file.
+desc (modelDescription*)
+: The model description, output values are taken from this object.
+fmi3 (bool)
+: The FMU is an FMI 3 FMU (binary variables have a value size).
+binary (bool)
+: Also record the sizes of the output binary variables.
+
+Returns
+-------
+Recorder (pointer)
+: The recorder. Release with `recorder_close()`.
+NULL
+: The recording could not be opened.
+*/
+Recorder* recorder_open(
+    const char* path, modelDescription* desc, bool fmi3, bool binary)
+{
+    if (path == NULL || desc == NULL) return NULL;
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        _log("ERROR: Could not open recording file: %s", path);
+        return NULL;
+    }
+
+    Recorder* r = calloc(1, sizeof(Recorder));
+    r->file = file;
+    r->desc = desc;
+    r->fmi3 = fmi3;
+    r->binary = binary;
+    r->columns = desc->real.tx_count + (binary ? desc->binary.tx_count : 0);
+    r->chunk_rows = RECORDER_CHUNK_SIZE / (sizeof(double) * (r->columns + 1));
+    if (r->chunk_rows < RECORDER_CHUNK_ROWS) {
+        r->chunk_rows = RECORDER_CHUNK_ROWS;
+    }
+    for (size_t i = 0; i < RECORDER_CHUNKS; i++) {
+        r->chunk[i].time = calloc(r->chunk_rows, sizeof(double));
+        r->chunk[i].value =
+            calloc((size_t)r->chunk_rows * r->columns, sizeof(double));
+    }
+
+    /* Header and column descriptions. */
+    RecorderHeader header = {
+        .magic = RECORDER_MAGIC,
+        .version = RECORDER_VERSION,
+        .columns = r->columns,
+        .chunk_rows = r->chunk_rows,
+    };
+    fwrite(&header, sizeof(header), 1, file);
+    for (size_t i = 0; i < desc->real.tx_count; i++) {
+        RecorderColumn col = { desc->real.vr_tx_real[i], RecorderColumnReal };
+        fwrite(&col, sizeof(col), 1, file);
+    }
+    for (size_t i = 0; binary && i < desc->binary.tx_count; i++) {
+        RecorderColumn col = { desc->binary.vr_tx_binary[i],
+            RecorderColumnBinarySize };
+        fwrite(&col, sizeof(col), 1, file);
+    }
+    r->bytes = sizeof(header) + sizeof(RecorderColumn) * r->columns;
+
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->cond, NULL);
+    if (pthread_create(&r->thread, NULL, _writer, r)) {
+        _log("ERROR: Could not start the recorder thread");
+        r->thread = 0;
+        recorder_close(r);
+        return NULL;
+    }
+    _log("Recording: %s (columns=%u, chunk_rows=%u)", path, r->columns,
+        r->chunk_rows);
+    return r;
+}
+
+
+/**
+recorder_append
+===============
+
+Append the current output values (one row) to the recording.
+
+Parameters
+----------
+r (Recorder*)
+: The recorder, may be NULL.
+model_time (double)
+: The model time of the output values.
+*/
+void recorder_append(Recorder* r, double model_time)
+{
+    if (r == NULL) return;
+
+    modelDescription* desc = r->desc;
+    RecorderChunk*    chunk = &r->chunk[r->fill];
+    uint32_t          row = chunk->rows;
+    size_t            c = 0;
+
+    chunk->time[row] = model_time;
+    for (size_t i = 0; i < desc->real.tx_count; i++, c++) {
+        chunk->value[c * r->chunk_rows + row] = desc->real.val_tx_real[i];
+    }
+    for (size_t i = 0; r->binary && i < desc->binary.tx_count; i++, c++) {
+        size_t size = 0;
+        if (desc->binary.val_tx_binary[i]) {
+            size = r->fmi3 ? desc->binary.val_size_tx_binary[i]
+                           : strlen(desc->binary.val_tx_binary[i]);
+        }
+        chunk->value[c * r->chunk_rows + row] = (double)size;
+    }
+    chunk->rows++;
+    r->rows++;
+    if (chunk->rows == r->chunk_rows) _submit(r);
+}
+
+
+/**
+recorder_close
+==============
+
+Write any remaining rows, stop the writer thread and close the recording.
+
+Parameters
+----------
+r (Recorder*)
+: The recorder, may be NULL.
+
+Returns
+-------
+0 (int)
+: The recording was written.
++ve (int)
+: An error occurred (errno).
+*/
+int recorder_close(Recorder* r)
+{
+    if (r == NULL) return 0;
+
+    if (r->thread) {
+        if (r->chunk[r->fill].rows) _submit(r);
+        pthread_mutex_lock(&r->lock);
+        r->stop = true;
+        pthread_cond_broadcast(&r->cond);
+        pthread_mutex_unlock(&r->lock);
+        pthread_join(r->thread, NULL);
+        _log("Recording: rows=%" PRIu64 ", chunks=%" PRIu64 ", bytes=%" PRIu64
+             ", stalls=%" PRIu64,
+            r->rows, r->chunks, r->bytes, r->stalls);
+    }
+    int rc = r->error;
+    if (ferror(r->file)) rc = EIO;
+    if (fclose(r->file) && rc == 0) rc = errno ? errno : EIO;
+    if (rc) _log("ERROR: Recording failed (%d)", rc);
+
+    pthread_cond_destroy(&r->cond);
+    pthread_mutex_destroy(&r->lock);
+    for (size_t i = 0; i < RECORDER_CHUNKS; i++) {
+        free(r->chunk[i].time);
+        free(r->chunk[i].value);
+    }
+    free(r);
+    return rc;
+}
+
+
+/**
+recorder_dump
+=============
+
+Convert a recording to CSV (header: `time,<vr>,<vr>.size,...`).
+
+Parameters
+----------
+path (const char*)
+: Path of the recording file.
+out (FILE*)
+: Stream where the CSV is written.
+
+Returns
+-------
+0 (int)
+: The recording was converted.
++ve (int)
+: An error occurred (errno).
+*/
+int recorder_dump(const char* path, FILE* out)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        _log("ERROR: Could not open recording file: %s", path);
+        return errno ? errno : EINVAL;
+    }
+
+    int            rc = 0;
+    RecorderHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, RECORDER_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RECORDER_VERSION || header.chunk_rows == 0) {
+        _log("ERROR: Not a recording file: %s", path);
+        fclose(file);
+        return EINVAL;
+    }
+
+    RecorderColumn* col = calloc(header.columns, sizeof(RecorderColumn));
+    double*         time = calloc(header.chunk_rows, sizeof(double));
+    double* value = calloc((size_t)header.chunk_rows * header.columns,
+        sizeof(double));
+    if (fread(col, sizeof(RecorderColumn), header.columns, file) !=
+        header.columns) {
+        rc = EINVAL;
+        goto dump_exit;
+    }
+    fprintf(out, "time");
+    for (uint32_t c = 0; c < header.columns; c++) {
+        fprintf(out, ",%u%s", col[c].vr,
+            col[c].kind == RecorderColumnBinarySize ? ".size" : "");
+    }
+    fprintf(out, "\n");
+
+    RecorderChunkHeader ch;
+    while (fread(&ch, sizeof(ch), 1, file) == 1) {
+        if (ch.rows > header.chunk_rows ||
+            fread(time, sizeof(double), ch.rows, file) != ch.rows) {
+            rc = EINVAL;
+            break;
+        }
+        for (uint32_t c = 0; c < header.columns; c++) {
+            if (fread(&value[c * ch.rows], sizeof(double), ch.rows, file) !=
+                ch.rows) {
+                rc = EINVAL;
+                goto dump_exit;
+            }
+        }
+        for (uint32_t row = 0; row < ch.rows; row++) {
+            fprintf(out, "%.15g", time[row]);
+            for (uint32_t c = 0; c < header.columns; c++) {
+                fprintf(out, ",%.15g", value[c * ch.rows + row]);
+            }
+            fprintf(out, "\n");
+        }
+    }
+
+dump_exit:
+    if (rc) _log("ERROR: Recording is truncated or corrupt: %s", path);
+    free(col);
+    free(time);
+    free(value);
+    fclose(file);
+    return rc;
+}
@@ -0,0 +1,396 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dse/importer/importer.h>
+
+
+extern void _log(const char* format, ...);
+
+
+/**
+Step Report
+===========
+
+Each phase of a Co-Simulation step (network loopback, set/get of variables
+and the DoStep) is timed and recorded in a log-linear (HDR style) histogram
+with `REPORT_HIST_SUB_BUCKETS` sub-buckets per power of two, which keeps the
+relative error of reported percentiles below ~6%. Heap allocations (made by
+the Importer or the FMU) are counted for each step when the Importer is built
+with `IMPORTER_ALLOC_COUNT=ON`, otherwise the JSON document reports `null`
+allocations per step (with a note).
+
+The report is logged at the end of the Co-Simulation and, when requested
+(`--report`), written as a JSON document.
+*/
+
+
+static const char* _phase_name[] = {
+    "network",
+    "set_string",
+    "set_real",
+    "do_step",
+    "get_real",
+    "get_string",
+};
+
+
+/* Allocation counting (alloc_count.c, IMPORTER_ALLOC_COUNT builds only). */
+static bool _allocs_available(void)
+{
+#if defined(IMPORTER_ALLOC_COUNT)
+    uint64_t count;
+    return importer_alloc_count(&count);
+#else
+    return false;
+#endif
+}
+
+static inline uint64_t _allocs(void)
+{
+#if defined(IMPORTER_ALLOC_COUNT)
+    uint64_t count;
+    if (importer_alloc_count(&count)) return count;
+#endif
+    return 0;
+}
+
+
+static inline unsigned _hist_index(uint64_t v)
+{
+    if (v < REPORT_HIST_SUB_BUCKETS) return (unsigned)v;
+    unsigned msb = 63 - (unsigned)__builtin_clzll(v);
+    unsigned shift = msb - REPORT_HIST_SUB_BITS;
+    return ((shift + 1) << REPORT_HIST_SUB_BITS) +
+           (unsigned)((v >> shift) & (REPORT_HIST_SUB_BUCKETS - 1));
+}
+
+static inline uint64_t _hist_value(unsigned index)
+{
+    /* Highest value represented by the bucket. */
+    if (index < REPORT_HIST_SUB_BUCKETS) return index;
+    unsigned shift = (index >> REPORT_HIST_SUB_BITS) - 1;
+    uint64_t sub = index & (REPORT_HIST_SUB_BUCKETS - 1);
+    return ((REPORT_HIST_SUB_BUCKETS + sub) << shift) + ((1ull << shift) - 1);
+}
+
+static void _hist_record(ReportHistogram* h, uint64_t v)
+{
+    if (h->count == 0 || v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+    h->count++;
+    h->total += v;
+    h->bucket[_hist_index(v)]++;
+}
+
+static uint64_t _hist_percentile(ReportHistogram* h, double p)
+{
+    if (h->count == 0) return 0;
+    uint64_t target = (uint64_t)(p * h->count + 0.5);
+    if (target == 0) target = 1;
+    uint64_t count = 0;
+    for (unsigned i = 0; i < REPORT_HIST_BUCKETS; i++) {
+        count += h->bucket[i];
+        if (count >= target) {
+            uint64_t v = _hist_value(i);
+            return (v < h->max) ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+
+/**
+report_create
+=============
+
+Returns
+-------
+Report (pointer)
+: A new (empty) step report. Release with `report_destroy()`.
+*/
+Report* report_create(void)
+{
+    Report* r = calloc(1, sizeof(Report));
+    r->start_ns = report_now(r);
+    return r;
+}
+
+
+/**
+report_now
+==========
+
+Parameters
+----------
+r (Report*)
+: The step report, may be NULL.
+
+Returns
+-------
+uint64_t
+: The monotonic clock (ns), or 0 when there is no report.
+*/
+uint64_t report_now(Report* r)
+{
+    if (r == NULL) return 0;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+/**
+report_step_begin
+=================
+
+Parameters
+----------
+r (Report*)
+: The step report, may be NULL.
+
+Returns
+-------
+uint64_t
+: The start time of the step (ns), use as `t0` for the first phase.
+*/
+uint64_t report_step_begin(Report* r)
+{
+    if (r == NULL) return 0;
+
+    r->step_allocs = _allocs();
+    r->step_ns = report_now(r);
+    return r->step_ns;
+}
+
+
+/**
+report_phase
+============
+
+Record the duration of a step phase.
+
+Parameters
+----------
+r (Report*)
+: The step report, may be NULL.
+phase (ReportPhase)
+: The phase being recorded.
+t0 (uint64_t)
+: The start time of the phase (ns).
+
+Returns
+-------
+uint64_t
+: The end time of the phase (ns), use as `t0` for the next phase.
+*/
+uint64_t report_phase(Report* r, ReportPhase phase, uint64_t t0)
+{
+    if (r == NULL) return 0;
+
+    uint64_t t = report_now(r);
+    _hist_record(&r->phase[phase], t - t0);
+    return t;
+}
+
+
+/**
+report_step_end
+===============
+
+Parameters
+----------
+r (Report*)
+: The step report, may be NULL.
+*/
+void report_step_end(Report* r)
+{
+    if (r == NULL) return;
+
+    uint64_t t = report_now(r);
+    _hist_record(&r->step, t - r->step_ns);
+    r->allocs += _allocs() - r->step_allocs;
+    r->steps++;
+    r->end_ns = t;
+}
+
+
+static double _steps_per_second(Report* r)
+{
+    if (r->end_ns <= r->start_ns) return 0.0;
+    return r->steps / ((r->end_ns - r->start_ns) / 1e9);
+}
+
+static double _allocs_per_step(Report* r)
+{
+    return r->steps ? (double)r->allocs / r->steps : 0.0;
+}
+
+
+/**
+report_log
+==========
+
+Log a summary of the step report.
+
+Parameters
+----------
+r (Report*)
+: The step report, may be NULL.
+*/
+void report_log(Report* r)
+{
+    if (r == NULL || r->steps == 0) return;
+
+    _log("Step Report: steps=%" PRIu64
+         ", steps/s=%.1f, allocations/step=%.1f%s",
+        r->steps, _steps_per_second(r), _allocs_per_step(r),
+        _allocs_available() ? "" : " (not available)");
+    for (int i = 0; i <= ReportPhaseCount; i++) {
+        ReportHistogram* h = (i < ReportPhaseCount) ? &r->phase[i] : &r->step;
+        if (h->count == 0) continue;
+        _log("  %-10s p50=%" PRIu64 " ns, p99=%" PRIu64 " ns, p999=%" PRIu64
+             " ns, max=%" PRIu64 " ns",
+            (i < ReportPhaseCount) ? _phase_name[i] : "step",
+            _hist_percentile(h, 0.50), _hist_percentile(h, 0.99),
+            _hist_percentile(h, 0.999), h->max);
+    }
+}
+
+
+/* Write a JSON string value (quoted and escaped). */
+static void _write_string(FILE* f, const char* s)
+{
+    fputc('"', f);
+    for (const unsigned char* p = (const unsigned char*)s; p && *p; p++) {
+        switch (*p) {
+        case '"':
+            fputs("\\\"", f);
+            break;
+        case '\\':
+            fputs("\\\\", f);
+            break;
+        case '\n':
+            fputs("\\n", f);
+            break;
+        case '\r':
+            fputs("\\r", f);
+            break;
+        case '\t':
+            fputs("\\t", f);
+            break;
+        default:
+            if (*p < 0x20) {
+                fprintf(f, "\\u%04x", *p);
+            } else {
+                fputc(*p, f);
+            }
+        }
+    }
+    fputc('"', f);
+}
+
+static void _write_hist(FILE* f, const char* name, ReportHistogram* h,
+    bool last)
+{
+    fprintf(f, "    ");
+    _write_string(f, name);
+    fprintf(f,
+        ": {\"count\": %" PRIu64 ", \"mean_ns\": %.1f, "
+        "\"min_ns\": %" PRIu64 ", \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64
+        ", \"p999_ns\": %" PRIu64 ", \"max_ns\": %" PRIu64 "}%s\n",
+        h->count, h->count ? (double)h->total / h->count : 0.0, h->min,
+        _hist_percentile(h, 0.50), _hist_percentile(h, 0.99),
+        _hist_percentile(h, 0.999), h->max, last ? "" : ",");
+}
+
+
+/**
+report_write_json
+=================
+
+Write the step report as a JSON document.
+
+Parameters
+----------
+r (Report*)
+: The step report.
+path (const char*)
+: Path of the JSON file.
+fmu_path (const char*)
+: Path of the FMU (informational).
+fmi_version (int)
+: The FMI version of the FMU.
+step_size (double)
+: The step size of the Co-Simulation.
+
+Returns
+-------
+0 (int)
+: The report was written.
++ve (int)
+: An error occurred (errno).
+*/
+int report_write_json(Report* r, const char* path, const char* fmu_path,
+    int fmi_version, double step_size)
+{
+    if (r == NULL || path == NULL) return EINVAL;
+
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        _log("ERROR: Could not open report file: %s", path);
+        return errno ? errno : EINVAL;
+    }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"fmu\": ");
+    _write_string(f, fmu_path);
+    fprintf(f, ",\n");
+    fprintf(f, "  \"fmi_version\": %d,\n", fmi_version);
+    fprintf(f, "  \"step_size\": %g,\n", step_size);
+    fprintf(f, "  \"steps\": %" PRIu64 ",\n", r->steps);
+    fprintf(f, "  \"elapsed_s\": %.6f,\n",
+        (r->end_ns > r->start_ns) ? (r->end_ns - r->start_ns) / 1e9 : 0.0);
+    fprintf(f, "  \"steps_per_second\": %.1f,\n", _steps_per_second(r));
+    if (_allocs_available()) {
+        fprintf(f, "  \"allocations_per_step\": %.2f,\n", _allocs_per_step(r));
+    } else {
+        fprintf(f, "  \"allocations_per_step\": null,\n");
+        fprintf(f, "  \"allocations_note\": \"not counted, build with "
+                   "IMPORTER_ALLOC_COUNT=ON\",\n");
+    }
+    fprintf(f, "  \"phases\": {\n");
+    for (int i = 0; i < ReportPhaseCount; i++) {
+        _write_hist(f, _phase_name[i], &r->phase[i], false);
+    }
+    _write_hist(f, "step", &r->step, true);
+    fprintf(f, "  }\n");
+    fprintf(f, "}\n");
+    int rc = ferror(f) ? EIO : 0;
+    fclose(f);
+
+    _log("Report: %s", path);
+    return rc;
+}
+
+
+/**
+report_destroy
+==============
+
+Parameters
+----------
+r (Report*)
+: The step report, may be NULL.
+*/
+void report_destroy(Report* r)
+{
+    free(r);
+}
@@ -8,6 +8,7 @@
 #include <dse/ncodec/codec.h>
 #include <dse/ncodec/interface/frame.h>
 #include <dse/ncodec/stream/stream.h>
+#include <dse/importer/importer.h>
 #include <dse/logger.h>
 
 #define UNUSED(x) ((void)x)
@@ -15,49 +16,45 @@
 bool signal_bus_enabled = false;
 
 
-typedef struct NetworkSignal {
-    const char* name;
-    const char* mime_type;
-    NCODEC*     nc;
-} NetworkSignal;
+/**
+Signal Bus
+==========
 
-int NetworkSignalCompar(const void* left, const void* right)
-{
-    const NetworkSignal* l = left;
-    const NetworkSignal* r = right;
-    return strcmp(l->name, r->name);
-}
+Loopback bus for binary (NCodec) variables. Variables are routed to a
+network according to the `bus_id` (or `swc_id`) of their MIME type, all
+variables with the same route share one network (i.e. one NCodec stream).
 
-static Vector ns_v = { 0 }; /* NetworkSignal */
+Networks are resolved once, at setup, with `network_open()`. The handle is
+then used for all push/pull operations. `network_pull()` returns a view of
+the network stream (no copy) which is valid until the network is next
+modified or truncated.
+*/
 
 
-static NetworkSignal* _get_network_signal(
-    const char* name, const char* mime_type)
-{
-    if (ns_v.capacity == 0) {
-        ns_v = vector_make(sizeof(NetworkSignal), 0, NetworkSignalCompar);
-    }
-    NetworkSignal* ns =
-        vector_find(&ns_v, &(NetworkSignal){ .name = name }, 0, NULL);
-    if (ns == NULL) {
-        if (mime_type == NULL) return NULL;
-        NCodecInstance* nc = ncodec_create(mime_type);
-        if (nc) nc->stream = ncodec_buffer_stream_create(1024);
-        vector_push(&ns_v,
-            &(NetworkSignal){ .name = name, .mime_type = mime_type, .nc = nc });
-        vector_sort(&ns_v);
-    }
-    return vector_find(&ns_v, &(NetworkSignal){ .name = name }, 0, NULL);
-}
+typedef struct NetworkSignal {
+    char*   name; /* Route, e.g. "bus_id=1". */
+    char*   mime_type;
+    bool    frame;
+    NCODEC* nc;
+} NetworkSignal;
 
-static void _network_signal_close(void* item, void* data)
+static Vector ns_v = { 0 }; /* NetworkSignal* */
+
+
+static char* _network_route(const char* mime_type)
 {
-    UNUSED(data);
-    NetworkSignal* ns = item;
-    if (ns->nc) {
-        ncodec_close(ns->nc);
-        ns->nc = NULL;
+    static const char* keys[] = { "bus_id", "swc_id" };
+    char               route[64];
+
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        char* value = network_mime_type_value(mime_type, keys[i]);
+        if (value) {
+            snprintf(route, sizeof(route), "%s=%s", keys[i], value);
+            free(value);
+            return strdup(route);
+        }
     }
+    return strdup("default");
 }
 
 
@@ -79,11 +76,66 @@ char* network_mime_type_value(const char* mime_type, const char* key)
 }
 
 
-void network_inject_frame(const char* name, const char* mime_type, int32_t id,
-    uint8_t* data, size_t len)
+/**
+network_open
+============
+
+Resolve the network of a binary variable, the network is created on first
+use.
+
+Parameters
+----------
+mime_type (const char*)
+: The MIME type of the binary variable.
+
+Returns
+-------
+NetworkSignal (pointer)
+: The network which the variable is routed to.
+NULL
+: The MIME type is not supported.
+*/
+NetworkSignal* network_open(const char* mime_type)
+{
+    if (mime_type == NULL) return NULL;
+    if (ns_v.capacity == 0) {
+        ns_v = vector_make(sizeof(NetworkSignal*), 0, NULL);
+    }
+
+    char* name = _network_route(mime_type);
+    for (size_t i = 0; i < vector_len(&ns_v); i++) {
+        NetworkSignal* ns = NULL;
+        vector_at(&ns_v, i, &ns);
+        if (strcmp(ns->name, name) == 0) {
+            free(name);
+            return ns;
+        }
+    }
+
+    NCodecInstance* nc = ncodec_create(mime_type);
+    if (nc == NULL) {
+        free(name);
+        return NULL;
+    }
+    nc->stream = ncodec_buffer_stream_create(1024);
+    char* type = network_mime_type_value(mime_type, "type");
+
+    NetworkSignal* ns = calloc(1, sizeof(NetworkSignal));
+    *ns = (NetworkSignal){
+        .name = name,
+        .mime_type = strdup(mime_type),
+        .frame = (type && strcmp(type, "frame") == 0),
+        .nc = nc,
+    };
+    free(type);
+    vector_push(&ns_v, &ns);
+    return ns;
+}
+
+
+void network_inject_frame(
+    NetworkSignal* ns, int32_t id, uint8_t* data, size_t len)
 {
-    /* Locate the network signal. */
-    NetworkSignal* ns = _get_network_signal(name, mime_type);
     if (ns == NULL || ns->nc == NULL) return;
 
     /* Append a frame to the NC. */
@@ -97,13 +149,9 @@ void network_inject_frame(const char* name, const char* mime_type, int32_t id,
 }
 
 
-void network_push(
-    const char* name, const char* mime_type, uint8_t* buffer, size_t len)
+void network_push(NetworkSignal* ns, const uint8_t* buffer, size_t len)
 {
     if (buffer == NULL || len == 0) return;
-
-    /* Locate the network signal. */
-    NetworkSignal* ns = _get_network_signal(name, mime_type);
     if (ns == NULL || ns->nc == NULL) return;
 
     /* Append buffer to the underlying NCodec stream. */
@@ -111,53 +159,43 @@ void network_push(
         /* Only perform Tx -> Rx if signal bus enabled. */
         NCodecInstance* nc = ns->nc;
         ncodec_seek(nc, 0, NCODEC_SEEK_END);
-        nc->stream->write(nc, buffer, len);
-    } else {
-        char* type = network_mime_type_value((char*)mime_type, "type");
-        if (strcmp(type, "frame") == 0) {
-            NCodecInstance* nc = ncodec_create(mime_type);
-            if (nc == NULL) return;
-            nc->stream = ncodec_buffer_stream_create(len);
-            nc->stream->write(nc, buffer, len);
-            ncodec_seek(nc, 0, NCODEC_SEEK_SET);
-            NCodecCanMessage msg = {};
-            while (ncodec_read(nc, &msg) >= 0) {
-                printf("Importer: network message (RX): %s\n", msg.buffer);
-            }
-            ncodec_close(nc);
+        nc->stream->write(nc, (uint8_t*)buffer, len);
+    } else if (ns->frame) {
+        NCodecInstance* nc = ncodec_create(ns->mime_type);
+        if (nc == NULL) return;
+        nc->stream = ncodec_buffer_stream_create(len);
+        nc->stream->write(nc, (uint8_t*)buffer, len);
+        ncodec_seek(nc, 0, NCODEC_SEEK_SET);
+        NCodecCanMessage msg = {};
+        while (ncodec_read(nc, &msg) >= 0) {
+            printf("Importer: network message (RX): %s\n", msg.buffer);
         }
-        free(type);
+        ncodec_close(nc);
     }
 }
 
 
-void network_pull(
-    const char* name, const char* mime_type, uint8_t** buffer, size_t* len)
+void network_pull(NetworkSignal* ns, const uint8_t** buffer, size_t* len)
 {
     if (buffer == NULL || len == NULL) return;
     *buffer = NULL;
     *len = 0;
-
-    /* Locate the network signal. */
-    NetworkSignal* ns = _get_network_signal(name, mime_type);
     if (ns == NULL || ns->nc == NULL) return;
 
-    /* Copy and return the underlying NCodec stream. */
+    /* Return a view of the underlying NCodec stream. */
     NCodecInstance* nc = ns->nc;
     ncodec_seek(nc, 0, NCODEC_SEEK_SET);
-    uint8_t* stream;
+    uint8_t* stream = NULL;
     nc->stream->read(nc, &stream, len, NCODEC_POS_NC);
-    if (*len) {
-        *buffer = malloc(*len); /* Caller to free. */
-        memcpy(*buffer, stream, *len);
-    }
+    if (*len) *buffer = stream;
 }
 
 
 void network_truncate(void)
 {
-    for (size_t i = 0; i < ns_v.length; i++) {
-        NetworkSignal* ns = vector_at(&ns_v, i, NULL);
+    for (size_t i = 0; i < vector_len(&ns_v); i++) {
+        NetworkSignal* ns = NULL;
+        vector_at(&ns_v, i, &ns);
         if (ns && ns->nc) {
             ncodec_truncate(ns->nc);
         }
@@ -165,6 +203,20 @@ void network_truncate(void)
 }
 
 
+static void _network_signal_close(void* item, void* data)
+{
+    UNUSED(data);
+    NetworkSignal* ns = *(NetworkSignal**)item;
+    if (ns->nc) {
+        ncodec_close(ns->nc);
+        ns->nc = NULL;
+    }
+    free(ns->name);
+    free(ns->mime_type);
+    free(ns);
+}
+
+
 void network_close(void)
 {
     vector_clear(&ns_v, _network_signal_close, NULL);
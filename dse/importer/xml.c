@@ -289,6 +289,10 @@ static inline void _parse_fmi3_binary(xmlNodePtr child, xmlChar* vr,
         data->type = network_mime_type_value((char*)mime_type, "type");
     }
     xmlFree(mime_type);
+    xmlChar* encoding = _parse_fmi3_tool_anno(
+        child, "dse.standards.fmi-ls-binary-to-text", "Encoding");
+    if (encoding) data->encoding = strdup((char*)encoding);
+    xmlFree(encoding);
 
     if (strcmp((char*)causality, "input") == 0) {
         hashmap_set(vr_rx_binary, (char*)vr, data);
@@ -481,3 +485,51 @@ modelDescription* parse_model_desc(const char* docname, const char* platform)
 
     return desc;
 }
+
+void free_model_desc(modelDescription* desc)
+{
+    if (desc == NULL) return;
+
+    free(desc->version);
+    free(desc->fmu_lib_path);
+    for (size_t i = 0; i < desc->binary.tx_count; i++) {
+        if (desc->binary.val_tx_binary[i]) {
+            free(desc->binary.val_tx_binary[i]);
+            desc->binary.val_tx_binary[i] = NULL;
+        }
+        if (desc->binary.tx_binary_info[i]) {
+            free(desc->binary.tx_binary_info[i]->mime_type);
+            free(desc->binary.tx_binary_info[i]->start);
+            free(desc->binary.tx_binary_info[i]->type);
+            free(desc->binary.tx_binary_info[i]->encoding);
+            free(desc->binary.tx_binary_info[i]);
+        }
+    }
+    for (size_t i = 0; i < desc->binary.rx_count; i++) {
+        if (desc->binary.val_rx_binary[i]) {
+            free(desc->binary.val_rx_binary[i]);
+            desc->binary.val_rx_binary[i] = NULL;
+        }
+        if (desc->binary.rx_binary_info[i]) {
+            free(desc->binary.rx_binary_info[i]->mime_type);
+            free(desc->binary.rx_binary_info[i]->start);
+            free(desc->binary.rx_binary_info[i]->type);
+            free(desc->binary.rx_binary_info[i]->encoding);
+            free(desc->binary.rx_binary_info[i]);
+        }
+    }
+    free(desc->binary.rx_binary_info);
+    free(desc->binary.tx_binary_info);
+
+    free(desc->binary.vr_tx_binary);
+    free(desc->binary.val_tx_binary);
+    free(desc->binary.val_size_tx_binary);
+    free(desc->binary.vr_rx_binary);
+    free(desc->binary.val_rx_binary);
+    free(desc->binary.val_size_rx_binary);
+    free(desc->real.vr_tx_real);
+    free(desc->real.val_tx_real);
+    free(desc->real.vr_rx_real);
+    free(desc->real.val_rx_real);
+    free(desc);
+}
@@ -0,0 +1,531 @@
+// Copyright 2026 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <fmi2Functions.h>
+#include <fmi2FunctionTypes.h>
+#include <fmi2TypesPlatform.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/clib/util/strings.h>
+#include <dse/ncodec/codec.h>
+#include <dse/ncodec/interface/pdu.h>
+#include <dse/fmu/fmu.h>
+
+
+/**
+FMU Microbenchmarks
+===================
+
+Measures the cost of the FMU (FMI 2) hot paths:
+
+* fmi2GetReal/fmi2SetReal, hashmap and direct index mode, over nvr.
+* fmi2GetString/fmi2SetString, with and without ascii85 encoding.
+* fmi2DoStep, Var Table marshalling.
+* NCodec (fmu_ncodec_open) stream write/flush and read.
+* fmi2Instantiate/fmi2FreeInstance, over the Model Description size.
+
+Each benchmark is calibrated to run for at least `BENCH_SAMPLE_NS` per sample,
+`BENCH_SAMPLES` samples are taken and the median (and minimum) reported. The
+results are written as JSON (fixed layout and ordering) to the file given as
+the first argument, or to stdout.
+
+    $ bin/bench_fmi2fmu bench.json
+*/
+
+
+#define ARRAY_SIZE(x)    (sizeof(x) / sizeof(x[0]))
+#define BENCH_SCHEMA     "dse.fmi.bench/1"
+#define BENCH_DATA_DIR   "data/bench"
+#define BENCH_SAMPLES    9
+#define BENCH_SAMPLE_NS  5000000ull /* 5 ms */
+#define BENCH_SCALARS    4096
+#define BENCH_BINARY_VR  1000000
+#define BENCH_PAYLOAD    64
+#define BENCH_PDU_COUNT  16
+#define BENCH_RESULT_MAX 64
+
+
+typedef void (*BenchFunc)(void* ctx, size_t iterations);
+
+typedef struct BenchResult {
+    char     name[48];
+    char     params[64];
+    size_t   items; /* Items per call, e.g. nvr. */
+    uint64_t iterations;
+    double   ns_per_call;
+    double   ns_per_call_min;
+} BenchResult;
+
+static BenchResult _result[BENCH_RESULT_MAX];
+static size_t      _result_count;
+
+
+/* Model
+ * ===== */
+
+typedef enum {
+    BinaryA85Rx = 0,
+    BinaryA85Tx,
+    BinaryRawRx,
+    BinaryRawTx,
+    BinaryPduRx,
+    BinaryPduTx,
+    BinaryCount,
+} BenchBinary;
+
+static const struct {
+    const char* name;
+    const char* causality;
+    bool        ascii85;
+    bool        pdu;
+} _binary[] = {
+    { "a85_rx", "input", true, false },
+    { "a85_tx", "output", true, false },
+    { "raw_rx", "input", false, false },
+    { "raw_tx", "output", false, false },
+    { "pdu_rx", "input", false, true },
+    { "pdu_tx", "output", false, true },
+};
+
+
+static int _write_model(const char* dir, size_t n)
+{
+    char path[PATH_MAX];
+
+    mkdir("data", 0755);
+    mkdir(BENCH_DATA_DIR, 0755);
+    mkdir(dir, 0755);
+    snprintf(path, sizeof(path), "%s/resources", dir);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/modelDescription.xml", dir);
+    FILE* f = fopen(path, "w");
+    if (f == NULL) return errno;
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<fmiModelDescription fmiVersion=\"2.0\" modelName=\"bench\" "
+               "guid=\"{bench}\">\n"
+               "  <ModelVariables>\n");
+    for (size_t i = 0; i < n; i++) {
+        fprintf(f,
+            "    <ScalarVariable name=\"in_%zu\" valueReference=\"%zu\" "
+            "causality=\"input\"><Real start=\"0\"/></ScalarVariable>\n",
+            i, 1 + i);
+    }
+    for (size_t i = 0; i < n; i++) {
+        fprintf(f,
+            "    <ScalarVariable name=\"out_%zu\" valueReference=\"%zu\" "
+            "causality=\"output\"><Real start=\"0\"/></ScalarVariable>\n",
+            i, 1 + n + i);
+    }
+    for (size_t i = 0; i < BinaryCount; i++) {
+        fprintf(f,
+            "    <ScalarVariable name=\"%s\" valueReference=\"%zu\" "
+            "causality=\"%s\">\n"
+            "      <String start=\"\"/>\n"
+            "      <Annotations>\n",
+            _binary[i].name, BENCH_BINARY_VR + i, _binary[i].causality);
+        if (_binary[i].ascii85) {
+            fprintf(f,
+                "        <Tool name=\"dse.standards.fmi-ls-binary-to-text\">"
+                "<Annotation name=\"encoding\">ascii85</Annotation>"
+                "</Tool>\n");
+        }
+        if (_binary[i].pdu) {
+            fprintf(f,
+                "        <Tool name=\"dse.standards.fmi-ls-binary-codec\">"
+                "<Annotation name=\"mimetype\">application/x-automotive-bus; "
+                "interface=stream; type=pdu; schema=fbs; swc_id=1; ecu_id=1"
+                "</Annotation></Tool>\n");
+        }
+        fprintf(f, "      </Annotations>\n"
+                   "    </ScalarVariable>\n");
+    }
+    fprintf(f, "  </ModelVariables>\n"
+               "</fmiModelDescription>\n");
+    return fclose(f) ? errno : 0;
+}
+
+
+/* FMU Interface (Var Table over all scalar variables). */
+
+FmuInstanceData* fmu_create(FmuInstanceData* fmu)
+{
+    size_t n = hashmap_number_keys(fmu->variables.scalar.input) +
+               hashmap_number_keys(fmu->variables.scalar.output);
+    double* v = calloc(n + 1, sizeof(double));
+    for (size_t i = 0; i < n; i++) {
+        bool input = i < (n / 2);
+        fmu_register_var(fmu, 1 + i, input, i * sizeof(double));
+    }
+    fmu_register_var_table(fmu, v);
+    return NULL;
+}
+
+int32_t fmu_init(FmuInstanceData* fmu)
+{
+    UNUSED(fmu);
+    return 0;
+}
+
+int32_t fmu_step(
+    FmuInstanceData* fmu, double communication_point, double step_size)
+{
+    UNUSED(fmu);
+    UNUSED(communication_point);
+    UNUSED(step_size);
+    return 0;
+}
+
+int32_t fmu_destroy(FmuInstanceData* fmu)
+{
+    UNUSED(fmu);
+    return 0;
+}
+
+
+static fmi2Component _instantiate(size_t n)
+{
+    char dir[PATH_MAX];
+    char resources[PATH_MAX];
+
+    snprintf(dir, sizeof(dir), BENCH_DATA_DIR "/%zu", n);
+    if (_write_model(dir, n)) return NULL;
+    snprintf(resources, sizeof(resources), "%s/resources", dir);
+    return fmi2Instantiate("bench", fmi2CoSimulation, "{bench}", resources,
+        NULL, false, false);
+}
+
+
+/* Benchmark Harness
+ * ================= */
+
+static inline uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+static int _compare_double(const void* a, const void* b)
+{
+    double _a = *(const double*)a;
+    double _b = *(const double*)b;
+    return (_a > _b) - (_a < _b);
+}
+
+
+static void _bench(const char* name, const char* params, size_t items,
+    BenchFunc func, void* ctx)
+{
+    /* Calibrate: double the iterations until a sample is long enough. */
+    uint64_t iterations = 1;
+    func(ctx, 1); /* Warm-up. */
+    while (1) {
+        uint64_t t0 = _now_ns();
+        func(ctx, iterations);
+        if (_now_ns() - t0 >= BENCH_SAMPLE_NS || iterations >= (1ull << 30)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    /* Sample. */
+    double sample[BENCH_SAMPLES];
+    for (size_t s = 0; s < BENCH_SAMPLES; s++) {
+        uint64_t t0 = _now_ns();
+        func(ctx, iterations);
+        sample[s] = (double)(_now_ns() - t0) / iterations;
+    }
+    qsort(sample, BENCH_SAMPLES, sizeof(double), _compare_double);
+
+    if (_result_count == BENCH_RESULT_MAX) return;
+    BenchResult* r = &_result[_result_count++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    snprintf(r->params, sizeof(r->params), "%s", params);
+    r->items = items;
+    r->iterations = iterations;
+    r->ns_per_call = sample[BENCH_SAMPLES / 2];
+    r->ns_per_call_min = sample[0];
+    fprintf(stderr, "%-16s %-28s %12.1f ns/call %10.2f ns/item\n", name,
+        params, r->ns_per_call, r->ns_per_call / (items ? items : 1));
+}
+
+
+static int _write_json(FILE* f)
+{
+    fprintf(f, "{\n");
+    fprintf(f, "  \"schema\": \"%s\",\n", BENCH_SCHEMA);
+    fprintf(f, "  \"samples\": %d,\n", BENCH_SAMPLES);
+    fprintf(f, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < _result_count; i++) {
+        BenchResult* r = &_result[i];
+        fprintf(f,
+            "    {\"name\": \"%s\", \"params\": \"%s\", \"items\": %zu, "
+            "\"iterations\": %" PRIu64 ", \"ns_per_call\": %.1f, "
+            "\"ns_per_call_min\": %.1f, \"ns_per_item\": %.2f}%s\n",
+            r->name, r->params, r->items, r->iterations, r->ns_per_call,
+            r->ns_per_call_min, r->ns_per_call / (r->items ? r->items : 1),
+            (i + 1 < _result_count) ? "," : "");
+    }
+    fprintf(f, "  ]\n");
+    fprintf(f, "}\n");
+    return ferror(f) ? EIO : 0;
+}
+
+
+/* Benchmarks
+ * ========== */
+
+typedef struct RealCtx {
+    fmi2Component       fmu;
+    fmi2ValueReference* vr;
+    double*             value;
+    size_t              nvr;
+} RealCtx;
+
+static void _get_real(void* ctx, size_t iterations)
+{
+    RealCtx* c = ctx;
+    for (size_t i = 0; i < iterations; i++) {
+        fmi2GetReal(c->fmu, c->vr, c->nvr, c->value);
+    }
+}
+
+static void _set_real(void* ctx, size_t iterations)
+{
+    RealCtx* c = ctx;
+    for (size_t i = 0; i < iterations; i++) {
+        fmi2SetReal(c->fmu, c->vr, c->nvr, c->value);
+    }
+}
+
+static void _bench_real(fmi2Component fmu)
+{
+    static const size_t nvr[] = { 1, 16, 256, BENCH_SCALARS };
+    FmuInstanceData*    inst = fmu;
+    RealCtx             c = {
+                    .fmu = fmu,
+                    .vr = calloc(BENCH_SCALARS, sizeof(fmi2ValueReference)),
+                    .value = calloc(BENCH_SCALARS, sizeof(double)),
+    };
+    double* map = calloc(BENCH_SCALARS, sizeof(double));
+    char    params[64];
+
+    for (int direct = 0; direct <= 1; direct++) {
+        for (size_t i = 0; i < BENCH_SCALARS; i++) {
+            /* Direct index: vr == offset address in the map. */
+            c.vr[i] = direct ? i * sizeof(double) : 1 + i;
+        }
+        inst->direct_index.map = direct ? map : NULL;
+        inst->direct_index.size = direct ? BENCH_SCALARS * sizeof(double) : 0;
+        for (size_t j = 0; j < ARRAY_SIZE(nvr); j++) {
+            c.nvr = nvr[j];
+            snprintf(params, sizeof(params), "mode=%s,nvr=%zu",
+                direct ? "direct_index" : "hashmap", nvr[j]);
+            _bench("fmi2GetReal", params, nvr[j], _get_real, &c);
+            _bench("fmi2SetReal", params, nvr[j], _set_real, &c);
+        }
+    }
+    inst->direct_index.map = NULL;
+    inst->direct_index.size = 0;
+    free(map);
+    free(c.vr);
+    free(c.value);
+}
+
+
+typedef struct StringCtx {
+    fmi2Component      fmu;
+    fmi2ValueReference vr;
+    fmi2String         value;
+} StringCtx;
+
+static void _get_string(void* ctx, size_t iterations)
+{
+    StringCtx* c = ctx;
+    fmi2String value;
+    for (size_t i = 0; i < iterations; i++) {
+        fmi2GetString(c->fmu, &c->vr, 1, &value);
+    }
+}
+
+static void _set_string(void* ctx, size_t iterations)
+{
+    StringCtx*       c = ctx;
+    FmuInstanceData* inst = c->fmu;
+    for (size_t i = 0; i < iterations; i++) {
+        /* Each call represents a new step (binary signals are reset). */
+        inst->variables.signals_reset = false;
+        fmi2SetString(c->fmu, &c->vr, 1, &c->value);
+    }
+}
+
+static void _bench_string(fmi2Component fmu)
+{
+    static const size_t len[] = { 16, 256, 4096 };
+    FmuInstanceData*    inst = fmu;
+    char                params[64];
+    char                key[HASHLIST_KEY_LEN];
+
+    for (int a85 = 1; a85 >= 0; a85--) {
+        BenchBinary rx = a85 ? BinaryA85Rx : BinaryRawRx;
+        BenchBinary tx = a85 ? BinaryA85Tx : BinaryRawTx;
+        for (size_t j = 0; j < ARRAY_SIZE(len); j++) {
+            /* Payload: text (no NUL) so that both paths carry len bytes. */
+            char* payload = calloc(len[j] + 1, 1);
+            memset(payload, 'A', len[j]);
+            snprintf(params, sizeof(params), "encoding=%s,len=%zu",
+                a85 ? "ascii85" : "none", len[j]);
+
+            /* GetString: load the Tx signal directly. */
+            snprintf(key, sizeof(key), "%u", BENCH_BINARY_VR + tx);
+            FmuSignalVectorIndex* idx =
+                hashmap_get(&inst->variables.binary.tx, key);
+            idx->sv->length[idx->vi] = 0;
+            dse_buffer_append(&idx->sv->binary[idx->vi],
+                &idx->sv->length[idx->vi], &idx->sv->buffer_size[idx->vi],
+                payload, len[j] + 1);
+            StringCtx c = { .fmu = fmu, .vr = BENCH_BINARY_VR + tx };
+            _bench("fmi2GetString", params, len[j], _get_string, &c);
+
+            /* SetString: encoded (as received from an Importer) or raw. */
+            c.vr = BENCH_BINARY_VR + rx;
+            c.value = a85 ? dse_ascii85_encode(payload, len[j]) : payload;
+            _bench("fmi2SetString", params, len[j], _set_string, &c);
+
+            if (c.value != payload) free((char*)c.value);
+            free(payload);
+        }
+    }
+}
+
+
+static void _do_step(void* ctx, size_t iterations)
+{
+    for (size_t i = 0; i < iterations; i++) {
+        fmi2DoStep(ctx, 0.0, 0.0005, fmi2True);
+    }
+}
+
+static void _bench_do_step(fmi2Component fmu)
+{
+    char params[64];
+    snprintf(params, sizeof(params), "vars=%d", 2 * BENCH_SCALARS);
+    _bench("fmi2DoStep", params, 2 * BENCH_SCALARS, _do_step, fmu);
+}
+
+
+typedef struct NcodecCtx {
+    NCODEC*  nc;
+    uint8_t* payload;
+} NcodecCtx;
+
+static void _ncodec_write(void* ctx, size_t iterations)
+{
+    NcodecCtx* c = ctx;
+    for (size_t i = 0; i < iterations; i++) {
+        ncodec_truncate(c->nc);
+        for (size_t k = 0; k < BENCH_PDU_COUNT; k++) {
+            ncodec_write(c->nc, &(struct NCodecPdu){ .id = 1000 + k,
+                                    .payload = c->payload,
+                                    .payload_len = BENCH_PAYLOAD,
+                                    .swc_id = 2 });
+        }
+        ncodec_flush(c->nc);
+    }
+}
+
+static void _ncodec_read(void* ctx, size_t iterations)
+{
+    NcodecCtx* c = ctx;
+    for (size_t i = 0; i < iterations; i++) {
+        ncodec_seek(c->nc, 0, NCODEC_SEEK_SET);
+        while (1) {
+            NCodecPdu pdu = {};
+            if (ncodec_read(c->nc, &pdu) < 0) break;
+        }
+    }
+}
+
+static void _bench_ncodec(fmi2Component fmu)
+{
+    char    params[64];
+    uint8_t payload[BENCH_PAYLOAD] = { 0 };
+    snprintf(params, sizeof(params), "type=pdu,count=%d,payload=%d",
+        BENCH_PDU_COUNT, BENCH_PAYLOAD);
+
+    NcodecCtx c = { .payload = payload };
+    c.nc = fmu_lookup_ncodec(fmu, BENCH_BINARY_VR + BinaryPduTx, false);
+    if (c.nc == NULL) return;
+    _bench("ncodec_write", params, BENCH_PDU_COUNT, _ncodec_write, &c);
+
+    /* Read back the stream written by the last iteration. */
+    _bench("ncodec_read", params, BENCH_PDU_COUNT, _ncodec_read, &c);
+    ncodec_truncate(c.nc);
+}
+
+
+static void _instantiate_free(void* ctx, size_t iterations)
+{
+    size_t n = *(size_t*)ctx;
+    char   resources[PATH_MAX];
+    snprintf(resources, sizeof(resources), BENCH_DATA_DIR "/%zu/resources", n);
+    for (size_t i = 0; i < iterations; i++) {
+        fmi2Component fmu = fmi2Instantiate("bench", fmi2CoSimulation,
+            "{bench}", resources, NULL, false, false);
+        fmi2FreeInstance(fmu);
+    }
+}
+
+static void _bench_instantiate(void)
+{
+    static size_t n[] = { 10, 100, 1000, 10000 };
+    char          params[64];
+    char          dir[PATH_MAX];
+
+    for (size_t j = 0; j < ARRAY_SIZE(n); j++) {
+        snprintf(dir, sizeof(dir), BENCH_DATA_DIR "/%zu", n[j]);
+        if (_write_model(dir, n[j])) continue;
+        snprintf(params, sizeof(params), "vars=%zu", 2 * n[j] + BinaryCount);
+        _bench("fmi2Instantiate", params, 2 * n[j] + BinaryCount,
+            _instantiate_free, &n[j]);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    fmi2Component fmu = _instantiate(BENCH_SCALARS);
+    if (fmu == NULL) {
+        fprintf(stderr, "ERROR: Could not instantiate the benchmark FMU\n");
+        return EINVAL;
+    }
+    _bench_real(fmu);
+    _bench_string(fmu);
+    _bench_do_step(fmu);
+    _bench_ncodec(fmu);
+    fmi2FreeInstance(fmu);
+    _bench_instantiate();
+
+    FILE* f = stdout;
+    if (argc > 1) {
+        f = fopen(argv[1], "w");
+        if (f == NULL) {
+            fprintf(stderr, "ERROR: Could not open %s\n", argv[1]);
+            return errno ? errno : EINVAL;
+        }
+    }
+    int rc = _write_json(f);
+    if (f != stdout) fclose(f);
+    return rc;
+}
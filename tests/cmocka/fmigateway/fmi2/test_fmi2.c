@@ -2,8 +2,11 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <time.h>
+#include <sys/wait.h>
 #include <dse/testing.h>
 #include <fmi2Functions.h>
 #include <fmi2FunctionTypes.h>
@@ -286,6 +289,39 @@ void test_fmigateway__fmi2_BINARY(void** state)
 }
 
 
+void test_fmigateway__fmi2_step_catchup(void** state)
+{
+    fmi2_setup* setup = *state;
+
+    FmuInstanceData* inst = fmi2Instantiate(setup->instance_name,
+        setup->fmu_type, setup->fmu_guid, setup->fmu_resource_location,
+        setup->functions, setup->visible, setup->logging_on);
+
+    fmi2ExitInitializationMode(inst);
+    FmiGateway* fmi_gw = inst->data;
+    assert_double_equal(fmi_gw->sync.step_size, 0.0005, 0.0);
+
+    /* Finer FMU step, steps before the next SimBus sync are skipped. */
+    fmi2DoStep(inst, 0.0, 0.00025, 0);
+    assert_double_equal(fmi_gw->sync.next, 0.0005, 1e-12);
+    fmi2DoStep(inst, 0.00025, 0.00025, 0);
+    assert_int_equal(fmi_gw->stats.steps, 1);
+    assert_int_equal(fmi_gw->stats.skip_count, 1);
+    fmi2DoStep(inst, 0.0005, 0.00025, 0);
+    assert_int_equal(fmi_gw->stats.steps, 2);
+    assert_double_equal(fmi_gw->sync.next, 0.001, 1e-12);
+
+    /* Coarser FMU step, several SimBus steps are coalesced in one sync. */
+    fmi2DoStep(inst, 0.0015, 0.001, 0);
+    assert_int_equal(fmi_gw->stats.steps, 3);
+    assert_int_equal(fmi_gw->stats.coalesce_count, 1);
+    assert_int_equal(fmi_gw->stats.skip_count, 1);
+    assert_double_equal(fmi_gw->sync.next, 0.002, 1e-12);
+
+    fmi2FreeInstance(inst);
+}
+
+
 void test_fmigateway__fmi2_runtime_simer(void** state)
 {
     fmi2_setup* setup = *state;
@@ -393,6 +429,65 @@ void test_fmigateway__fmi2_runtime_legacy(void** state)
 }
 
 
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+void test_fmigateway__fmi2_session_processes(void** state)
+{
+    UNUSED(state);
+
+    /* A process (i.e. the simbus) which runs for a short time, the extra
+       arguments of the cmd are ignored (positional parameters of sh). The
+       yaml argument is longer than the fixed cmd buffers. */
+    char* yaml = calloc(4096 + 1, sizeof(char));
+    memset(yaml, 'x', 4096);
+    WindowsModel simbus = {
+        .exe = "sh -c 'sleep 0.2' simbus",
+        .name = "simbus",
+        .step_size = 0.0005,
+        .end_time = 0.1,
+        .log_level = 5,
+        .timeout = 60,
+        .yaml = yaml,
+    };
+    FmiGatewaySession session = { .simbus = &simbus };
+    FmiGateway        fmi_gw = { .state = FMIGATEWAY_STATE_CREATED };
+    fmi_gw.settings.session = &session;
+    FmuInstanceData fmu = { .data = &fmi_gw };
+    fmu.instance.resource_location = (char*)".";
+
+    /* Spawn, the process is ready (running). */
+    fmigateway_start_models(&fmu);
+    assert_non_null(simbus.w_process);
+    pid_t pid = *(pid_t*)simbus.w_process;
+    assert_int_equal(kill(pid, 0), 0);
+
+    /* Shutdown, the process exits by itself (i.e. is not killed). */
+    double start = _now();
+    fmigateway_shutdown_models(&fmu);
+    assert_null(simbus.w_process);
+    assert_true(_now() - start < 5.0);
+    assert_int_equal(waitpid(pid, NULL, WNOHANG), -1);
+
+    /* Shutdown of a process which was already reaped (ECHILD). */
+    fmigateway_start_models(&fmu);
+    assert_non_null(simbus.w_process);
+    pid = *(pid_t*)simbus.w_process;
+    assert_int_equal(waitpid(pid, NULL, 0), pid);
+    start = _now();
+    fmigateway_shutdown_models(&fmu);
+    assert_null(simbus.w_process);
+    assert_true(_now() - start < 5.0);
+
+    free(yaml);
+}
+
+
 int run_fmigateway__fmi2_tests(void)
 {
     void* s = test_fmigateway__fmi2_setup;
@@ -406,10 +501,13 @@ int run_fmigateway__fmi2_tests(void)
             test_fmigateway__fmi2_ExitInitializationMode, s, t),
         cmocka_unit_test_setup_teardown(test_fmigateway__fmi2_DOUBLE, s, t),
         cmocka_unit_test_setup_teardown(test_fmigateway__fmi2_BINARY, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_fmigateway__fmi2_step_catchup, s, t),
         cmocka_unit_test_setup_teardown(
             test_fmigateway__fmi2_runtime_simer, s, t),
         cmocka_unit_test_setup_teardown(
             test_fmigateway__fmi2_runtime_legacy, ls, t),
+        cmocka_unit_test(test_fmigateway__fmi2_session_processes),
     };
 
     return cmocka_run_group_tests_name("engine", tests, NULL, NULL);
@@ -23,6 +23,7 @@ int test_fmigateway__fmi2_xml_setup(void** state)
 
     hashmap_init(&fmu->variables.string.input);
     hashmap_init(&fmu->variables.scalar.input);
+    hashmap_init(&fmu->variables.scalar.output);
 
     *state = fmu;
     return 0;
@@ -40,6 +41,7 @@ int test_fmigateway__fmi2_xml_default_setup(void** state)
 
     hashmap_init(&fmu->variables.string.input);
     hashmap_init(&fmu->variables.scalar.input);
+    hashmap_init(&fmu->variables.scalar.output);
 
     *state = fmu;
     return 0;
@@ -64,9 +66,11 @@ int test_fmigateway__fmi2_xml_teardown(void** state)
         free(e->default_value);
     }
     free(fmi_gw->settings.scripts.envar);
+    fmigateway_stats_destroy(fmi_gw);
 
     hashmap_destroy(&fmu->variables.string.input);
     hashmap_destroy(&fmu->variables.scalar.input);
+    hashmap_destroy(&fmu->variables.scalar.output);
 
     free(fmu->instance.resource_location);
     free((char*)fmi_gw->settings.model_name);
@@ -163,6 +167,58 @@ void test_fmigateway__fmi2_xml_script_envar_without_session(void** state)
     assert_null(fmi_gw->settings.session);
 }
 
+void test_fmigateway__fmi2_xml_stats(void** state)
+{
+    FmuInstanceData* fmu = *state;
+    FmiGateway*      fmi_gw = fmu->data;
+
+    fmigateway_parse_xml(fmu);
+
+    /* Stats variables are indexed as scalar outputs (after the scalar
+       signals), a colliding vref is rejected. */
+    double signal = 42.0;
+    hashmap_set(&fmu->variables.scalar.output, "101", &signal);
+    fmigateway_stats_index(fmu);
+    FmiGatewayStatsVariable* v = fmi_gw->stats.variables;
+    assert_non_null(v);
+    assert_string_equal(v[0].vref, "100");
+    assert_int_equal(v[0].metric, FMIGATEWAY_STATS_SYNC_LATENCY_MEAN);
+    assert_string_equal(v[1].vref, "101");
+    assert_int_equal(v[1].metric, FMIGATEWAY_STATS_SYNC_LATENCY_P99);
+    assert_string_equal(v[2].vref, "102");
+    assert_int_equal(v[2].metric, FMIGATEWAY_STATS_BEHIND_COUNT);
+    assert_null(v[3].vref);
+    assert_ptr_equal(
+        v[2].value, hashmap_get(&fmu->variables.scalar.output, "102"));
+    assert_null(v[1].value);
+    assert_ptr_equal(
+        hashmap_get(&fmu->variables.scalar.output, "101"), &signal);
+
+    /* Record some steps and publish. */
+    fmigateway_stats_record(fmi_gw, 0.000010, false, 64);
+    fmigateway_stats_record(fmi_gw, 0.000030, true, 0);
+    fmigateway_stats_record(fmi_gw, 0.000500, false, 32);
+    fmigateway_stats_publish(fmi_gw);
+    assert_int_equal(fmi_gw->stats.steps, 3);
+    assert_int_equal(fmi_gw->stats.bytes_total, 96);
+    assert_double_equal(*v[0].value, 0.000180, 1e-9);
+    assert_double_equal(signal, 42.0, 0.0);
+    assert_double_equal(*v[2].value, 1.0, 0.0);
+    assert_double_equal(
+        fmigateway_stats_percentile(fmi_gw, 0.5), 0.000032, 1e-9);
+
+    /* Catch-up and coalescing counters. */
+    fmigateway_stats_skip(fmi_gw);
+    fmigateway_stats_coalesce(fmi_gw, 3);
+    assert_int_equal(fmi_gw->stats.skip_count, 1);
+    assert_int_equal(fmi_gw->stats.coalesce_count, 3);
+    assert_int_equal(fmi_gw->stats.steps, 3);
+    assert_int_equal(
+        fmigateway_stats_metric("skip_count"), FMIGATEWAY_STATS_SKIP_COUNT);
+    assert_int_equal(fmigateway_stats_metric("coalesce_count"),
+        FMIGATEWAY_STATS_COALESCE_COUNT);
+}
+
 
 int run_fmigateway__fmi2_xml_parsing_tests(void)
 {
@@ -184,6 +240,7 @@ int run_fmigateway__fmi2_xml_parsing_tests(void)
             test_fmigateway__fmi2_xml_default_setup, t),
         cmocka_unit_test_setup_teardown(
             test_fmigateway__fmi2_xml_script_envar_without_session, s, t),
+        cmocka_unit_test_setup_teardown(test_fmigateway__fmi2_xml_stats, s, t),
     };
 
     return cmocka_run_group_tests_name("FMI2_XML_PARSING", tests, NULL, NULL);
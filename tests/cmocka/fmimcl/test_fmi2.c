@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <dse/testing.h>
+#include <errno.h>
 #include <dse/logger.h>
 #include <dse/clib/util/yaml.h>
 #include <dse/modelc/runtime.h>
@@ -495,6 +496,229 @@ void test_fmi2__api(void** state)
 }
 
 
+void test_fmi2__step_ratio(void** state)
+{
+    Fmi2Mock* mock = *state;
+    FmuModel* fmu_model = &mock->model;
+    int       rc;
+
+    double       source[2] = { 1.0, 0.0 };
+    MarshalGroup mg[] = {
+        {
+            .name = (char*)"double_tx",
+            .kind = MARSHAL_KIND_PRIMITIVE,
+            .dir = MARSHAL_DIRECTION_TXONLY,
+            .type = MARSHAL_TYPE_DOUBLE,
+            .count = 1,
+            .target = {
+                .ref = calloc(1, sizeof(uint32_t)),
+                ._double = calloc(1, sizeof(double)),
+            },
+            .source = { .offset = 0, .scalar = source },
+        },
+        {
+            .name = (char*)"double_rx",
+            .kind = MARSHAL_KIND_PRIMITIVE,
+            .dir = MARSHAL_DIRECTION_RXONLY,
+            .type = MARSHAL_TYPE_DOUBLE,
+            .count = 1,
+            .target = {
+                .ref = calloc(1, sizeof(uint32_t)),
+                ._double = calloc(1, sizeof(double)),
+            },
+            .source = { .offset = 1, .scalar = source },
+        },
+        { NULL },
+    };
+    mg[0].target.ref[0] = 0;
+    mg[1].target.ref[0] = 1;
+
+    fmu_model->data.mg_table = mg;
+    fmu_model->multirate.ratio = 3;
+    fmi2mcl_create(fmu_model);
+    rc = fmu_model->mcl.vtable.load((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    rc = fmu_model->mcl.vtable.init((void*)fmu_model);
+    assert_int_equal(rc, 0);
+
+    /* FMU (vr_1 = vr_0 + vr_1 + 1) is only stepped on every 3rd step. */
+    double expect[] = { 0.0, 0.0, 2.0, 2.0, 2.0, 4.0 };
+    double model_time = 0.0;
+    for (size_t i = 0; i < ARRAY_SIZE(expect); i++) {
+        rc = fmu_model->mcl.vtable.marshal_out((void*)fmu_model);
+        assert_int_equal(rc, 0);
+        rc = fmu_model->mcl.vtable.step(
+            (void*)fmu_model, &model_time, model_time + 0.5);
+        assert_int_equal(rc, 0);
+        assert_double_equal(model_time, (i + 1) * 0.5, 0.0);
+        rc = fmu_model->mcl.vtable.marshal_in((void*)fmu_model);
+        assert_int_equal(rc, 0);
+        assert_double_equal(source[1], expect[i], 0.0);
+    }
+    assert_int_equal(fmu_model->multirate.fmu_steps, 2);
+    assert_int_equal(fmu_model->multirate.steps_skipped, 4);
+    assert_int_equal(fmu_model->multirate.outputs_held, 4);
+
+    rc = fmu_model->mcl.vtable.unload((void*)fmu_model);
+    assert_int_equal(rc, 0);
+
+    /* Cleanup. */
+    free(mg[0].target.ref);
+    free(mg[1].target.ref);
+    free(mg[0].target.ptr);
+    free(mg[1].target.ptr);
+}
+
+
+static int     _do_step_count;
+static int     _free_instance_count;
+static int32_t _async_status;
+
+static int32_t _pending_do_step(void* c, double t, double h, int32_t no_prior)
+{
+    UNUSED(c);
+    UNUSED(t);
+    UNUSED(h);
+    UNUSED(no_prior);
+    _do_step_count += 1;
+    return fmi2Pending;
+}
+
+static int32_t _pending_get_status(void* c, int32_t kind, int32_t* status)
+{
+    UNUSED(c);
+    assert_int_equal(kind, fmi2DoStepStatus);
+    *status = _async_status;
+    return fmi2OK;
+}
+
+static void _counting_free_instance(void* c)
+{
+    UNUSED(c);
+    _free_instance_count += 1;
+}
+
+void test_fmi2__async_step(void** state)
+{
+    Fmi2Mock* mock = *state;
+    FmuModel* fmu_model = &mock->model;
+    int       rc;
+
+    double       source[2] = { 1.0, 0.0 };
+    MarshalGroup mg[] = {
+        {
+            .name = (char*)"double_tx",
+            .kind = MARSHAL_KIND_PRIMITIVE,
+            .dir = MARSHAL_DIRECTION_TXONLY,
+            .type = MARSHAL_TYPE_DOUBLE,
+            .count = 1,
+            .target = {
+                .ref = calloc(1, sizeof(uint32_t)),
+                ._double = calloc(1, sizeof(double)),
+            },
+            .source = { .offset = 0, .scalar = source },
+        },
+        {
+            .name = (char*)"double_rx",
+            .kind = MARSHAL_KIND_PRIMITIVE,
+            .dir = MARSHAL_DIRECTION_RXONLY,
+            .type = MARSHAL_TYPE_DOUBLE,
+            .count = 1,
+            .target = {
+                .ref = calloc(1, sizeof(uint32_t)),
+                ._double = calloc(1, sizeof(double)),
+            },
+            .source = { .offset = 1, .scalar = source },
+        },
+        { NULL },
+    };
+    mg[0].target.ref[0] = 0;
+    mg[1].target.ref[0] = 1;
+
+    fmu_model->data.mg_table = mg;
+    fmu_model->async_step = true;
+    fmi2mcl_create(fmu_model);
+    rc = fmu_model->mcl.vtable.load((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    rc = fmu_model->mcl.vtable.init((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    Fmi2Adapter* adapter = fmu_model->adapter;
+    assert_ptr_equal(adapter->callbacks.componentEnvironment, fmu_model);
+
+    /* The example FMU is synchronous, DoStep and GetStatus are replaced so
+       that the FMU returns fmi2Pending. */
+    fmi2FreeInstance free_instance = adapter->vtable.free_instance;
+    adapter->vtable.do_step = _pending_do_step;
+    adapter->vtable.free_instance = _counting_free_instance;
+    adapter->async.get_status = _pending_get_status;
+    _do_step_count = 0;
+    _free_instance_count = 0;
+
+    /* Step returns pending. */
+    double model_time = 0.0;
+    _async_status = fmi2Pending;
+    rc = fmu_model->mcl.vtable.marshal_out((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    rc = fmu_model->mcl.vtable.step((void*)fmu_model, &model_time, 1.0);
+    assert_int_equal(rc, 0);
+    assert_int_equal(_do_step_count, 1);
+    assert_true(adapter->async.pending);
+    assert_double_equal(model_time, 1.0, 0.0);
+
+    /* Outputs are not collected while the step is pending. */
+    rc = fmu_model->mcl.vtable.marshal_in((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    assert_double_equal(source[1], 0.0, 0.0);
+
+    /* Step finished (fmi2GetStatus), the wait completes at marshal out. */
+    _async_status = fmi2OK;
+    rc = fmu_model->mcl.vtable.marshal_out((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    assert_false(adapter->async.pending);
+
+    /* Step finished (callback). */
+    _async_status = fmi2Pending;
+    rc = fmu_model->mcl.vtable.step((void*)fmu_model, &model_time, 2.0);
+    assert_int_equal(rc, 0);
+    assert_true(adapter->async.pending);
+    adapter->callbacks.stepFinished(
+        adapter->callbacks.componentEnvironment, fmi2OK);
+    rc = fmu_model->mcl.vtable.marshal_out((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    assert_false(adapter->async.pending);
+
+    /* Step never finishes, the wait times out and the instance fails. */
+    fmu_model->async_timeout = 0.01;
+    rc = fmu_model->mcl.vtable.step((void*)fmu_model, &model_time, 3.0);
+    assert_int_equal(rc, 0);
+    assert_int_equal(_do_step_count, 3);
+    rc = fmu_model->mcl.vtable.marshal_out((void*)fmu_model);
+    assert_int_equal(rc, ETIMEDOUT);
+    assert_true(adapter->async.failed);
+
+    /* A failed instance is neither stepped nor freed. */
+    rc = fmu_model->mcl.vtable.marshal_out((void*)fmu_model);
+    assert_int_equal(rc, ECANCELED);
+    rc = fmu_model->mcl.vtable.step((void*)fmu_model, &model_time, 4.0);
+    assert_int_equal(rc, ECANCELED);
+    assert_int_equal(_do_step_count, 3);
+    rc = fmu_model->mcl.vtable.unload((void*)fmu_model);
+    assert_int_equal(rc, 0);
+    assert_int_equal(_free_instance_count, 0);
+    assert_ptr_equal(fmu_model->adapter, adapter);
+
+    /* The test FMU is not running, release it. */
+    free_instance(adapter->fmi2_inst);
+    free(adapter);
+
+    /* Cleanup. */
+    free(mg[0].target.ref);
+    free(mg[1].target.ref);
+    free(mg[0].target.ptr);
+    free(mg[1].target.ptr);
+}
+
+
 int run_fmi2_tests(void)
 {
     void* s = test_fmi2_setup;
@@ -505,6 +729,8 @@ int run_fmi2_tests(void)
         cmocka_unit_test_setup_teardown(test_fmi2__interface, s, t),
         cmocka_unit_test_setup_teardown(test_fmi2__lifecycle, s, t),
         cmocka_unit_test_setup_teardown(test_fmi2__api, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi2__step_ratio, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi2__async_step, s, t),
     };
 
     return cmocka_run_group_tests_name("fmi2", tests, NULL, NULL);
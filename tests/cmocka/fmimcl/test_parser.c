@@ -103,6 +103,7 @@ void test_parser__fmu_model(void** state)
     assert_string_equal(fmu_model->version, "1.48");
     assert_int_equal(fmu_model->cosim, true);
     assert_double_equal(fmu_model->mcl.step_size, 0.0001, 0.0);
+    assert_int_equal(fmu_model->multirate.ratio, 4);
     assert_non_null(fmu_model->guid);
     assert_string_equal(
         fmu_model->guid, "{11111111-2222-3333-4444-555555555555}");
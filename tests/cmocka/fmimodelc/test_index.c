@@ -95,7 +95,11 @@ void test_index__binary(void** state)
     assert_non_null(index.sbv);
 
     /* Index the network signals. */
-    fmimodelc_index_binary_signals(&fmu);
+    FmuAnnotationIndex* annotations = fmu_annotation_index_create(m->model.sim);
+    assert_non_null(annotations);
+    assert_true(annotations->map.used_nodes > 0);
+    fmimodelc_index_binary_signals(&fmu, annotations);
+    fmu_annotation_index_destroy(annotations);
     assert_int_equal(fmu.variables.binary.rx.used_nodes, 4);
     assert_int_equal(fmu.variables.binary.tx.used_nodes, 4);
 
@@ -138,6 +142,36 @@ void test_index__binary(void** state)
 }
 
 
+void test_index__worker_pool_size(void** state)
+{
+    UNUSED(state);
+
+    struct {
+        const char* value;
+        uint32_t    size;
+    } tc[] = {
+        { .value = NULL, .size = 1 },
+        { .value = "", .size = 1 },
+        { .value = "4", .size = 4 },
+        { .value = "64", .size = 64 },
+        { .value = "0", .size = 1 },
+        { .value = "-2", .size = 1 },
+        { .value = "65", .size = 1 },
+        { .value = "4x", .size = 1 },
+        { .value = "99999999999999999999", .size = 1 },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        if (tc[i].value) {
+            setenv("FMIMODELC_WORKER_POOL_SIZE", tc[i].value, true);
+        } else {
+            unsetenv("FMIMODELC_WORKER_POOL_SIZE");
+        }
+        assert_int_equal(fmimodelc_worker_pool_size(), tc[i].size);
+    }
+    unsetenv("FMIMODELC_WORKER_POOL_SIZE");
+}
+
+
 int run_index_tests(void)
 {
     void* s = test_index_setup;
@@ -146,6 +180,7 @@ int run_index_tests(void)
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_index__scalar, s, t),
         cmocka_unit_test_setup_teardown(test_index__binary, s, t),
+        cmocka_unit_test_setup_teardown(test_index__worker_pool_size, s, t),
     };
 
     return cmocka_run_group_tests_name("INDEX", tests, NULL, NULL);
@@ -12,6 +12,9 @@
 
 
 FmuInstanceData* captured_fmu_instance;
+double           mock_early_return_time = -1;
+double           mock_intermediate_update_time = -1;
+int32_t          mock_step_rc = 0;
 
 static void _test_fmu_setup(FmuInstanceData* fmu)
 {
@@ -71,10 +74,15 @@ int32_t fmu_init(FmuInstanceData* fmu)
 int32_t fmu_step(
     FmuInstanceData* fmu, double communication_point, double step_size)
 {
-    UNUSED(fmu);
     UNUSED(communication_point);
     UNUSED(step_size);
-    return 0;
+    if (mock_intermediate_update_time >= 0) {
+        fmu_intermediate_update(fmu, mock_intermediate_update_time, true);
+    }
+    if (mock_early_return_time >= 0) {
+        fmu_request_early_return(fmu, mock_early_return_time);
+    }
+    return mock_step_rc;
 }
 
 int32_t fmu_destroy(FmuInstanceData* fmu)
@@ -24,6 +24,9 @@ typedef enum {
 
 
 extern FmuInstanceData* captured_fmu_instance;
+extern double           mock_early_return_time;
+extern double           mock_intermediate_update_time;
+extern int32_t          mock_step_rc;
 
 void __wrap_fmu_load_signal_handlers(FmuInstanceData* fmu);
 
@@ -130,6 +130,9 @@ void test_fmi2Instantiate_returned_new_instance(void** state)
         setup->visible, setup->logging_on);
 
     assert_ptr_not_equal(captured_fmu_instance, inst);
+    /* Typed variables are not indexed for FMI 2 FMUs. */
+    assert_null(fmu_lookup_typed_var(
+        (FmuInstanceData*)inst, 11, false, FmuSignalInt32));
     fmi2FreeInstance(inst);
 }
 
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <errno.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <dlfcn.h>
@@ -276,6 +277,573 @@ void test_fmi3FreeInstance_returned_error(void** state)
     fmi3FreeInstance(inst);
 }
 
+extern void __real_fmu_load_signal_handlers(FmuInstanceData* fmu);
+
+void test_fmi3_typed_variables(void** state)
+{
+    UNUSED(state);
+
+    FmuInstanceData* fmu = calloc(1, sizeof(FmuInstanceData));
+    hashmap_init(&fmu->variables.scalar.input);
+    hashmap_init(&fmu->variables.scalar.output);
+    hashmap_init(&fmu->variables.typed.input);
+    hashmap_init(&fmu->variables.typed.output);
+    hashmap_init(&fmu->variables.binary.rx);
+    hashmap_init(&fmu->variables.binary.tx);
+    hashmap_init(&fmu->variables.binary.encode_func);
+    hashmap_init(&fmu->variables.binary.decode_func);
+    fmu->instance.resource_location = (char*)"data/test_fmu3/resources";
+    __real_fmu_load_signal_handlers(fmu);
+    fmu->variables.vtable.setup(fmu);
+
+    // Index.
+    assert_int_equal(hashmap_number_keys(fmu->variables.scalar.input), 1);
+    assert_int_equal(hashmap_number_keys(fmu->variables.scalar.output), 1);
+    assert_int_equal(hashmap_number_keys(fmu->variables.typed.input), 3);
+    assert_int_equal(hashmap_number_keys(fmu->variables.typed.output), 3);
+    int32_t* counter = fmu_lookup_typed_var(fmu, 11, false, FmuSignalInt32);
+    bool*    flag = fmu_lookup_typed_var(fmu, 21, false, FmuSignalBoolean);
+    int64_t* ticks = fmu_lookup_typed_var(fmu, 30, false, FmuSignalInt64);
+    assert_non_null(counter);
+    assert_non_null(flag);
+    assert_non_null(ticks);
+    assert_null(fmu_lookup_typed_var(fmu, 11, false, FmuSignalInt64));
+    assert_null(fmu_lookup_typed_var(fmu, 11, true, FmuSignalInt32));
+
+    // Set/Get inputs.
+    fmi3Int32 i32[1] = { -42 };
+    fmi3UInt8 u8[1] = { 200 };
+    fmi3Boolean b[2] = { true, false };
+    assert_int_equal(
+        fmi3SetInt32(fmu, (fmi3ValueReference[]){ 10 }, 1, i32, 1), fmi3OK);
+    assert_int_equal(
+        fmi3SetUInt8(fmu, (fmi3ValueReference[]){ 12 }, 1, u8, 1), fmi3OK);
+    assert_int_equal(
+        fmi3SetBoolean(fmu, (fmi3ValueReference[]){ 20 }, 1, b, 1), fmi3OK);
+    i32[0] = 0;
+    u8[0] = 0;
+    b[0] = false;
+    assert_int_equal(
+        fmi3GetInt32(fmu, (fmi3ValueReference[]){ 10 }, 1, i32, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetUInt8(fmu, (fmi3ValueReference[]){ 12 }, 1, u8, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetBoolean(fmu, (fmi3ValueReference[]){ 20 }, 1, b, 1), fmi3OK);
+    assert_int_equal(i32[0], -42);
+    assert_int_equal(u8[0], 200);
+    assert_true(b[0]);
+
+    // Get outputs (set by the FMU).
+    *counter = 7;
+    *flag = true;
+    *ticks = 1ll << 40;
+    fmi3Int64 i64[1] = { 0 };
+    assert_int_equal(
+        fmi3GetInt32(fmu, (fmi3ValueReference[]){ 11 }, 1, i32, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetBoolean(fmu, (fmi3ValueReference[]){ 20, 21 }, 2, b, 2), fmi3OK);
+    assert_int_equal(
+        fmi3GetInt64(fmu, (fmi3ValueReference[]){ 30 }, 1, i64, 1), fmi3OK);
+    assert_int_equal(i32[0], 7);
+    assert_true(b[0]);
+    assert_true(b[1]);
+    assert_int_equal(i64[0], 1ll << 40);
+
+    // Type mismatch.
+    fmi3Int8 i8[1] = { 0 };
+    assert_int_equal(
+        fmi3GetInt8(fmu, (fmi3ValueReference[]){ 10 }, 1, i8, 1), fmi3Error);
+    assert_int_equal(
+        fmi3SetInt8(fmu, (fmi3ValueReference[]){ 10 }, 1, i8, 1), fmi3Error);
+
+    // Scalar (double) variables are converted.
+    fmi3Float64 f64[1] = { 0 };
+    i32[0] = 5;
+    assert_int_equal(
+        fmi3SetInt32(fmu, (fmi3ValueReference[]){ 1 }, 1, i32, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetFloat64(fmu, (fmi3ValueReference[]){ 1 }, 1, f64, 1), fmi3OK);
+    assert_double_equal(f64[0], 5.0, 0.0);
+    b[0] = false;
+    assert_int_equal(
+        fmi3GetBoolean(fmu, (fmi3ValueReference[]){ 1 }, 1, b, 1), fmi3OK);
+    assert_true(b[0]);
+
+    // Conversions from double are clamped to the range of the type.
+    fmi3UInt64 u64[1] = { 0 };
+    f64[0] = 300.0;
+    assert_int_equal(
+        fmi3SetFloat64(fmu, (fmi3ValueReference[]){ 1 }, 1, f64, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetUInt8(fmu, (fmi3ValueReference[]){ 1 }, 1, u8, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetInt8(fmu, (fmi3ValueReference[]){ 1 }, 1, i8, 1), fmi3OK);
+    assert_int_equal(u8[0], UINT8_MAX);
+    assert_int_equal(i8[0], INT8_MAX);
+    f64[0] = -1e30;
+    assert_int_equal(
+        fmi3SetFloat64(fmu, (fmi3ValueReference[]){ 1 }, 1, f64, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetInt64(fmu, (fmi3ValueReference[]){ 1 }, 1, i64, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetUInt64(fmu, (fmi3ValueReference[]){ 1 }, 1, u64, 1), fmi3OK);
+    assert_true(i64[0] == INT64_MIN);
+    assert_int_equal(u64[0], 0);
+    f64[0] = 1e30;
+    assert_int_equal(
+        fmi3SetFloat64(fmu, (fmi3ValueReference[]){ 1 }, 1, f64, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetInt64(fmu, (fmi3ValueReference[]){ 1 }, 1, i64, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetUInt64(fmu, (fmi3ValueReference[]){ 1 }, 1, u64, 1), fmi3OK);
+    assert_true(i64[0] == INT64_MAX);
+    assert_true(u64[0] == UINT64_MAX);
+    f64[0] = NAN;
+    assert_int_equal(
+        fmi3SetFloat64(fmu, (fmi3ValueReference[]){ 1 }, 1, f64, 1), fmi3OK);
+    assert_int_equal(
+        fmi3GetInt32(fmu, (fmi3ValueReference[]){ 1 }, 1, i32, 1), fmi3OK);
+    assert_int_equal(i32[0], 0);
+
+    fmu->variables.vtable.remove(fmu);
+    hashmap_destroy(&fmu->variables.scalar.input);
+    hashmap_destroy(&fmu->variables.scalar.output);
+    hashmap_destroy(&fmu->variables.typed.input);
+    hashmap_destroy(&fmu->variables.typed.output);
+    hashmap_destroy(&fmu->variables.binary.rx);
+    hashmap_destroy(&fmu->variables.binary.tx);
+    hashmap_destroy(&fmu->variables.binary.encode_func);
+    hashmap_destroy(&fmu->variables.binary.decode_func);
+    free(fmu);
+}
+
+void test_fmi3_binary_variables(void** state)
+{
+    UNUSED(state);
+
+    FmuInstanceData* fmu = calloc(1, sizeof(FmuInstanceData));
+    hashmap_init(&fmu->variables.scalar.input);
+    hashmap_init(&fmu->variables.scalar.output);
+    hashmap_init(&fmu->variables.typed.input);
+    hashmap_init(&fmu->variables.typed.output);
+    hashmap_init(&fmu->variables.binary.rx);
+    hashmap_init(&fmu->variables.binary.tx);
+    hashmap_init(&fmu->variables.binary.encode_func);
+    hashmap_init(&fmu->variables.binary.decode_func);
+    fmu->instance.resource_location = (char*)"data/test_fmu3_binary/resources";
+    __real_fmu_load_signal_handlers(fmu);
+    fmu->variables.vtable.setup(fmu);
+
+    // Index.
+    assert_int_equal(hashmap_number_keys(fmu->variables.scalar.input), 1);
+    assert_int_equal(hashmap_number_keys(fmu->variables.binary.rx), 2);
+    assert_int_equal(hashmap_number_keys(fmu->variables.binary.tx), 1);
+    FmuSignalVector* sv = fmu->data;
+    while (sv->signal && sv->type != FmuSignalBinary)
+        sv++;
+    assert_non_null(sv->signal);
+    assert_int_equal(sv->count, 3);
+    assert_string_equal(sv->signal[0], "bar_1");
+    assert_string_equal(sv->signal[1], "bar_2");
+    assert_string_equal(sv->signal[2], "bar_3");
+
+    // vr=4, bar_1 (input): encoding, codec and buffer capacity.
+    assert_ptr_equal(hashmap_get(&fmu->variables.binary.encode_func, "4"),
+        dse_ascii85_encode);
+    assert_ptr_equal(hashmap_get(&fmu->variables.binary.decode_func, "4"),
+        dse_ascii85_decode);
+    assert_string_equal(sv->mime_type[0],
+        "application/x-automotive-bus; interface=stream; "
+        "type=pdu; schema=fbs; swc_id=23; ecu_id=5");
+    assert_non_null(sv->ncodec[0]);
+    assert_true(sv->buffer_size[0] >= 1000);
+
+    // vr=5, bar_2 (output): codec only.
+    assert_null(hashmap_get(&fmu->variables.binary.encode_func, "5"));
+    assert_null(hashmap_get(&fmu->variables.binary.decode_func, "5"));
+    assert_non_null(sv->mime_type[1]);
+    assert_non_null(sv->ncodec[1]);
+    assert_int_equal(sv->buffer_size[1], 0);
+
+    // vr=6, bar_3 (input): no annotations.
+    assert_null(hashmap_get(&fmu->variables.binary.encode_func, "6"));
+    assert_null(sv->mime_type[2]);
+    assert_null(sv->ncodec[2]);
+    assert_int_equal(sv->buffer_size[2], 0);
+
+    // Set an input (without encoding).
+    uint8_t    payload[] = { 1, 2, 3, 4 };
+    fmi3Binary values[1] = { payload };
+    size_t     sizes[1] = { sizeof(payload) };
+    assert_int_equal(fmi3SetBinary(fmu, (fmi3ValueReference[]){ 6 }, 1, sizes,
+                         values, 1),
+        fmi3OK);
+    assert_int_equal(sv->length[2], sizeof(payload));
+    assert_memory_equal(sv->binary[2], payload, sizeof(payload));
+
+    fmu->variables.vtable.remove(fmu);
+    hashmap_destroy(&fmu->variables.scalar.input);
+    hashmap_destroy(&fmu->variables.scalar.output);
+    hashmap_destroy(&fmu->variables.typed.input);
+    hashmap_destroy(&fmu->variables.typed.output);
+    hashmap_destroy(&fmu->variables.binary.rx);
+    hashmap_destroy(&fmu->variables.binary.tx);
+    hashmap_destroy(&fmu->variables.binary.encode_func);
+    hashmap_destroy(&fmu->variables.binary.decode_func);
+    free(fmu);
+}
+
+extern fmi3Status dseGetChangedFloat64(fmi3Instance instance,
+    const fmi3ValueReference** valueReferences, const fmi3Float64** values,
+    size_t* nValueReferences);
+
+void test_fmi3_changed_outputs(void** state)
+{
+    UNUSED(state);
+
+    FmuInstanceData* fmu = calloc(1, sizeof(FmuInstanceData));
+    hashmap_init(&fmu->variables.scalar.input);
+    hashmap_init(&fmu->variables.scalar.output);
+    hashmap_init(&fmu->variables.typed.input);
+    hashmap_init(&fmu->variables.typed.output);
+    hashmap_init(&fmu->variables.binary.rx);
+    hashmap_init(&fmu->variables.binary.tx);
+    hashmap_init(&fmu->variables.binary.encode_func);
+    hashmap_init(&fmu->variables.binary.decode_func);
+    fmu->instance.resource_location = (char*)"data/test_fmu3/resources";
+    __real_fmu_load_signal_handlers(fmu);
+    fmu->variables.vtable.setup(fmu);
+    double* real_out = hashmap_get(&fmu->variables.scalar.output, "2");
+    assert_non_null(real_out);
+
+    const fmi3ValueReference* vr = NULL;
+    const fmi3Float64*        values = NULL;
+    size_t                    count = 0;
+
+    // First query, all outputs.
+    *real_out = 1.5;
+    assert_int_equal(dseGetChangedFloat64(fmu, &vr, &values, &count), fmi3OK);
+    assert_int_equal(count, 1);
+    assert_int_equal(vr[0], 2);
+    assert_double_equal(values[0], 1.5, 0.0);
+
+    // No change.
+    assert_int_equal(dseGetChangedFloat64(fmu, &vr, &values, &count), fmi3OK);
+    assert_int_equal(count, 0);
+
+    // Changed (inputs are not considered).
+    *real_out = 2.5;
+    fmi3Float64 f64[1] = { 42.0 };
+    fmi3SetFloat64(fmu, (fmi3ValueReference[]){ 1 }, 1, f64, 1);
+    assert_int_equal(dseGetChangedFloat64(fmu, &vr, &values, &count), fmi3OK);
+    assert_int_equal(count, 1);
+    assert_int_equal(vr[0], 2);
+    assert_double_equal(values[0], 2.5, 0.0);
+    assert_int_equal(dseGetChangedFloat64(fmu, &vr, &values, &count), fmi3OK);
+    assert_int_equal(count, 0);
+
+    fmu->variables.vtable.remove(fmu);
+    hashmap_destroy(&fmu->variables.scalar.input);
+    hashmap_destroy(&fmu->variables.scalar.output);
+    hashmap_destroy(&fmu->variables.typed.input);
+    hashmap_destroy(&fmu->variables.typed.output);
+    hashmap_destroy(&fmu->variables.binary.rx);
+    hashmap_destroy(&fmu->variables.binary.tx);
+    hashmap_destroy(&fmu->variables.binary.encode_func);
+    hashmap_destroy(&fmu->variables.binary.decode_func);
+    free(fmu->delta.vr);
+    free(fmu->delta.signal);
+    free(fmu->delta.value);
+    free(fmu->delta.changed_vr);
+    free(fmu->delta.changed_value);
+    free(fmu);
+}
+
+static int32_t _partition_count[2];
+
+static int32_t _partition_1ms(FmuInstanceData* fmu, double activation_time)
+{
+    UNUSED(fmu);
+    UNUSED(activation_time);
+    _partition_count[0] += 1;
+    return 0;
+}
+
+static int32_t _partition_10ms(FmuInstanceData* fmu, double activation_time)
+{
+    UNUSED(fmu);
+    UNUSED(activation_time);
+    _partition_count[1] += 1;
+    return 0;
+}
+
+static double _vt[2];     /* Variable Table. */
+static double _signal[2]; /* Signal Vector storage. */
+static int    _lock_count;
+
+static void _lock_preemption(void)
+{
+    _lock_count += 1;
+}
+
+static void _unlock_preemption(void)
+{
+    _lock_count -= 1;
+}
+
+static int32_t _partition_preempting(
+    FmuInstanceData* fmu, double activation_time)
+{
+    UNUSED(fmu);
+    UNUSED(activation_time);
+    /* Variables of the preempted partition are not visible. */
+    assert_double_equal(_vt[0], _signal[0], 0.0);
+    _vt[1] = 2.0;
+    _partition_count[1] += 1;
+    return 0;
+}
+
+static int32_t _partition_preempted(
+    FmuInstanceData* fmu, double activation_time)
+{
+    _vt[0] = 1.0;
+    assert_int_equal(_lock_count, 0);
+    if (fmi3ActivateModelPartition(fmu, 104, activation_time) != fmi3OK) {
+        return 1;
+    }
+    /* Own state restored, outputs of the preempting partition retained. */
+    assert_double_equal(_vt[0], 1.0, 0.0);
+    assert_double_equal(_vt[1], 2.0, 0.0);
+    assert_double_equal(_signal[0], 0.0, 0.0);
+    assert_double_equal(_signal[1], 2.0, 0.0);
+    /* A partition can not preempt itself. */
+    if (fmi3ActivateModelPartition(fmu, 103, activation_time) != fmi3Error) {
+        return 1;
+    }
+    _partition_count[0] += 1;
+    return 0;
+}
+
+void test_fmi3_model_partitions(void** state)
+{
+    UNUSED(state);
+
+    FmuInstanceData* fmu = calloc(1, sizeof(FmuInstanceData));
+    _partition_count[0] = _partition_count[1] = 0;
+    fmu_register_partition(fmu, 100, 0.001, _partition_1ms);
+    fmu_register_partition(fmu, 101, 0.010, _partition_10ms);
+
+    // Activate the partitions, as scheduled (1 ms and 10 ms).
+    for (int i = 0; i < 20; i++) {
+        double t = i * 0.001;
+        assert_int_equal(fmi3ActivateModelPartition(fmu, 100, t), fmi3OK);
+        if (i % 10 == 0) {
+            assert_int_equal(fmi3ActivateModelPartition(fmu, 101, t), fmi3OK);
+        }
+    }
+    assert_int_equal(_partition_count[0], 20);
+    assert_int_equal(_partition_count[1], 2);
+    assert_int_equal(fmi3ActivateModelPartition(fmu, 102, 0.0), fmi3Error);
+
+    // Preemption, a partition is activated while another is running.
+    FmuVarTableMarshalItem marshal_list[] = {
+        { .variable = &_vt[0], .signal = &_signal[0] },
+        { .variable = &_vt[1], .signal = &_signal[1] },
+        { 0 },
+    };
+    _vt[0] = _vt[1] = _signal[0] = _signal[1] = 0.0;
+    fmu->var_table.marshal_list = marshal_list;
+    fmu->partition.lock_preemption = _lock_preemption;
+    fmu->partition.unlock_preemption = _unlock_preemption;
+    fmu_register_partition(fmu, 103, 0.0, _partition_preempted);
+    fmu_register_partition(fmu, 104, 0.0, _partition_preempting);
+    assert_int_equal(fmi3ActivateModelPartition(fmu, 103, 0.02), fmi3OK);
+    assert_int_equal(_partition_count[0], 21);
+    assert_int_equal(_partition_count[1], 3);
+    assert_int_equal(_lock_count, 0);
+    assert_null(fmu->partition.running);
+    assert_double_equal(_signal[0], 1.0, 0.0);
+    assert_double_equal(_signal[1], 2.0, 0.0);
+    assert_int_equal(fmi3ActivateModelPartition(fmu, 100, 0.02), fmi3OK);
+    assert_int_equal(_partition_count[0], 22);
+    fmu->var_table.marshal_list = NULL;
+
+    // Intervals.
+    fmi3Float64           interval[3];
+    fmi3IntervalQualifier qualifier[3];
+    assert_int_equal(fmi3GetIntervalDecimal(fmu,
+                         (fmi3ValueReference[]){ 100, 101, 102 }, 3, interval,
+                         qualifier),
+        fmi3OK);
+    assert_double_equal(interval[0], 0.001, 0.0);
+    assert_double_equal(interval[1], 0.010, 0.0);
+    assert_int_equal(qualifier[0], fmi3IntervalChanged);
+    assert_int_equal(qualifier[2], fmi3IntervalNotYetKnown);
+    assert_int_equal(fmi3GetIntervalDecimal(fmu, (fmi3ValueReference[]){ 100 },
+                         1, interval, qualifier),
+        fmi3OK);
+    assert_int_equal(qualifier[0], fmi3IntervalUnchanged);
+
+    // Clocks.
+    fmi3Clock clock[2] = { fmi3ClockActive, fmi3ClockInactive };
+    assert_int_equal(
+        fmi3SetClock(fmu, (fmi3ValueReference[]){ 100, 101 }, 2, clock),
+        fmi3OK);
+    clock[0] = fmi3ClockInactive;
+    assert_int_equal(
+        fmi3GetClock(fmu, (fmi3ValueReference[]){ 100, 101 }, 2, clock),
+        fmi3OK);
+    assert_true(clock[0]);
+    assert_false(clock[1]);
+
+    hashmap_destroy(&fmu->partition.map);
+    free(fmu);
+}
+
+static int _intermediate_update_count;
+
+static void _intermediate_update(fmi3InstanceEnvironment instanceEnvironment,
+    fmi3Float64 intermediateUpdateTime,
+    fmi3Boolean intermediateVariableSetRequested,
+    fmi3Boolean intermediateVariableGetAllowed,
+    fmi3Boolean intermediateStepFinished, fmi3Boolean canReturnEarly,
+    fmi3Boolean* earlyReturnRequested, fmi3Float64* earlyReturnTime)
+{
+    UNUSED(instanceEnvironment);
+    UNUSED(intermediateVariableSetRequested);
+    UNUSED(intermediateVariableGetAllowed);
+    UNUSED(intermediateStepFinished);
+    _intermediate_update_count += 1;
+    *earlyReturnRequested = canReturnEarly;
+    *earlyReturnTime = intermediateUpdateTime;
+}
+
+static int32_t _pipeline_stub(FmuInstanceData* fmu, FmuStepFunc step,
+    double communication_point, double step_size)
+{
+    UNUSED(fmu);
+    UNUSED(step);
+    UNUSED(communication_point);
+    UNUSED(step_size);
+    return 0;
+}
+
+void test_fmi3_early_return(void** state)
+{
+    UNUSED(state);
+
+    FmuInstanceData* fmu = calloc(1, sizeof(FmuInstanceData));
+    fmi3Boolean      event = true;
+    fmi3Boolean      terminate = true;
+    fmi3Boolean      early_return = true;
+    fmi3Float64      last_time = 0.0;
+
+    // Not allowed.
+    mock_early_return_time = 0.25;
+    assert_int_equal(fmi3DoStep(fmu, 0.0, 1.0, false, &event, &terminate,
+                         &early_return, &last_time),
+        fmi3OK);
+    assert_false(event);
+    assert_false(terminate);
+    assert_false(early_return);
+    assert_double_equal(last_time, 1.0, 0.0);
+
+    // Allowed, requested by the FMU.
+    fmu->early_return.allowed = true;
+    assert_int_equal(fmi3DoStep(fmu, 1.0, 1.0, false, &event, &terminate,
+                         &early_return, &last_time),
+        fmi3OK);
+    assert_true(early_return);  // Time is before the step, clamped.
+    assert_double_equal(last_time, 1.0, 0.0);
+    mock_early_return_time = 1.25;
+    assert_int_equal(fmi3DoStep(fmu, 1.0, 1.0, false, &event, &terminate,
+                         &early_return, &last_time),
+        fmi3OK);
+    assert_true(early_return);
+    assert_double_equal(last_time, 1.25, 0.0);
+    mock_early_return_time = 2.0;
+    assert_int_equal(fmi3DoStep(fmu, 1.25, 0.75, false, &event, &terminate,
+                         &early_return, &last_time),
+        fmi3OK);
+    assert_false(early_return);  // Time is the end of the step.
+    assert_double_equal(last_time, 2.0, 0.0);
+    mock_early_return_time = -1;
+
+    // Allowed, requested by the importer (intermediate update).
+    fmu->early_return.intermediate_update = _intermediate_update;
+    mock_intermediate_update_time = 2.5;
+    assert_int_equal(fmi3DoStep(fmu, 2.0, 1.0, false, &event, &terminate,
+                         &early_return, &last_time),
+        fmi3OK);
+    assert_true(early_return);
+    assert_double_equal(last_time, 2.5, 0.0);
+    assert_int_equal(_intermediate_update_count, 1);
+    mock_intermediate_update_time = -1;
+
+    // Intermediate update, not made when early return is not allowed or the
+    // step is pipelined (worker thread).
+    fmu->early_return.allowed = false;
+    assert_false(fmu_intermediate_update(fmu, 3.5, true));
+    fmu->early_return.allowed = true;
+    fmu->variables.vtable.pipeline = _pipeline_stub;
+    assert_false(fmu_intermediate_update(fmu, 3.5, true));
+    assert_int_equal(_intermediate_update_count, 1);
+    fmu->variables.vtable.pipeline = NULL;
+
+    free(fmu);
+}
+
+void test_fmi3_pipeline_step_error(void** state)
+{
+    UNUSED(state);
+
+    FmuInstanceData* fmu = calloc(1, sizeof(FmuInstanceData));
+    hashmap_init(&fmu->variables.scalar.input);
+    hashmap_init(&fmu->variables.scalar.output);
+    hashmap_init(&fmu->variables.typed.input);
+    hashmap_init(&fmu->variables.typed.output);
+    hashmap_init(&fmu->variables.binary.rx);
+    hashmap_init(&fmu->variables.binary.tx);
+    hashmap_init(&fmu->variables.binary.encode_func);
+    hashmap_init(&fmu->variables.binary.decode_func);
+    fmu->instance.resource_location = (char*)"data/test_fmu3/resources";
+    setenv("FMU_STEP_PIPELINE", "1", true);
+    __real_fmu_load_signal_handlers(fmu);
+    unsetenv("FMU_STEP_PIPELINE");
+    assert_non_null(fmu->variables.vtable.pipeline);
+    fmu->variables.vtable.setup(fmu);
+
+    // Step 1 fails, the error is reported by the next step.
+    mock_step_rc = -1;
+    assert_int_equal(
+        fmi3DoStep(fmu, 0.0, 1.0, false, NULL, NULL, NULL, NULL), fmi3OK);
+    assert_int_equal(
+        fmi3DoStep(fmu, 1.0, 1.0, false, NULL, NULL, NULL, NULL), fmi3Error);
+
+    // Step 2 fails, the error is reported when the pipeline is completed.
+    assert_int_equal(fmu->variables.vtable.pipeline(fmu, NULL, 0, 0), -1);
+
+    // Errors are only reported once.
+    mock_step_rc = 0;
+    assert_int_equal(
+        fmi3DoStep(fmu, 2.0, 1.0, false, NULL, NULL, NULL, NULL), fmi3OK);
+    assert_int_equal(
+        fmi3DoStep(fmu, 3.0, 1.0, false, NULL, NULL, NULL, NULL), fmi3OK);
+    assert_int_equal(fmu->variables.vtable.pipeline(fmu, NULL, 0, 0), 0);
+
+    fmu->variables.vtable.remove(fmu);
+    assert_null(fmu->variables.pipeline);
+    hashmap_destroy(&fmu->variables.scalar.input);
+    hashmap_destroy(&fmu->variables.scalar.output);
+    hashmap_destroy(&fmu->variables.typed.input);
+    hashmap_destroy(&fmu->variables.typed.output);
+    hashmap_destroy(&fmu->variables.binary.rx);
+    hashmap_destroy(&fmu->variables.binary.tx);
+    hashmap_destroy(&fmu->variables.binary.encode_func);
+    hashmap_destroy(&fmu->variables.binary.decode_func);
+    free(fmu);
+}
+
 int run_fmu3fmi_tests(void)
 {
     void*                   s = test_fmi3fmu_setup;
@@ -294,6 +862,12 @@ int run_fmu3fmi_tests(void)
             test_fmi3Instantiate_short_scheme, s, t),
         cmocka_unit_test_setup_teardown(
             test_fmi3FreeInstance_returned_error, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi3_typed_variables, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi3_binary_variables, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi3_changed_outputs, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi3_model_partitions, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi3_early_return, s, t),
+        cmocka_unit_test_setup_teardown(test_fmi3_pipeline_step_error, s, t),
     };
 
     return cmocka_run_group_tests_name("test_fmi3fmu", tests, NULL, NULL);
@@ -4,7 +4,10 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <unistd.h>
 #include <dse/testing.h>
+#include <dse/ncodec/codec.h>
+#include <dse/ncodec/interface/pdu.h>
 #include <dse/fmu/fmu.h>
 
 
@@ -223,6 +226,307 @@ void test_fmu_lookup_ncodec(void** state)
 }
 
 
+void test_fmu_binary_buffers(void** state)
+{
+    /* Setup the FMU. */
+    FmuInstanceData* fmu = *state;
+    fmu->variables.vtable.setup(fmu);
+    FmuSignalVectorIndex* idx_4 = hashmap_get(&fmu->variables.binary.rx, "4");
+    FmuSignalVectorIndex* idx_5 = hashmap_get(&fmu->variables.binary.tx, "5");
+    assert_non_null(idx_4);
+    assert_non_null(idx_5);
+    FmuSignalVector* sv = idx_4->sv;
+    assert_int_equal(sv->binary_class, FMU_BINARY_SIZE_CLASS);
+
+    /* Presized (annotation), rounded up to a size class. */
+    assert_non_null(sv->binary[idx_4->vi]);
+    assert_int_equal(sv->buffer_size[idx_4->vi], 1024);
+    assert_int_equal(sv->buffer_size[idx_5->vi], 0);
+    assert_int_equal(sv->binary_growth, 0);
+
+    /* Growth by size class. */
+    uint8_t data[100] = {};
+    fmu_sv_binary_append(sv, idx_5->vi, data, 10);
+    assert_int_equal(sv->buffer_size[idx_5->vi], 64);
+    assert_int_equal(sv->binary_growth, 1);
+    fmu_sv_binary_append(sv, idx_5->vi, data, 60);
+    assert_int_equal(sv->length[idx_5->vi], 70);
+    assert_int_equal(sv->buffer_size[idx_5->vi], 128);
+    assert_int_equal(sv->binary_growth, 2);
+    fmu_sv_binary_append(sv, idx_4->vi, data, 100);
+    assert_int_equal(sv->buffer_size[idx_4->vi], 1024);
+    assert_int_equal(sv->binary_growth, 2);
+
+    /* Capacity is retained after reset. */
+    fmu->variables.vtable.reset(fmu);
+    assert_int_equal(sv->length[idx_5->vi], 0);
+    assert_int_equal(sv->buffer_size[idx_5->vi], 128);
+    fmu_sv_binary_append(sv, idx_5->vi, data, 100);
+    assert_int_equal(sv->binary_growth, 2);
+
+    /* Finished. */
+    fmu->variables.vtable.remove(fmu);
+    free(fmu->var_table.table);
+    free(fmu->var_table.marshal_list);
+}
+
+
+void test_fmu_signals_flush(void** state)
+{
+    /* Setup the FMU. */
+    FmuInstanceData* fmu = *state;
+    fmu->variables.vtable.setup(fmu);
+    assert_non_null(fmu->variables.vtable.flush);
+    FmuSignalVectorIndex* idx_5 = hashmap_get(&fmu->variables.binary.tx, "5");
+    assert_non_null(idx_5);
+    NCODEC* nc = fmu_lookup_ncodec(fmu, 5, false);
+    assert_non_null(nc);
+    assert_non_null(fmu->variables.binary.flush_list);
+    assert_ptr_equal(fmu->variables.binary.flush_list[0], nc);
+    assert_null(fmu->variables.binary.flush_list[1]);
+
+    /* Write several PDUs, encoded by the flush. */
+    uint8_t payload[] = { 1, 2, 3, 4, 5 };
+    for (uint32_t id = 1; id <= 10; id++) {
+        ncodec_write(nc, &(struct NCodecPdu){ .id = id,
+                             .payload = payload,
+                             .payload_len = sizeof(payload),
+                             .swc_id = 42 });
+    }
+    assert_int_equal(idx_5->sv->length[idx_5->vi], 0);
+    fmu->variables.vtable.flush(fmu);
+    assert_true(idx_5->sv->length[idx_5->vi] > 0);
+
+    /* Finished. */
+    fmu->variables.vtable.remove(fmu);
+    assert_null(fmu->variables.binary.flush_list);
+    free(fmu->var_table.table);
+    free(fmu->var_table.marshal_list);
+}
+
+
+static int32_t _pipeline_step(
+    FmuInstanceData* fmu, double communication_point, double step_size)
+{
+    UNUSED(step_size);
+    VarTable* v = fmu_var_table(fmu);
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->variable = *mi->signal;
+    }
+
+    /* Step: var_2 = var_1 + time, and send a PDU. */
+    v->var_2 = v->var_1 + communication_point;
+    uint8_t payload[] = { 1, 2, 3 };
+    ncodec_write(fmu_lookup_ncodec(fmu, 5, false),
+        &(struct NCodecPdu){ .id = 42,
+            .payload = payload,
+            .payload_len = sizeof(payload),
+            .swc_id = 42 });
+    fmu->variables.vtable.flush(fmu);
+
+    for (FmuVarTableMarshalItem* mi = fmu->var_table.marshal_list;
+        mi && mi->variable; mi++) {
+        *mi->signal = *mi->variable;
+    }
+    return 0;
+}
+
+void test_fmu_signals_pipeline(void** state)
+{
+    /* Setup the FMU, with a pipelined step. */
+    FmuInstanceData* fmu = *state;
+    setenv("FMU_STEP_PIPELINE", "1", true);
+    fmu_load_signal_handlers(fmu);
+    unsetenv("FMU_STEP_PIPELINE");
+    assert_non_null(fmu->variables.vtable.pipeline);
+    fmu->variables.vtable.setup(fmu);
+    VarTable* vt = malloc(sizeof(VarTable));
+    *vt = (VarTable){
+        .var_1 = fmu_register_var(fmu, 1, true, offsetof(VarTable, var_1)),
+        .var_2 = fmu_register_var(fmu, 2, false, offsetof(VarTable, var_2)),
+    };
+    fmu_register_var_table(fmu, vt);
+    *(double*)hashmap_get(&fmu->variables.scalar.input, "1") = 1;
+
+    /* Step 1, outputs are not yet available. */
+    int32_t rc = fmu->variables.vtable.pipeline(fmu, _pipeline_step, 10, 1);
+    assert_int_equal(rc, 0);
+    assert_non_null(fmu->variables.pipeline);
+    double* var_1 = hashmap_get(&fmu->variables.scalar.input, "1");
+    double* var_2 = hashmap_get(&fmu->variables.scalar.output, "2");
+    FmuSignalVectorIndex* idx_5 = hashmap_get(&fmu->variables.binary.tx, "5");
+    assert_double_equal(*var_1, 1, 0);
+    assert_double_equal(*var_2, 0, 0);
+    assert_int_equal(idx_5->sv->length[idx_5->vi], 0);
+
+    /* Step 2, outputs of step 1 are available. */
+    *var_1 = 2;
+    rc = fmu->variables.vtable.pipeline(fmu, _pipeline_step, 11, 1);
+    assert_int_equal(rc, 0);
+    assert_double_equal(*var_2, 11, 0);
+    assert_true(idx_5->sv->length[idx_5->vi] > 0);
+
+    /* Complete step 2, outputs remain in the back buffers. */
+    rc = fmu->variables.vtable.pipeline(fmu, NULL, 0, 0);
+    assert_int_equal(rc, 0);
+    assert_double_equal(vt->var_2, 13, 0);
+    assert_double_equal(*var_2, 11, 0);
+
+    /* Finished. */
+    fmu->variables.vtable.remove(fmu);
+    assert_null(fmu->variables.pipeline);
+    free(fmu->var_table.table);
+    free(fmu->var_table.marshal_list);
+}
+
+
+void test_fmu_ncodec_trace_file(void** state)
+{
+    /* Setup the FMU, with a binary trace. */
+    FmuInstanceData* fmu = *state;
+    fmu->instance.name = (char*)"inst";
+    setenv("NCODEC_TRACE_PDU_23", "*", true);
+    setenv("NCODEC_TRACE_FILE", "trace.pcapng", true);
+    fmu->variables.vtable.setup(fmu);
+    NCODEC* nc = fmu_lookup_ncodec(fmu, 5, false);
+    assert_non_null(nc);
+
+    /* Write a PDU (traced). */
+    uint8_t payload[] = { 1, 2, 3, 4, 5 };
+    ncodec_write(nc, &(struct NCodecPdu){ .id = 0x42,
+                         .payload = payload,
+                         .payload_len = sizeof(payload),
+                         .swc_id = 42 });
+    ncodec_flush(nc);
+
+    /* Close the NCodec, the trace file is written. */
+    fmu->variables.vtable.remove(fmu);
+    free(fmu->var_table.table);
+    free(fmu->var_table.marshal_list);
+    unsetenv("NCODEC_TRACE_PDU_23");
+    unsetenv("NCODEC_TRACE_FILE");
+
+    /* Check the blocks: SHB, IDB (rx), IDB (tx), EPB. The file name is unique
+       to the process and FMU instance. */
+    char path[100];
+    snprintf(path, sizeof(path), "trace.%ld.inst.pcapng", (long)getpid());
+    FILE* f = fopen(path, "rb");
+    assert_non_null(f);
+    uint32_t block[2];
+    uint32_t types[4] = {};
+    size_t   count = 0;
+    while (count < ARRAY_SIZE(types) && fread(block, sizeof(block), 1, f)) {
+        types[count++] = block[0];
+        fseek(f, block[1] - sizeof(block), SEEK_CUR);
+    }
+    fclose(f);
+    remove(path);
+    assert_int_equal(count, 4);
+    assert_int_equal(types[0], 0x0A0D0D0A);
+    assert_int_equal(types[1], 1);
+    assert_int_equal(types[2], 1);
+    assert_int_equal(types[3], 6);
+}
+
+
+static size_t _trace_filter(FmuInstanceData* fmu, const char* filter,
+    const uint32_t* id, size_t count, uint32_t* traced, size_t traced_len)
+{
+    /* Write PDUs with a filtered (binary) trace. */
+    fmu->instance.name = (char*)"inst";
+    setenv("NCODEC_TRACE_PDU_23", filter, true);
+    setenv("NCODEC_TRACE_FILE", "trace.pcapng", true);
+    fmu->variables.vtable.setup(fmu);
+    NCODEC* nc = fmu_lookup_ncodec(fmu, 5, false);
+    assert_non_null(nc);
+    uint8_t payload[] = { 1 };
+    for (size_t i = 0; i < count; i++) {
+        ncodec_write(nc, &(struct NCodecPdu){ .id = id[i],
+                             .payload = payload,
+                             .payload_len = sizeof(payload),
+                             .swc_id = 42 });
+    }
+    ncodec_flush(nc);
+    fmu->variables.vtable.remove(fmu);
+    free(fmu->var_table.table);
+    free(fmu->var_table.marshal_list);
+    unsetenv("NCODEC_TRACE_PDU_23");
+    unsetenv("NCODEC_TRACE_FILE");
+
+    /* Collect the IDs of the EPBs (PDU header, id in network byte order). */
+    char path[100];
+    snprintf(path, sizeof(path), "trace.%ld.inst.pcapng", (long)getpid());
+    FILE* f = fopen(path, "rb");
+    assert_non_null(f);
+    uint32_t block[2];
+    size_t   n = 0;
+    while (fread(block, sizeof(block), 1, f)) {
+        long    next = ftell(f) + block[1] - sizeof(block);
+        uint8_t b[24];
+        if (block[0] == 6 && fread(b, sizeof(b), 1, f) && n < traced_len) {
+            traced[n++] = (uint32_t)b[20] << 24 | (uint32_t)b[21] << 16 |
+                          (uint32_t)b[22] << 8 | b[23];
+        }
+        fseek(f, next, SEEK_SET);
+    }
+    fclose(f);
+    remove(path);
+    return n;
+}
+
+
+void test_fmu_ncodec_trace_filter(void** state)
+{
+    FmuInstanceData* fmu = *state;
+    uint32_t         id[] = {
+        0x42, 100, 0x43,              /* Single IDs (hex, decimal). */
+        0x41, 0x44,                   /* Not in the filter. */
+        0x7ff, 0x800, 0x80f, 0x810,   /* Range across the bitmap. */
+        0x1000, 0x27ff, 0x2fff,       /* Overlapping ranges (merged). */
+        0x3000, 0x30ff, 0x3100,       /* Adjacent range (merged). */
+        0x1ffffffe, 0x1fffffff,       /* 29-bit IDs. */
+        0x20, 0x10,                   /* Invalid token (hi < lo). */
+    };
+    uint32_t expect[] = { 0x42, 100, 0x43, 0x7ff, 0x800, 0x80f, 0x1000,
+        0x27ff, 0x2fff, 0x3000, 0x30ff, 0x1fffffff };
+    uint32_t traced[ARRAY_SIZE(id)] = {};
+
+    size_t count = _trace_filter(fmu,
+        "0x42,100, 0x43 ,foo,0x20-0x10,5-,0x7f0-0x80f,0x3000-0x30ff,"
+        "0x1800-0x2fff,0x1000-0x1fff,0x1fffffff",
+        id, ARRAY_SIZE(id), traced, ARRAY_SIZE(traced));
+    assert_int_equal(count, ARRAY_SIZE(expect));
+    assert_memory_equal(traced, expect, sizeof(expect));
+}
+
+
+void test_fmu_ncodec_trace_filter_empty(void** state)
+{
+    FmuInstanceData* fmu = *state;
+    uint32_t         id[] = { 0, 0x42, 0x800, 0x1fffffff };
+    uint32_t         traced[ARRAY_SIZE(id)] = {};
+
+    /* An empty list matches no IDs. */
+    assert_int_equal(_trace_filter(fmu, "", id, ARRAY_SIZE(id), traced,
+                         ARRAY_SIZE(traced)),
+        0);
+}
+
+
+void test_fmu_ncodec_trace_filter_invalid(void** state)
+{
+    FmuInstanceData* fmu = *state;
+    uint32_t         id[] = { 0, 0x10, 0x42, 0x800, 0x1fffffff };
+    uint32_t         traced[ARRAY_SIZE(id)] = {};
+
+    /* A list with only invalid tokens matches no IDs. */
+    assert_int_equal(_trace_filter(fmu, ",foo,-1,0x10-,0x42-0x41,0x100000000",
+                         id, ARRAY_SIZE(id), traced, ARRAY_SIZE(traced)),
+        0);
+}
+
+
 int run_fmu_default_signal_tests(void)
 {
     void* s = test_fmu_default_signal_setup;
@@ -233,6 +537,15 @@ int run_fmu_default_signal_tests(void)
         cmocka_unit_test_setup_teardown(test_fmu_default_signals_reset, s, t),
         cmocka_unit_test_setup_teardown(test_fmu_var_table, s, t),
         cmocka_unit_test_setup_teardown(test_fmu_lookup_ncodec, s, t),
+        cmocka_unit_test_setup_teardown(test_fmu_binary_buffers, s, t),
+        cmocka_unit_test_setup_teardown(test_fmu_signals_flush, s, t),
+        cmocka_unit_test_setup_teardown(test_fmu_signals_pipeline, s, t),
+        cmocka_unit_test_setup_teardown(test_fmu_ncodec_trace_file, s, t),
+        cmocka_unit_test_setup_teardown(test_fmu_ncodec_trace_filter, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_fmu_ncodec_trace_filter_empty, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_fmu_ncodec_trace_filter_invalid, s, t),
     };
 
     return cmocka_run_group_tests_name("DEFAULT SIGNALS", tests, NULL, NULL);